@@ -0,0 +1,59 @@
+/**
+ * @file bench_avr.c
+ * @brief Benchmark firmware for the ATmega2560, run by the simavr harness.
+ * 
+ * Every case is surrounded by markers written to `GPIOR0` (see @ref BENCH_MARKER_BEGIN), which
+ * the harness uses to count the CPU cycles. UART0 is looped back and a DS1307 is attached to
+ * the TWI by the harness.
+ */
+#include "../bench.h"
+#include <elob/util/error.h>
+#include <elob/drivers/uart.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+/**
+ * @brief Iterations and functions of the benchmark cases.
+ * 
+ */
+#define _BENCH_AVR_ITERATIONS(name, hostIterations, avrIterations) avrIterations,
+static const uint32_t _bench_avr_iterations[BENCH_CASE_COUNT] = {
+	BENCH_CASES(_BENCH_AVR_ITERATIONS)
+};
+
+#define _BENCH_AVR_FUNCTION(name, hostIterations, avrIterations) bench_##name,
+static void (* const _bench_avr_functions[BENCH_CASE_COUNT])(uint32_t iterations) = {
+	BENCH_CASES(_BENCH_AVR_FUNCTION)
+};
+
+void bench_platform_drainUart(void) {
+	uart_flush(UART0);
+}
+
+void bench_platform_loopbackUart(void) {
+	// The harness feeds the transmitted bytes back, uart_read waits for them
+}
+
+int main(void) {
+	sei();
+	
+	try {
+		bench_init();
+		
+		for(uint8_t i = 0; i < BENCH_CASE_COUNT; i++) {
+			GPIOR1 = i;
+			GPIOR0 = BENCH_MARKER_BEGIN;
+			_bench_avr_functions[i](_bench_avr_iterations[i]);
+			GPIOR0 = BENCH_MARKER_END;
+		}
+		GPIOR0 = BENCH_MARKER_DONE;
+	} catch {
+		GPIOR0 = BENCH_MARKER_FAILED;
+	}
+	
+	// Sleeping with disabled interrupts stops the simulation
+	cli();
+	sleep_mode();
+	for(;;);
+}
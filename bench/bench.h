@@ -0,0 +1,110 @@
+/**
+ * @file bench.h
+ * @brief Benchmark cases shared by the host benchmark and the simavr benchmark firmware.
+ * 
+ * Each case runs its operation a given number of times. The drivers measure the whole run
+ * and print the time (host) or the number of CPU cycles (simavr) per operation. The
+ * peripherals are emulated differently per platform, which is hidden behind the
+ * `bench_platform_` functions.
+ */
+#include <stdint.h>
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/**
+ * @brief List of the benchmark cases as `X(name, hostIterations, avrIterations)`.
+ * 
+ * The order defines the case indices, which are shared by the firmware and the simavr harness.
+ */
+#define BENCH_CASES(X) \
+	X(buffer_put_get,       10000000, 1000) \
+	X(uart_tx_block,          500000,   20) \
+	X(uart_loopback_block,    500000,   20) \
+	X(uart_read_until,        500000,   20) \
+	X(i2c_read_registers,     500000,   20) \
+	X(i2c_write_registers,    500000,   20) \
+	X(ds1307_get_datetime,    500000,   20) \
+	X(si_construct,          2000000,  100) \
+	X(si_to_string,           500000,   20) \
+	X(try_no_throw,         10000000, 1000) \
+	X(try_throw,             2000000,  100) \
+	X(telemetry_send,         500000,   20) \
+	X(telemetry_decode,       500000,   20) \
+	X(scheduler_dispatch,    2000000,  100)
+
+/**
+ * @brief Number of bytes sent per operation of the UART cases.
+ * 
+ */
+#define BENCH_UART_BLOCK_SIZE 16
+
+/**
+ * @brief Baud rate of UART0 in the UART cases.
+ * 
+ */
+#define BENCH_UART_BAUDRATE 1000000
+
+/**
+ * @brief I2C address of the DS1307, which is emulated on both platforms.
+ * 
+ */
+#define BENCH_DS1307_ADDRESS 0x68
+
+/**
+ * @brief Register address of the first byte of the battery-backed RAM of the DS1307,
+ * which is read and written by the I2C cases.
+ * 
+ */
+#define BENCH_DS1307_RAM_REGISTER 0x08
+
+/**
+ * @brief Message type of the telemetry frames of the telemetry cases.
+ * 
+ */
+#define BENCH_TELEMETRY_TYPE 0x01
+
+/**
+ * @brief Markers written to `GPIOR0` by the benchmark firmware. The index of the case is
+ * written to `GPIOR1` before @ref BENCH_MARKER_BEGIN.
+ * 
+ */
+#define BENCH_MARKER_BEGIN 1
+#define BENCH_MARKER_END 2
+#define BENCH_MARKER_DONE 3
+#define BENCH_MARKER_FAILED 4
+
+#define _BENCH_CASE_ENUM(name, hostIterations, avrIterations) BENCH_CASE_##name,
+/**
+ * @brief Indices of the benchmark cases.
+ * 
+ */
+typedef enum {
+	BENCH_CASES(_BENCH_CASE_ENUM)
+	BENCH_CASE_COUNT
+} BenchCase_t;
+
+#define _BENCH_CASE_DECLARE(name, hostIterations, avrIterations) void bench_##name(uint32_t iterations);
+BENCH_CASES(_BENCH_CASE_DECLARE)
+
+/**
+ * @brief Initializes the library modules used by the cases. The platform has to be set up before.
+ * 
+ */
+void bench_init(void);
+
+/**
+ * @brief Waits until everything written to UART0 was sent.
+ * Implemented by the driver of every platform.
+ * 
+ */
+void bench_platform_drainUart(void);
+
+/**
+ * @brief Sends everything written to UART0 and feeds it back to its receiver, so it can be read.
+ * Implemented by the driver of every platform.
+ * 
+ */
+void bench_platform_loopbackUart(void);
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,199 @@
+/**
+ * @file bench_cases.c
+ * @brief Implementation of the benchmark cases, see @ref bench.h.
+ */
+#include "bench.h"
+#include <elob/util/buffer.h>
+#include <elob/util/error.h>
+#include <elob/util/si_units.h>
+#include <elob/util/telemetry.h>
+#include <elob/util/scheduler.h>
+#include <elob/drivers/uart.h>
+#include <elob/drivers/i2c_master.h>
+#include <elob/drivers/ds1307.h>
+
+/**
+ * @brief Results of the cases are written here, so the compiler can't remove the operations.
+ * 
+ */
+static volatile uint8_t _bench_sink;
+
+/**
+ * @brief Test data sent over UART0 and written to the DS1307.
+ * 
+ */
+static const uint8_t _bench_data[BENCH_UART_BLOCK_SIZE] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+
+/**
+ * @brief Encoded telemetry frame fed to the decoder by @ref bench_telemetry_decode.
+ * 
+ */
+static uint8_t _bench_frame[TELEMETRY_MAX_FRAME_SIZE];
+static uint8_t _bench_frameLength;
+
+/**
+ * @brief Sends the telemetry sample of the telemetry cases.
+ * 
+ */
+static void _bench_sendSample(uint32_t timestamp) {
+	TelemetryWriter_t writer;
+	telemetry_begin(&writer, BENCH_TELEMETRY_TYPE);
+	telemetry_putUint32(&writer, timestamp);
+	telemetry_putFloat(&writer, 3.3f);
+	telemetry_putInt16(&writer, -1234);
+	telemetry_putUint16(&writer, 0);
+	telemetry_end(&writer);
+}
+
+void bench_init(void) {
+	scheduler_init();
+	uart_init(UART0, BENCH_UART_BAUDRATE, UART_PARITY_DISABLED, UART_STOP_1BIT, UART_CLOCK_POLARITY_SAMPLE_ON_FALLING);
+	DS1307_init();
+	
+	// Record an encoded frame by sending it to the loopback
+	_bench_sendSample(0x12345678);
+	bench_platform_loopbackUart();
+	_bench_frameLength = uart_read(UART0, _bench_frame, sizeof(_bench_frame), 10);
+}
+
+void bench_buffer_put_get(uint32_t iterations) {
+	static uint8_t storage[16];
+	Buffer_t buffer;
+	buffer_init(&buffer, storage, sizeof(storage));
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		buffer_put(&buffer, (uint8_t)i);
+		_bench_sink = buffer_get(&buffer);
+	}
+}
+
+void bench_uart_tx_block(uint32_t iterations) {
+	for(uint32_t i = 0; i < iterations; i++) {
+		uart_write(UART0, _bench_data, sizeof(_bench_data));
+		bench_platform_drainUart();
+	}
+}
+
+void bench_uart_loopback_block(uint32_t iterations) {
+	uint8_t received[BENCH_UART_BLOCK_SIZE];
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		uart_write(UART0, _bench_data, sizeof(_bench_data));
+		bench_platform_loopbackUart();
+		_bench_sink = uart_read(UART0, received, sizeof(received), 10);
+	}
+}
+
+void bench_uart_read_until(uint32_t iterations) {
+	static const char line[BENCH_UART_BLOCK_SIZE + 1] = "$GPZDA,1234*5A\r\n";
+	uint8_t received[BENCH_UART_BLOCK_SIZE];
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		uart_write(UART0, (const uint8_t*)line, BENCH_UART_BLOCK_SIZE);
+		bench_platform_loopbackUart();
+		while(uart_linesAvailable(UART0) == 0);
+		_bench_sink = uart_readUntil(UART0, '\n', received, sizeof(received));
+	}
+}
+
+void bench_i2c_read_registers(uint32_t iterations) {
+	uint8_t registers[8];
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		i2c_master_readRegisters(BENCH_DS1307_ADDRESS, BENCH_DS1307_RAM_REGISTER, registers, sizeof(registers));
+		_bench_sink = registers[0];
+	}
+}
+
+void bench_i2c_write_registers(uint32_t iterations) {
+	for(uint32_t i = 0; i < iterations; i++) {
+		i2c_master_writeRegisters(BENCH_DS1307_ADDRESS, BENCH_DS1307_RAM_REGISTER, _bench_data, 8);
+	}
+}
+
+void bench_ds1307_get_datetime(uint32_t iterations) {
+	for(uint32_t i = 0; i < iterations; i++) {
+		_bench_sink = (uint8_t)DS1307_getDatetime();
+	}
+}
+
+void bench_si_construct(uint32_t iterations) {
+	for(uint32_t i = 0; i < iterations; i++) {
+		Quantity_t quantity = SI(1234.5 + (uint8_t)i, VOLT, 3);
+		_bench_sink = quantity._prefix;
+	}
+}
+
+void bench_si_to_string(uint32_t iterations) {
+	char s[24];
+	Quantity_t quantity = SI(0.0123456, AMPERE, 4);
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		SI_toString(quantity, s, sizeof(s));
+		_bench_sink = s[0];
+	}
+}
+
+void bench_try_no_throw(uint32_t iterations) {
+	for(uint32_t i = 0; i < iterations; i++) {
+		try {
+			_bench_sink = (uint8_t)i;
+		} catch {
+			_bench_sink = 0;
+		}
+	}
+}
+
+void bench_try_throw(uint32_t iterations) {
+	Error_t error;
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		try {
+			throw(ERR_OUT_OF_RANGE);
+		} catchError(error) {
+			_bench_sink = (uint8_t)error.code;
+		}
+	}
+}
+
+void bench_telemetry_send(uint32_t iterations) {
+	for(uint32_t i = 0; i < iterations; i++) {
+		_bench_sendSample(i);
+		bench_platform_drainUart();
+	}
+}
+
+void bench_telemetry_decode(uint32_t iterations) {
+	TelemetryDecoder_t decoder;
+	telemetry_decoder_init(&decoder);
+	telemetry_decoder_feed(&decoder, 0);
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		for(uint8_t j = 0; j < _bench_frameLength; j++) {
+			if(telemetry_decoder_feed(&decoder, _bench_frame[j])) _bench_sink = decoder.length;
+		}
+	}
+	
+	// A frame which doesn't decode would measure the wrong code path (the counter wraps around)
+	if(decoder.frames != (uint16_t)iterations) throw(ERR_INVALID_STR);
+}
+
+static void _bench_countEvent(void* context) {
+	(*(uint32_t*)context)++;
+}
+
+void bench_scheduler_dispatch(uint32_t iterations) {
+	uint32_t runs = 0;
+	SchedulerTask_t task = scheduler_onEvent(SCHEDULER_APP_EVENT(0), _bench_countEvent, &runs);
+	
+	for(uint32_t i = 0; i < iterations; i++) {
+		scheduler_signal(SCHEDULER_APP_EVENT(0));
+		scheduler_runPending();
+	}
+	scheduler_cancel(task);
+	
+	if(runs != iterations) throw(ERR_OUT_OF_RANGE);
+}
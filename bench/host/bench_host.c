@@ -0,0 +1,124 @@
+/**
+ * @file bench_host.c
+ * @brief Host benchmark, running the library against the mocked AVR registers.
+ * 
+ * Prints one line per case with the wall-clock time per operation. Pass case names as
+ * arguments to only run these cases.
+ */
+#include "../bench.h"
+#include "ds1307_model.h"
+#include <elob/util/error.h>
+#include <elob/drivers/uart.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+void USART0_UDRE_vect(void);
+void USART0_RX_vect(void);
+
+/**
+ * @brief Description of a benchmark case.
+ * 
+ */
+typedef struct {
+	const char* name;
+	void (*run)(uint32_t iterations);
+	uint32_t iterations;
+} _BenchHostCase_t;
+
+#define _BENCH_HOST_CASE(name, hostIterations, avrIterations) { #name, bench_##name, hostIterations },
+static const _BenchHostCase_t _bench_host_cases[BENCH_CASE_COUNT] = {
+	BENCH_CASES(_BENCH_HOST_CASE)
+};
+
+/**
+ * @brief Sends one byte from the transmit buffer to the mocked data register, as the
+ * hardware would by raising the data register empty interrupt.
+ * 
+ * @return `true` if a byte was sent, `false` if the transmit buffer was empty.
+ */
+static bool _bench_host_transmitByte(void) {
+	if(!(UCSR0B & (1 << UDRIE0))) return false;
+	
+	uint8_t free = uart_txBytesFree(UART0);
+	USART0_UDRE_vect();
+	return uart_txBytesFree(UART0) != free;
+}
+
+void bench_platform_drainUart(void) {
+	while(_bench_host_transmitByte());
+}
+
+void bench_platform_loopbackUart(void) {
+	// The mocked data register keeps the sent byte, so the receive interrupt reads it back
+	while(_bench_host_transmitByte()) {
+		USART0_RX_vect();
+	}
+}
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ * 
+ */
+static double _bench_host_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/**
+ * @brief Checks whether a case was selected on the command line.
+ * 
+ */
+static bool _bench_host_selected(const char* name, int argc, char** argv) {
+	if(argc <= 1) return true;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], name) == 0) return true;
+	}
+	return false;
+}
+
+int main(int argc, char** argv) {
+	// The transmitter is always ready and has completed, the receiver has no errors
+	UCSR0A = (1 << UDRE0) | (1 << TXC0);
+	ds1307_model_init(BENCH_DS1307_ADDRESS);
+	sei();
+	
+	int failed = 0;
+	try {
+		bench_init();
+	} catch {
+		fprintf(stderr, "bench: initialization failed\n");
+		return 1;
+	}
+	
+	for(uint8_t i = 0; i < BENCH_CASE_COUNT; i++) {
+		const _BenchHostCase_t* benchCase = &_bench_host_cases[i];
+		if(!_bench_host_selected(benchCase->name, argc, argv)) continue;
+		
+		// Warm up the caches with a tenth of the iterations
+		volatile bool success = false;
+		volatile double elapsed = 0;
+		try {
+			benchCase->run(benchCase->iterations / 10);
+			double start = _bench_host_now();
+			benchCase->run(benchCase->iterations);
+			elapsed = _bench_host_now() - start;
+			success = true;
+		} catch {
+			success = false;
+		}
+		
+		if(success) {
+			printf("bench: platform=host case=%s iterations=%lu ns_per_op=%.1f\n",
+				benchCase->name, (unsigned long)benchCase->iterations, elapsed / benchCase->iterations);
+		} else {
+			printf("bench: platform=host case=%s iterations=%lu failed\n",
+				benchCase->name, (unsigned long)benchCase->iterations);
+			failed = 1;
+		}
+	}
+	return failed;
+}
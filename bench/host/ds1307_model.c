@@ -0,0 +1,123 @@
+/**
+ * @file ds1307_model.c
+ * @brief Source file for @ref ds1307_model.h.
+ */
+#include "ds1307_model.h"
+#include <avr/io.h>
+#include <util/delay.h>
+#include <stdbool.h>
+#include <string.h>
+
+void TWI_vect(void);
+
+/**
+ * @brief Number of registers of the DS1307 (clock registers and RAM).
+ * 
+ */
+#define _MODEL_REGISTERS 64
+
+/**
+ * @brief TWI status codes of the master modes.
+ * 
+ */
+#define _MODEL_START 0x08
+#define _MODEL_REPEATED_START 0x10
+#define _MODEL_SLAW_ACK 0x18
+#define _MODEL_SLAW_NACK 0x20
+#define _MODEL_DATA_SENT_ACK 0x28
+#define _MODEL_SLAR_ACK 0x40
+#define _MODEL_SLAR_NACK 0x48
+#define _MODEL_DATA_RECEIVED_ACK 0x50
+#define _MODEL_DATA_RECEIVED_NACK 0x58
+
+/**
+ * @brief Phase of the current frame.
+ * 
+ */
+typedef enum {
+	_MODEL_IDLE,
+	_MODEL_ADDRESS,
+	_MODEL_WRITING,
+	_MODEL_READING
+} _ModelPhase_t;
+
+static uint8_t _model_address;
+static uint8_t _model_registers[_MODEL_REGISTERS];
+static uint8_t _model_pointer;
+static bool _model_pointerReceived;
+static _ModelPhase_t _model_phase = _MODEL_IDLE;
+
+/**
+ * @brief Completes a bus operation and raises the TWI interrupt.
+ * 
+ * @param status The status code the hardware would set.
+ */
+static void _ds1307_model_complete(uint8_t status) {
+	TWSR = (TWSR & 0x07) | status;
+	TWI_vect();
+}
+
+void ds1307_model_init(uint8_t address) {
+	// Saturday, 2024-06-01 12:34:56 in BCD
+	static const uint8_t clock[8] = { 0x56, 0x34, 0x12, 0x07, 0x01, 0x06, 0x24, 0x00 };
+	
+	memset(_model_registers, 0, sizeof(_model_registers));
+	memcpy(_model_registers, clock, sizeof(clock));
+	_model_address = address;
+	_model_phase = _MODEL_IDLE;
+	mock_delayHook = ds1307_model_step;
+}
+
+void ds1307_model_step(void) {
+	uint8_t control = TWCR;
+	
+	// The hardware clears TWSTO once the stop condition was generated
+	if(control & (1 << TWSTO)) {
+		TWCR = control & ~(1 << TWSTO);
+		_model_phase = _MODEL_IDLE;
+	}
+	if(!(control & (1 << TWIE)) || !(control & (1 << TWINT))) return;
+	
+	if(control & (1 << TWSTA)) {
+		_ds1307_model_complete(_model_phase == _MODEL_IDLE ? _MODEL_START : _MODEL_REPEATED_START);
+		_model_phase = _MODEL_ADDRESS;
+		return;
+	}
+	
+	switch(_model_phase) {
+		case _MODEL_ADDRESS: {
+			uint8_t addressByte = TWDR;
+			bool read = addressByte & 1;
+			if((addressByte >> 1) != _model_address) {
+				_model_phase = _MODEL_IDLE;
+				_ds1307_model_complete(read ? _MODEL_SLAR_NACK : _MODEL_SLAW_NACK);
+				return;
+			}
+			_model_pointerReceived = false;
+			_model_phase = read ? _MODEL_READING : _MODEL_WRITING;
+			_ds1307_model_complete(read ? _MODEL_SLAR_ACK : _MODEL_SLAW_ACK);
+			break;
+		}
+		
+		case _MODEL_WRITING:
+			// The first byte sets the register pointer, the following ones are written
+			if(_model_pointerReceived) {
+				_model_registers[_model_pointer] = TWDR;
+				_model_pointer = (_model_pointer + 1) % _MODEL_REGISTERS;
+			} else {
+				_model_pointer = TWDR % _MODEL_REGISTERS;
+				_model_pointerReceived = true;
+			}
+			_ds1307_model_complete(_MODEL_DATA_SENT_ACK);
+			break;
+		
+		case _MODEL_READING:
+			TWDR = _model_registers[_model_pointer];
+			_model_pointer = (_model_pointer + 1) % _MODEL_REGISTERS;
+			_ds1307_model_complete(control & (1 << TWEA) ? _MODEL_DATA_RECEIVED_ACK : _MODEL_DATA_RECEIVED_NACK);
+			break;
+		
+		default:
+			break;
+	}
+}
@@ -0,0 +1,28 @@
+/**
+ * @file ds1307_model.h
+ * @brief Register-level model of a DS1307 on the mocked TWI of the host benchmark.
+ * 
+ * The model runs from the delay hook of the mocks (see @ref mock_delayHook): whenever the
+ * interrupt-driven I2C driver triggered a bus operation by writing `TWINT` with `TWIE` set,
+ * the bus operation is carried out, `TWSR` and `TWDR` are updated as the hardware would and
+ * `TWI_vect` is called.
+ */
+#include <stdint.h>
+
+#ifndef DS1307_MODEL_H_
+#define DS1307_MODEL_H_
+
+/**
+ * @brief Resets the model to a fixed date and time and installs it as the delay hook.
+ * 
+ * @param address The 7-bit I2C address the model responds to.
+ */
+void ds1307_model_init(uint8_t address);
+
+/**
+ * @brief Carries out a pending bus operation, if any.
+ * 
+ */
+void ds1307_model_step(void);
+
+#endif /* DS1307_MODEL_H_ */
@@ -0,0 +1,13 @@
+/**
+ * @file eeprom.h
+ * @brief Host mock of `<avr/eeprom.h>`, backed by an array in RAM.
+ */
+#include <stddef.h>
+
+#ifndef MOCK_AVR_EEPROM_H_
+#define MOCK_AVR_EEPROM_H_
+
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_update_block(const void* src, void* dst, size_t n);
+
+#endif /* MOCK_AVR_EEPROM_H_ */
@@ -0,0 +1,18 @@
+/**
+ * @file interrupt.h
+ * @brief Host mock of `<avr/interrupt.h>`.
+ * 
+ * Interrupt service routines become plain functions, which the host benchmark calls
+ * directly to simulate the interrupts. `sei()` and `cli()` only change the I bit of `SREG`.
+ */
+#include <avr/io.h>
+
+#ifndef MOCK_AVR_INTERRUPT_H_
+#define MOCK_AVR_INTERRUPT_H_
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+#define ISR_NOBLOCK
+#define sei() (SREG |= (1 << SREG_I))
+#define cli() (SREG &= ~(1 << SREG_I))
+
+#endif /* MOCK_AVR_INTERRUPT_H_ */
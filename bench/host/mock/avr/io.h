@@ -0,0 +1,161 @@
+/**
+ * @file io.h
+ * @brief Host mock of `<avr/io.h>` for the ATmega2560.
+ * 
+ * All registers are bytes in @ref _avr_mem at their data space address, so the library
+ * can be compiled and run on the host. Nothing reacts to register writes, except for the
+ * TWI, which is driven by the DS1307 model of the host benchmark.
+ */
+#include <stdint.h>
+
+#ifndef MOCK_AVR_IO_H_
+#define MOCK_AVR_IO_H_
+
+/**
+ * @brief Data space of the I/O and extended I/O registers.
+ * 
+ */
+extern volatile uint8_t _avr_mem[0x200];
+
+#define _SFR_MEM8(a) (*(volatile uint8_t*)(_avr_mem + (a)))
+#define _SFR_MEM16(a) (*(volatile uint16_t*)(_avr_mem + (a)))
+
+#define SREG _SFR_MEM8(0x5F)
+#define SREG_I 7
+#define GPIOR0 _SFR_MEM8(0x3E)
+#define GPIOR1 _SFR_MEM8(0x4A)
+#define GPIOR2 _SFR_MEM8(0x4B)
+#define MCUSR _SFR_MEM8(0x54)
+#define WDRF 3
+#define PINA _SFR_MEM8(0x20)
+#define DDRA _SFR_MEM8(0x21)
+#define PORTA _SFR_MEM8(0x22)
+#define PINB _SFR_MEM8(0x23)
+#define DDRB _SFR_MEM8(0x24)
+#define PORTB _SFR_MEM8(0x25)
+#define PINC _SFR_MEM8(0x26)
+#define DDRC _SFR_MEM8(0x27)
+#define PORTC _SFR_MEM8(0x28)
+#define PIND _SFR_MEM8(0x29)
+#define DDRD _SFR_MEM8(0x2A)
+#define PORTD _SFR_MEM8(0x2B)
+#define PINE _SFR_MEM8(0x2C)
+#define DDRE _SFR_MEM8(0x2D)
+#define PORTE _SFR_MEM8(0x2E)
+#define PINH _SFR_MEM8(0x100)
+#define DDRH _SFR_MEM8(0x101)
+#define PORTH _SFR_MEM8(0x102)
+#define PINJ _SFR_MEM8(0x103)
+#define DDRJ _SFR_MEM8(0x104)
+#define PORTJ _SFR_MEM8(0x105)
+#define EIFR _SFR_MEM8(0x3C)
+#define EIMSK _SFR_MEM8(0x3D)
+#define EICRA _SFR_MEM8(0x69)
+#define EICRB _SFR_MEM8(0x6A)
+#define TCCR0A _SFR_MEM8(0x44)
+#define TCCR0B _SFR_MEM8(0x45)
+#define TCNT0 _SFR_MEM8(0x46)
+#define OCR0A _SFR_MEM8(0x47)
+#define TIMSK0 _SFR_MEM8(0x6E)
+#define TIMSK2 _SFR_MEM8(0x70)
+#define TIMSK5 _SFR_MEM8(0x73)
+#define TCCR2A _SFR_MEM8(0xB0)
+#define TCCR2B _SFR_MEM8(0xB1)
+#define TCNT2 _SFR_MEM8(0xB2)
+#define OCR2A _SFR_MEM8(0xB3)
+#define TCCR5A _SFR_MEM8(0x120)
+#define TCCR5B _SFR_MEM8(0x121)
+#define TCCR5C _SFR_MEM8(0x122)
+#define TCNT5 _SFR_MEM16(0x124)
+#define TWBR _SFR_MEM8(0xB8)
+#define TWSR _SFR_MEM8(0xB9)
+#define TWAR _SFR_MEM8(0xBA)
+#define TWDR _SFR_MEM8(0xBB)
+#define TWCR _SFR_MEM8(0xBC)
+#define UCSR0A _SFR_MEM8(0xC0)
+#define UCSR0B _SFR_MEM8(0xC1)
+#define UCSR0C _SFR_MEM8(0xC2)
+#define UBRR0 _SFR_MEM16(0xC4)
+#define UBRR0L _SFR_MEM8(0xC4)
+#define UBRR0H _SFR_MEM8(0xC5)
+#define UDR0 _SFR_MEM8(0xC6)
+#define UCSR1A _SFR_MEM8(0xC8)
+#define UCSR1B _SFR_MEM8(0xC9)
+#define UCSR1C _SFR_MEM8(0xCA)
+#define UBRR1 _SFR_MEM16(0xCC)
+#define UBRR1L _SFR_MEM8(0xCC)
+#define UBRR1H _SFR_MEM8(0xCD)
+#define UDR1 _SFR_MEM8(0xCE)
+#define UCSR2A _SFR_MEM8(0xD0)
+#define UCSR2B _SFR_MEM8(0xD1)
+#define UCSR2C _SFR_MEM8(0xD2)
+#define UBRR2 _SFR_MEM16(0xD4)
+#define UBRR2L _SFR_MEM8(0xD4)
+#define UBRR2H _SFR_MEM8(0xD5)
+#define UDR2 _SFR_MEM8(0xD6)
+#define UCSR3A _SFR_MEM8(0x130)
+#define UCSR3B _SFR_MEM8(0x131)
+#define UCSR3C _SFR_MEM8(0x132)
+#define UBRR3 _SFR_MEM16(0x134)
+#define UBRR3L _SFR_MEM8(0x134)
+#define UBRR3H _SFR_MEM8(0x135)
+#define UDR3 _SFR_MEM8(0x136)
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define MPCM0 0
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ02 2
+#define UMSEL01 7
+#define UMSEL00 6
+#define UPM01 5
+#define UPM00 4
+#define USBS0 3
+#define UCSZ01 2
+#define UCSZ00 1
+#define UCPOL0 0
+#define UDORD0 2
+#define UCPHA0 1
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+#define TWPS1 1
+#define TWPS0 0
+#define WGM01 1
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define OCIE0A 1
+#define OCIE2A 1
+#define WGM21 1
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define ISC00 0
+#define ISC01 1
+#define PE2 2
+#define PD5 5
+#define PH2 2
+#define PJ2 2
+#define E2END 0xFFF
+#define TCCR1A _SFR_MEM8(0x80)
+#define TCCR1B _SFR_MEM8(0x81)
+#define TCNT1 _SFR_MEM16(0x84)
+#define CS11 1
+
+#endif /* MOCK_AVR_IO_H_ */
@@ -0,0 +1,47 @@
+/**
+ * @file pgmspace.h
+ * @brief Host mock of `<avr/pgmspace.h>`.
+ * 
+ * Flash and RAM share the address space on the host, so the `_P` functions map to their
+ * standard counterparts. The formatted output functions translate the `%S` conversion of
+ * avr-libc (string in flash) to `%s`.
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef MOCK_AVR_PGMSPACE_H_
+#define MOCK_AVR_PGMSPACE_H_
+
+#define PROGMEM
+#define PGM_P const char*
+#define PGM_VOID_P const void*
+#define PSTR(s) (s)
+
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(address))
+#define pgm_read_dword(address) (*(address))
+#define pgm_read_ptr(address) (*(address))
+
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+#define fputs_P fputs
+
+int mock_vfprintf_P(FILE* stream, const char* format, va_list args);
+int mock_vsnprintf_P(char* s, size_t n, const char* format, va_list args);
+int mock_printf_P(const char* format, ...);
+int mock_fprintf_P(FILE* stream, const char* format, ...);
+int mock_sprintf_P(char* s, const char* format, ...);
+int mock_snprintf_P(char* s, size_t n, const char* format, ...);
+
+#define vfprintf_P mock_vfprintf_P
+#define printf_P mock_printf_P
+#define fprintf_P mock_fprintf_P
+#define sprintf_P mock_sprintf_P
+#define snprintf_P mock_snprintf_P
+
+#endif /* MOCK_AVR_PGMSPACE_H_ */
@@ -0,0 +1,15 @@
+/**
+ * @file sleep.h
+ * @brief Host mock of `<avr/sleep.h>`. Sleeping returns immediately.
+ */
+#ifndef MOCK_AVR_SLEEP_H_
+#define MOCK_AVR_SLEEP_H_
+
+#define SLEEP_MODE_IDLE 0
+#define set_sleep_mode(mode) ((void)0)
+#define sleep_enable() ((void)0)
+#define sleep_disable() ((void)0)
+#define sleep_cpu() ((void)0)
+#define sleep_mode() ((void)0)
+
+#endif /* MOCK_AVR_SLEEP_H_ */
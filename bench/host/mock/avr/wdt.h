@@ -0,0 +1,13 @@
+/**
+ * @file wdt.h
+ * @brief Host mock of `<avr/wdt.h>`. The watchdog does nothing.
+ */
+#ifndef MOCK_AVR_WDT_H_
+#define MOCK_AVR_WDT_H_
+
+#define WDTO_15MS 0
+#define wdt_enable(timeout) ((void)0)
+#define wdt_reset() ((void)0)
+#define wdt_disable() ((void)0)
+
+#endif /* MOCK_AVR_WDT_H_ */
@@ -0,0 +1,111 @@
+/**
+ * @file mock.c
+ * @brief Storage and functions of the host mocks of avr-libc.
+ */
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/delay.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+volatile uint8_t _avr_mem[0x200];
+void (*mock_delayHook)(void) = NULL;
+
+/**
+ * @brief Size of the EEPROM of the ATmega2560.
+ * 
+ */
+#define _MOCK_EEPROM_SIZE 4096
+
+static uint8_t _mock_eeprom[_MOCK_EEPROM_SIZE];
+
+void eeprom_read_block(void* dst, const void* src, size_t n) {
+	memcpy(dst, &_mock_eeprom[(uintptr_t)src % _MOCK_EEPROM_SIZE], n);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n) {
+	memcpy(&_mock_eeprom[(uintptr_t)dst % _MOCK_EEPROM_SIZE], src, n);
+}
+
+char* dtostrf(double value, signed char width, unsigned char precision, char* s) {
+	sprintf(s, "%*.*f", width, precision, value);
+	return s;
+}
+
+/**
+ * @brief Maximum length of a translated format string.
+ * 
+ */
+#define _MOCK_FORMAT_SIZE 256
+
+/**
+ * @brief Translates the `%S` conversions of an avr-libc format string to `%s`.
+ * 
+ * @param format The avr-libc format string.
+ * @param translated Target for the translated format string.
+ */
+static void _mock_translateFormat(const char* format, char translated[_MOCK_FORMAT_SIZE]) {
+	size_t i = 0;
+	while(*format != '\0' && i < _MOCK_FORMAT_SIZE - 1) {
+		char c = *format++;
+		translated[i++] = c;
+		if(c != '%') continue;
+		
+		// Copy the flags, width, precision and length modifiers
+		while(*format != '\0' && strchr("-+ #0123456789.*hlLqjzt", *format) != NULL && i < _MOCK_FORMAT_SIZE - 1) {
+			translated[i++] = *format++;
+		}
+		if(*format != '\0' && i < _MOCK_FORMAT_SIZE - 1) {
+			translated[i++] = *format == 'S' ? 's' : *format;
+			format++;
+		}
+	}
+	translated[i] = '\0';
+}
+
+int mock_vfprintf_P(FILE* stream, const char* format, va_list args) {
+	char translated[_MOCK_FORMAT_SIZE];
+	_mock_translateFormat(format, translated);
+	return vfprintf(stream, translated, args);
+}
+
+int mock_vsnprintf_P(char* s, size_t n, const char* format, va_list args) {
+	char translated[_MOCK_FORMAT_SIZE];
+	_mock_translateFormat(format, translated);
+	return vsnprintf(s, n, translated, args);
+}
+
+int mock_printf_P(const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	int result = mock_vfprintf_P(stdout, format, args);
+	va_end(args);
+	return result;
+}
+
+int mock_fprintf_P(FILE* stream, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	int result = mock_vfprintf_P(stream, format, args);
+	va_end(args);
+	return result;
+}
+
+int mock_sprintf_P(char* s, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	char translated[_MOCK_FORMAT_SIZE];
+	_mock_translateFormat(format, translated);
+	int result = vsprintf(s, translated, args);
+	va_end(args);
+	return result;
+}
+
+int mock_snprintf_P(char* s, size_t n, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	int result = mock_vsnprintf_P(s, n, format, args);
+	va_end(args);
+	return result;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file stdio.h
+ * @brief Host mock of the avr-libc extensions to `<stdio.h>`.
+ * 
+ * Streams set up with `FDEV_SETUP_STREAM` are zero-initialized host streams which must
+ * not be used, so the benchmarks don't print through the library streams.
+ */
+#include_next <stdio.h>
+
+#ifndef MOCK_STDIO_H_
+#define MOCK_STDIO_H_
+
+#define _FDEV_SETUP_READ 1
+#define _FDEV_SETUP_WRITE 2
+#define _FDEV_SETUP_RW 3
+#define _FDEV_ERR (-1)
+#define _FDEV_EOF (-2)
+#define FDEV_SETUP_STREAM(put, get, flags) { 0 }
+#define fdev_setup_stream(stream, put, get, flags) ((void)0)
+
+#endif /* MOCK_STDIO_H_ */
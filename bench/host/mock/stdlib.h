@@ -0,0 +1,12 @@
+/**
+ * @file stdlib.h
+ * @brief Host mock of the avr-libc extensions to `<stdlib.h>`.
+ */
+#include_next <stdlib.h>
+
+#ifndef MOCK_STDLIB_H_
+#define MOCK_STDLIB_H_
+
+char* dtostrf(double value, signed char width, unsigned char precision, char* s);
+
+#endif /* MOCK_STDLIB_H_ */
@@ -0,0 +1,18 @@
+/**
+ * @file atomic.h
+ * @brief Host mock of `<util/atomic.h>`.
+ * 
+ * The block clears the I bit of `SREG` and restores it afterwards, so code checking
+ * whether interrupts are enabled behaves as on the target.
+ */
+#include <avr/io.h>
+
+#ifndef MOCK_UTIL_ATOMIC_H_
+#define MOCK_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) \
+	for(uint8_t _atomic_sreg = SREG, _atomic_once = (SREG &= ~(1 << SREG_I), 1); _atomic_once; SREG = _atomic_sreg, _atomic_once = 0)
+
+#endif /* MOCK_UTIL_ATOMIC_H_ */
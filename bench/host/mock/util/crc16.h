@@ -0,0 +1,16 @@
+/**
+ * @file crc16.h
+ * @brief Host mock of `<util/crc16.h>`, using the C equivalents given in the avr-libc documentation.
+ */
+#include <stdint.h>
+
+#ifndef MOCK_UTIL_CRC16_H_
+#define MOCK_UTIL_CRC16_H_
+
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data) {
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+#endif /* MOCK_UTIL_CRC16_H_ */
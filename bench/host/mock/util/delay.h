@@ -0,0 +1,30 @@
+/**
+ * @file delay.h
+ * @brief Host mock of `<util/delay.h>`.
+ * 
+ * Delays don't wait, they call @ref mock_delayHook instead. Busy-waiting code of the
+ * library calls the delay functions in its loops, which gives the host benchmark the
+ * chance to advance the simulated peripherals.
+ */
+#include <stddef.h>
+
+#ifndef MOCK_UTIL_DELAY_H_
+#define MOCK_UTIL_DELAY_H_
+
+/**
+ * @brief Function called on every delay, or `NULL`.
+ * 
+ */
+extern void (*mock_delayHook)(void);
+
+static inline void _delay_us(double us) {
+	(void)us;
+	if(mock_delayHook != NULL) mock_delayHook();
+}
+
+static inline void _delay_ms(double ms) {
+	(void)ms;
+	if(mock_delayHook != NULL) mock_delayHook();
+}
+
+#endif /* MOCK_UTIL_DELAY_H_ */
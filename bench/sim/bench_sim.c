@@ -0,0 +1,212 @@
+/**
+ * @file bench_sim.c
+ * @brief simavr harness running the benchmark firmware on a simulated ATmega2560.
+ * 
+ * The harness counts the CPU cycles between the markers the firmware writes to `GPIOR0`
+ * (see @ref BENCH_MARKER_BEGIN), loops UART0 back and attaches a DS1307 to the TWI, which
+ * responds with fixed clock registers and keeps its RAM. The cycle counts are exact and
+ * don't depend on the host, so the output is stable between runs.
+ * 
+ * Usage: `bench_sim <firmware.elf>`
+ */
+#include "../bench.h"
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_io.h>
+#include <avr_twi.h>
+#include <avr_uart.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Data space addresses of the general purpose I/O registers used for the markers.
+ * 
+ */
+#define _BENCH_SIM_GPIOR0 0x3E
+#define _BENCH_SIM_GPIOR1 0x4A
+
+/**
+ * @brief CPU frequency of the ELO-Board.
+ * 
+ */
+#define _BENCH_SIM_FREQUENCY 16000000
+
+/**
+ * @brief Simulated time after which the benchmark is aborted, in CPU cycles.
+ * 
+ */
+#define _BENCH_SIM_CYCLE_LIMIT (120ULL * _BENCH_SIM_FREQUENCY)
+
+#define _BENCH_SIM_NAME(name, hostIterations, avrIterations) #name,
+static const char* const _bench_sim_names[BENCH_CASE_COUNT] = {
+	BENCH_CASES(_BENCH_SIM_NAME)
+};
+
+#define _BENCH_SIM_ITERATIONS(name, hostIterations, avrIterations) avrIterations,
+static const uint32_t _bench_sim_iterations[BENCH_CASE_COUNT] = {
+	BENCH_CASES(_BENCH_SIM_ITERATIONS)
+};
+
+/**
+ * @brief State of the benchmark run, updated by the marker writes.
+ * 
+ */
+static struct {
+	avr_cycle_count_t start;
+	bool finished;
+	int failed;
+} _bench_sim_state;
+
+/**
+ * @brief State of the virtual DS1307.
+ * 
+ */
+static struct {
+	avr_irq_t* irq;
+	uint8_t registers[64];
+	uint8_t pointer;
+	bool selected;
+	bool pointerReceived;
+} _bench_sim_ds1307;
+
+static void _bench_sim_markerWrite(avr_t* avr, avr_io_addr_t addr, uint8_t value, void* param) {
+	(void)param;
+	avr->data[addr] = value;
+	uint8_t index = avr->data[_BENCH_SIM_GPIOR1];
+	
+	switch(value) {
+		case BENCH_MARKER_BEGIN:
+			_bench_sim_state.start = avr->cycle;
+			break;
+		
+		case BENCH_MARKER_END:
+			if(index < BENCH_CASE_COUNT) {
+				printf("bench: platform=simavr case=%s iterations=%lu cycles_per_op=%.1f\n",
+					_bench_sim_names[index], (unsigned long)_bench_sim_iterations[index],
+					(double)(avr->cycle - _bench_sim_state.start) / _bench_sim_iterations[index]);
+			}
+			break;
+		
+		case BENCH_MARKER_FAILED:
+			printf("bench: platform=simavr case=%s iterations=%lu failed\n",
+				index < BENCH_CASE_COUNT ? _bench_sim_names[index] : "?",
+				index < BENCH_CASE_COUNT ? (unsigned long)_bench_sim_iterations[index] : 0UL);
+			_bench_sim_state.failed = 1;
+			_bench_sim_state.finished = true;
+			break;
+		
+		case BENCH_MARKER_DONE:
+			_bench_sim_state.finished = true;
+			break;
+	}
+}
+
+static void _bench_sim_ds1307Message(avr_irq_t* irq, uint32_t value, void* param) {
+	(void)irq;
+	(void)param;
+	avr_twi_msg_irq_t message;
+	message.u.v = value;
+	
+	if(message.u.twi.msg & TWI_COND_STOP) {
+		_bench_sim_ds1307.selected = false;
+	}
+	if(message.u.twi.msg & TWI_COND_START) {
+		_bench_sim_ds1307.selected = (message.u.twi.addr >> 1) == BENCH_DS1307_ADDRESS;
+		_bench_sim_ds1307.pointerReceived = false;
+		if(_bench_sim_ds1307.selected) {
+			avr_raise_irq(_bench_sim_ds1307.irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, message.u.twi.addr, 1));
+		}
+	}
+	if(!_bench_sim_ds1307.selected) return;
+	
+	if(message.u.twi.msg & TWI_COND_WRITE) {
+		avr_raise_irq(_bench_sim_ds1307.irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, message.u.twi.addr, 1));
+		// The first byte sets the register pointer, the following ones are written
+		if(_bench_sim_ds1307.pointerReceived) {
+			_bench_sim_ds1307.registers[_bench_sim_ds1307.pointer] = message.u.twi.data;
+			_bench_sim_ds1307.pointer = (_bench_sim_ds1307.pointer + 1) % sizeof(_bench_sim_ds1307.registers);
+		} else {
+			_bench_sim_ds1307.pointer = message.u.twi.data % sizeof(_bench_sim_ds1307.registers);
+			_bench_sim_ds1307.pointerReceived = true;
+		}
+	}
+	if(message.u.twi.msg & TWI_COND_READ) {
+		uint8_t data = _bench_sim_ds1307.registers[_bench_sim_ds1307.pointer];
+		_bench_sim_ds1307.pointer = (_bench_sim_ds1307.pointer + 1) % sizeof(_bench_sim_ds1307.registers);
+		avr_raise_irq(_bench_sim_ds1307.irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, message.u.twi.addr, data));
+	}
+}
+
+/**
+ * @brief Attaches the virtual DS1307 to the TWI of the simulated microcontroller.
+ * 
+ */
+static void _bench_sim_attachDS1307(avr_t* avr) {
+	static const char* names[2] = { "8>ds1307.out", "32<ds1307.in" };
+	// Saturday, 2024-06-01 12:34:56 in BCD, same as the host model
+	static const uint8_t clock[8] = { 0x56, 0x34, 0x12, 0x07, 0x01, 0x06, 0x24, 0x00 };
+	
+	memcpy(_bench_sim_ds1307.registers, clock, sizeof(clock));
+	_bench_sim_ds1307.irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+	avr_irq_register_notify(_bench_sim_ds1307.irq + TWI_IRQ_OUTPUT, _bench_sim_ds1307Message, NULL);
+	
+	avr_connect_irq(_bench_sim_ds1307.irq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+	avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), _bench_sim_ds1307.irq + TWI_IRQ_OUTPUT);
+}
+
+/**
+ * @brief Loops UART0 back and stops simavr from echoing its output to the console.
+ * 
+ */
+static void _bench_sim_loopbackUart(avr_t* avr) {
+	uint32_t flags = 0;
+	avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+	
+	avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT),
+		avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_INPUT));
+}
+
+int main(int argc, char** argv) {
+	if(argc != 2) {
+		fprintf(stderr, "usage: %s <firmware.elf>\n", argv[0]);
+		return 2;
+	}
+	
+	elf_firmware_t firmware;
+	memset(&firmware, 0, sizeof(firmware));
+	if(elf_read_firmware(argv[1], &firmware) != 0) {
+		fprintf(stderr, "bench: could not read '%s'\n", argv[1]);
+		return 2;
+	}
+	
+	avr_t* avr = avr_make_mcu_by_name("atmega2560");
+	if(avr == NULL) {
+		fprintf(stderr, "bench: simavr has no ATmega2560 core\n");
+		return 2;
+	}
+	avr_init(avr);
+	firmware.frequency = _BENCH_SIM_FREQUENCY;
+	avr_load_firmware(avr, &firmware);
+	
+	avr_register_io_write(avr, _BENCH_SIM_GPIOR0, _bench_sim_markerWrite, NULL);
+	_bench_sim_attachDS1307(avr);
+	_bench_sim_loopbackUart(avr);
+	
+	while(!_bench_sim_state.finished) {
+		int state = avr_run(avr);
+		if(state == cpu_Done || state == cpu_Crashed) break;
+		if(avr->cycle > _BENCH_SIM_CYCLE_LIMIT) {
+			fprintf(stderr, "bench: cycle limit exceeded\n");
+			return 1;
+		}
+	}
+	
+	if(!_bench_sim_state.finished) {
+		fprintf(stderr, "bench: firmware stopped before finishing\n");
+		return 1;
+	}
+	return _bench_sim_state.failed;
+}
@@ -8,9 +8,268 @@
 #define CONFIG_H_
 
 /**
- * @brief UART receive buffer size.
+ * @brief Enables the UART0 interface. Set to 0 to remove its buffers, functions and
+ * interrupt service routines from the build.
+ */
+#define UART0_ENABLED 1
+/**
+ * @brief Enables the UART1 interface (used for serial-over-USB on the ELO-Board).
+ */
+#define UART1_ENABLED 1
+/**
+ * @brief Enables the UART2 interface.
+ */
+#define UART2_ENABLED 1
+/**
+ * @brief Enables the UART3 interface.
+ */
+#define UART3_ENABLED 1
+
+/**
+ * @brief Default UART receive buffer size for all interfaces.
  * 
+ * Has to be a power of two not larger than 128.
  */
 #define UART_BUFFER_SIZE 64
 
+/**
+ * @brief Default UART transmit buffer size for all interfaces.
+ * 
+ * Has to be a power of two not larger than 128.
+ */
+#define UART_TX_BUFFER_SIZE 64
+
+/**
+ * @brief Receive buffer size of UART0. Has to be 0 or a power of two not larger than 128.
+ * 
+ * A size of 0 disables the receiver of the interface and removes its receive interrupt service routine.
+ */
+#define UART0_RX_BUFFER_SIZE UART_BUFFER_SIZE
+
+/**
+ * @brief Receive buffer size of UART1, see `UART0_RX_BUFFER_SIZE`.
+ */
+#define UART1_RX_BUFFER_SIZE UART_BUFFER_SIZE
+
+/**
+ * @brief Receive buffer size of UART2, see `UART0_RX_BUFFER_SIZE`.
+ */
+#define UART2_RX_BUFFER_SIZE UART_BUFFER_SIZE
+
+/**
+ * @brief Receive buffer size of UART3, see `UART0_RX_BUFFER_SIZE`.
+ */
+#define UART3_RX_BUFFER_SIZE UART_BUFFER_SIZE
+
+/**
+ * @brief Transmit buffer size of UART0. Has to be 0 or a power of two not larger than 128.
+ * 
+ * A size of 0 disables the transmit buffer of the interface, which then sends every byte synchronously.
+ */
+#define UART0_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+
+/**
+ * @brief Transmit buffer size of UART1, see `UART0_TX_BUFFER_SIZE`.
+ */
+#define UART1_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+
+/**
+ * @brief Transmit buffer size of UART2, see `UART0_TX_BUFFER_SIZE`.
+ */
+#define UART2_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+
+/**
+ * @brief Transmit buffer size of UART3, see `UART0_TX_BUFFER_SIZE`.
+ */
+#define UART3_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+
+/**
+ * @brief Policy applied by the receive interrupt when a byte is received while the receive
+ * buffer is full. One of `UART_OVERFLOW_DROP_NEWEST`, `UART_OVERFLOW_OVERWRITE_OLDEST` or `UART_OVERFLOW_FLAG`.
+ */
+#define UART_RX_OVERFLOW_POLICY UART_OVERFLOW_FLAG
+
+/**
+ * @brief Enables the per-interface statistics counters, see `uart_getStats`.
+ */
+#define UART_STATS_ENABLED 1
+
+/**
+ * @brief Count the delimiters in the receive buffers in the receive interrupt, see `uart_linesAvailable` and `uart_readUntil`.
+ */
+#define UART_LINE_DETECTION 1
+
+/**
+ * @brief Delimiter counted by the line detection until `uart_setDelimiter` is called.
+ */
+#define UART_DEFAULT_DELIMITER '\n'
+
+/**
+ * @brief Enables the master SPI mode of the UART interfaces, see `uart_spiInit`.
+ */
+#define UART_SPI_ENABLED 1
+
+/**
+ * @brief Byte sent in master SPI mode when no transmit data is given.
+ */
+#define UART_SPI_FILL_BYTE 0xFF
+
+/**
+ * @brief Maximum accepted baud rate error of UART_BAUD_SETTING in permille.
+ * 
+ */
+#define UART_BAUD_TOLERANCE 25
+
+/**
+ * @brief I2C timeout in milliseconds for blocking transmissions and default transaction timeout.
+ */
+#define I2C_MASTER_TIMEOUT 25
+
+/**
+ * @brief I2C bitrate used for the DS1307. The DS1307 supports up to 100 kHz.
+ */
+#define DS1307_I2C_BITRATE 10000
+
+/**
+ * @brief Enables the DS1307 cached clock, counting the seconds using the 1 Hz SQW output.
+ */
+#define DS1307_CACHED_CLOCK 0
+
+/**
+ * @brief External interrupt (INTn, 4 - 7 on PORTE) the SQW output of the DS1307 is connected to.
+ */
+#define DS1307_SQW_INTERRUPT 4
+
+/**
+ * @brief Interval in seconds after which the DS1307 cached clock is resynchronized from the chip.
+ */
+#define DS1307_RESYNC_INTERVAL 3600
+
+/**
+ * @brief Stores the function name in thrown errors. Costs SRAM, as function names can't be placed in flash.
+ */
+#define ERROR_FUNCTION_NAMES 0
+
+/**
+ * @brief Propagate errors inside the library as return codes and only throw at the public API.
+ */
+#define ERROR_RETURN_CODES 0
+
+/**
+ * @brief Number of records in the error log (error_log.h). Has to be a power of two up to 128, or 0 to disable the log.
+ */
+#define ERROR_LOG_SIZE 8
+
+/**
+ * @brief Storage the error log is persisted to on an uncaught error: `ERROR_LOG_STORAGE_NONE`, `ERROR_LOG_STORAGE_EEPROM`
+ * or `ERROR_LOG_STORAGE_DS1307`. The persisted records overwrite the configured area of the storage.
+ */
+#define ERROR_LOG_STORAGE ERROR_LOG_STORAGE_NONE
+
+/**
+ * @brief Start address of the persisted error log in the EEPROM.
+ */
+#define ERROR_LOG_EEPROM_ADDRESS 0
+
+/**
+ * @brief Offset of the persisted error log in the battery-backed RAM of the DS1307.
+ */
+#define ERROR_LOG_DS1307_OFFSET 0
+
+/**
+ * @brief Let the watchdog reset the board after an uncaught error was reported, instead of halting.
+ */
+#define ERROR_LOG_WATCHDOG_RESET 0
+
+/**
+ * @brief Enables the profiling instrumentation (profile.h).
+ */
+#define PROFILE_ENABLED 0
+
+/**
+ * @brief Free-running 16-bit timer (1 or 5) used for profiling, running at F_CPU / 8.
+ */
+#define PROFILE_TIMER 5
+
+/**
+ * @brief Number of profiling probes available to the application.
+ */
+#define PROFILE_APP_PROBES 4
+
+/**
+ * @brief Number of columns of the terminal framebuffer (terminal_fb.h). Each cell takes 3 bytes of SRAM.
+ */
+#define TERMINAL_FB_COLUMNS 40
+
+/**
+ * @brief Number of rows of the terminal framebuffer.
+ */
+#define TERMINAL_FB_ROWS 12
+
+/**
+ * @brief Collect the USB terminal output in a line buffer and write it to the UART transmit buffer in blocks.
+ */
+#define USB_TERMINAL_LINE_BUFFERED 0
+
+/**
+ * @brief Size of the USB terminal line buffer in bytes.
+ */
+#define USB_TERMINAL_LINE_BUFFER_SIZE 64
+
+/**
+ * @brief UART interface the binary telemetry frames (telemetry.h) are sent over.
+ */
+#define TELEMETRY_UART UART1
+
+/**
+ * @brief Maximum payload length of a telemetry frame (up to 120). The transmit buffer of the interface
+ * has to hold TELEMETRY_MAX_PAYLOAD + 5 bytes.
+ */
+#define TELEMETRY_MAX_PAYLOAD 32
+
+/**
+ * @brief Enables the cooperative event loop (scheduler.h), whose 1 ms tick also drives i2c_master_tick.
+ */
+#define SCHEDULER_ENABLED 0
+
+/**
+ * @brief 8-bit timer (0 or 2) generating the scheduler tick.
+ */
+#define SCHEDULER_TIMER 0
+
+/**
+ * @brief Size of the static scheduler task table. Each task takes 13 bytes of SRAM.
+ */
+#define SCHEDULER_MAX_TASKS 8
+
+/**
+ * @brief Enables the debounced switches and buttons (input.h).
+ */
+#define INPUT_ENABLED 0
+
+/**
+ * @brief 8-bit timer (0 or 2) sampling the inputs. Has to differ from SCHEDULER_TIMER.
+ */
+#define INPUT_TIMER 2
+
+/**
+ * @brief Time between two input samples in ms (1 to 16). The debounce time is 4 sample periods.
+ */
+#define INPUT_SAMPLE_PERIOD 5
+
+/**
+ * @brief Number of input events which can be queued (power of two).
+ */
+#define INPUT_EVENT_QUEUE_SIZE 16
+
+/**
+ * @brief Whether a switch reads as 0 when it is on.
+ */
+#define INPUT_SWITCHES_ACTIVE_LOW 0
+
+/**
+ * @brief Whether a button reads as 0 when it is pressed.
+ */
+#define INPUT_BUTTONS_ACTIVE_LOW 0
+
 #endif /* CONFIG_H_ */
\ No newline at end of file
@@ -2,13 +2,64 @@
  * @file ds1307.h
  * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
  * @brief Driver library for the DS1307 real time clock IC. Communication happens over I2C.
+ * 
+ * The blocking functions use the interrupt driven I2C engine (see @ref i2c_master_wait). With interrupts
+ * disabled, e.g. in an interrupt service routine or an `ATOMIC_BLOCK`, the engine is driven by polling instead.
  */
 #include <stdint.h>
 #include <time.h>
+#include <elob/drivers/i2c_master.h>
+#include "../../../../config.h"
 
 #ifndef DS1307_H_
 #define DS1307_H_
 
+// Use the default bitrate if none is configured
+#ifndef DS1307_I2C_BITRATE
+/**
+ * @brief I2C bitrate used for the DS1307. The DS1307 supports up to 100 kHz (standard mode).
+ * 
+ */
+#define DS1307_I2C_BITRATE 10000
+#endif
+
+#ifndef DS1307_CACHED_CLOCK
+/**
+ * @brief Enables the cached clock. The DS1307 then outputs a 1 Hz square wave on SQW, which has
+ * to be connected to the external interrupt @ref DS1307_SQW_INTERRUPT. The time is counted locally
+ * and only resynchronized from the DS1307 every @ref DS1307_RESYNC_INTERVAL seconds,
+ * see @ref DS1307_getCachedDatetime.
+ * 
+ */
+#define DS1307_CACHED_CLOCK 0
+#endif
+
+#ifndef DS1307_SQW_INTERRUPT
+/**
+ * @brief Number of the external interrupt (INTn) the SQW output of the DS1307 is connected to, from 4 to 7
+ * (PE4 - PE7). INT0 and INT1 share their pins with the I2C interface and INT2 and INT3 (PD2 and PD3)
+ * with USART1, i.e. the USB terminal, so they are not available.
+ * 
+ */
+#define DS1307_SQW_INTERRUPT 4
+#endif
+
+#ifndef DS1307_RESYNC_INTERVAL
+/**
+ * @brief Interval in seconds after which the cached clock is resynchronized from the DS1307.
+ * 
+ */
+#define DS1307_RESYNC_INTERVAL 3600
+#endif
+
+#if DS1307_CACHED_CLOCK && (DS1307_SQW_INTERRUPT < 4 || DS1307_SQW_INTERRUPT > 7)
+#error "DS1307_SQW_INTERRUPT has to be between 4 and 7, INT0 to INT3 share their pins with I2C and USART1."
+#endif
+
+#if DS1307_CACHED_CLOCK && (DS1307_RESYNC_INTERVAL < 1 || DS1307_RESYNC_INTERVAL > UINT16_MAX)
+#error "DS1307_RESYNC_INTERVAL has to be between 1 and 65535."
+#endif
+
 /**
  * @brief Enumerator defining the internal registers of the DS1307.
  * The enumeration values correspond to the register addresses.
@@ -25,9 +76,53 @@ typedef enum {
 	DS1307_CTRL_REGISTER = 0x07
 } DS1307Register_t;
 
+/**
+ * @brief Size of the battery-backed RAM of the DS1307 in bytes.
+ * 
+ */
+#define DS1307_RAM_SIZE 56
+
+/**
+ * @brief Struct holding the decoded time fields of the DS1307.
+ * 
+ */
+typedef struct {
+	/**
+	 * @brief Year since 2000 (0 - 99).
+	 */
+	uint8_t year;
+	/**
+	 * @brief Month (1 - 12).
+	 */
+	uint8_t month;
+	/**
+	 * @brief Day of the month (1 - 31).
+	 */
+	uint8_t day;
+	/**
+	 * @brief Day of the week (1 - 7, 1 is sunday).
+	 */
+	uint8_t dayOfWeek;
+	/**
+	 * @brief Hour (0 - 23).
+	 */
+	uint8_t hour;
+	/**
+	 * @brief Minute (0 - 59).
+	 */
+	uint8_t minute;
+	/**
+	 * @brief Second (0 - 59).
+	 */
+	uint8_t second;
+} DS1307_Datetime_t;
+
 /**
  * @brief Initializes all resources required for communicating with the DS1307.
  * 
+ * If @ref DS1307_CACHED_CLOCK is enabled, this also enables the SQW output, reads the current
+ * time and enables the external interrupt counting the seconds. Interrupts have to be enabled
+ * for the cached clock to run.
  */
 void DS1307_init();
 
@@ -63,14 +158,129 @@ void DS1307_setAllRegisters(uint8_t* registerTable);
 /**
  * @brief Gets a timestamp from the DS1307.
  * 
- * @return A timestamp as specified in the documentation of `time_t`.
+ * @return A timestamp as specified in the documentation of `time_t` (seconds since 2000-01-01 00:00:00).
  */
 time_t DS1307_getDatetime();
 /**
  * @brief Sets the time of the DS1307 to the specified timestamp.
+ * Only the time registers are written, the control register is left untouched.
+ * 
+ * @param datetime A timestamp as specified in the documentation of `time_t` (seconds since 2000-01-01 00:00:00).
+ */
+void DS1307_setDatetime(time_t datetime);
+
+/**
+ * @brief Reads the decoded time fields from the DS1307 without any timestamp calculations,
+ * e.g. for displaying the time.
+ * 
+ * @param datetime The struct to store the fields to.
+ */
+void DS1307_getDatetimeFields(DS1307_Datetime_t* datetime);
+/**
+ * @brief Sets the time of the DS1307 to the specified fields.
+ * Only the time registers are written, the control register is left untouched.
+ * 
+ * @param datetime The fields to set. The day of the week is written as is.
+ */
+void DS1307_setDatetimeFields(const DS1307_Datetime_t* datetime);
+
+/**
+ * @brief Converts the time fields to a timestamp using integer arithmetic only.
+ * 
+ * @param datetime The fields to convert.
+ * @return A timestamp as specified in the documentation of `time_t` (seconds since 2000-01-01 00:00:00).
+ */
+time_t DS1307_toTimestamp(const DS1307_Datetime_t* datetime);
+/**
+ * @brief Converts a timestamp to the time fields (including the day of the week) using integer arithmetic only.
+ * 
+ * @param time A timestamp (seconds since 2000-01-01 00:00:00), up to the end of 2099.
+ * @param datetime The struct to store the fields to.
+ */
+void DS1307_fromTimestamp(time_t time, DS1307_Datetime_t* datetime);
+
+/**
+ * @brief Reads a block from the battery-backed RAM of the DS1307 in one burst transaction.
+ * 
+ * @param offset The offset of the first byte in the RAM (0 - 55).
+ * @param dst The buffer to read to.
+ * @param n The number of bytes to read.
+ * 
+ * @exception ERR_OUT_OF_RANGE The block exceeds the RAM size (@ref DS1307_RAM_SIZE).
+ * @exception ERR_I2C_TRANSMISSION A I2C transmission error occurred.
+ * @exception ERR_I2C_TIMEOUT The transaction did not finish in time. The timeout grows with @p n at the @ref DS1307_I2C_BITRATE.
+ */
+void DS1307_readRAM(uint8_t offset, uint8_t* dst, uint8_t n);
+/**
+ * @brief Writes a block to the battery-backed RAM of the DS1307 in one burst transaction.
+ * 
+ * @param offset The offset of the first byte in the RAM (0 - 55).
+ * @param src The data to write.
+ * @param n The number of bytes to write.
+ * 
+ * @exception ERR_OUT_OF_RANGE The block exceeds the RAM size (@ref DS1307_RAM_SIZE).
+ * @exception ERR_I2C_TRANSMISSION A I2C transmission error occurred.
+ * @exception ERR_I2C_TIMEOUT The transaction did not finish in time. The timeout grows with @p n at the @ref DS1307_I2C_BITRATE.
+ */
+void DS1307_writeRAM(uint8_t offset, const uint8_t* src, uint8_t n);
+/**
+ * @brief Writes a block to the battery-backed RAM of the DS1307 by polling the I2C interface.
+ * Unlike @ref DS1307_writeRAM, this doesn't rely on the TWI interrupt, so it also works with
+ * interrupts disabled, e.g. in an error handler.
+ * 
+ * @param offset The offset of the first byte in the RAM (0 - 55).
+ * @param src The data to write.
+ * @param n The number of bytes to write.
+ * 
+ * @exception ERR_OUT_OF_RANGE The block exceeds the RAM size (@ref DS1307_RAM_SIZE).
+ * @exception ERR_I2C_TRANSMISSION A I2C transmission error occurred.
+ * @exception ERR_I2C_TIMEOUT The bus did not respond within @ref I2C_MASTER_TIMEOUT.
+ */
+void DS1307_writeRAMPolled(uint8_t offset, const uint8_t* src, uint8_t n);
+
+/**
+ * @brief Queues an asynchronous read of a block from the battery-backed RAM of the DS1307.
+ * The transaction is set up by this function, except for the callback and context, which can
+ * be set by the caller beforehand. Check its status or wait for it using @ref i2c_master_wait.
+ * 
+ * @param transaction The transaction to use. It has to stay valid until it finished.
+ * @param offset The offset of the first byte in the RAM (0 - 55).
+ * @param dst The buffer to read to. It has to stay valid until the transaction finished.
+ * @param n The number of bytes to read.
+ * 
+ * @exception ERR_OUT_OF_RANGE The block exceeds the RAM size (@ref DS1307_RAM_SIZE).
+ */
+void DS1307_readRAMAsync(i2c_transaction_t* transaction, uint8_t offset, uint8_t* dst, uint8_t n);
+/**
+ * @brief Queues an asynchronous write of a block to the battery-backed RAM of the DS1307.
+ * The transaction is set up by this function, except for the callback and context, which can
+ * be set by the caller beforehand. Check its status or wait for it using @ref i2c_master_wait.
+ * 
+ * @param transaction The transaction to use. It has to stay valid until it finished.
+ * @param offset The offset of the first byte in the RAM (0 - 55).
+ * @param src The data to write. It has to stay valid until the transaction finished.
+ * @param n The number of bytes to write.
+ * 
+ * @exception ERR_OUT_OF_RANGE The block exceeds the RAM size (@ref DS1307_RAM_SIZE).
+ */
+void DS1307_writeRAMAsync(i2c_transaction_t* transaction, uint8_t offset, const uint8_t* src, uint8_t n);
+
+#if DS1307_CACHED_CLOCK
+/**
+ * @brief Gets the locally counted timestamp without any I2C communication.
+ * 
+ * Only available if @ref DS1307_CACHED_CLOCK is enabled.
+ * 
+ * @return A timestamp as specified in the documentation of `time_t`.
+ */
+time_t DS1307_getCachedDatetime();
+
+/**
+ * @brief Requests the cached clock to be resynchronized from the DS1307 with the next tick,
+ * regardless of @ref DS1307_RESYNC_INTERVAL.
  * 
- * @param datetime A timestamp as specified in the documentation of `time_t`.
  */
-void DS1307_setTime(time_t datetime);
+void DS1307_requestResync();
+#endif
 
 #endif /* DS1307_H_ */
\ No newline at end of file
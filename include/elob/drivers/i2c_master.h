@@ -2,15 +2,90 @@
  * @file i2c_master.h
  * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
  * @brief Driver for I2C (TWI) in master mode.
+ * 
+ * Transactions run in the background on the interrupt driven engine (see @ref i2c_master_submit).
+ * @ref i2c_master_transfer, @ref i2c_master_readRegisters and @ref i2c_master_writeRegisters are
+ * thin wrappers, which submit a transaction and wait for it.
+ * 
+ * The byte-level frame functions (@ref i2c_master_startFrame, @ref i2c_master_sendByte,
+ * @ref i2c_master_readByte and @ref i2c_master_endFrame) still poll the hardware, as the length of
+ * a frame isn't known in advance and a transaction has to describe it completely. A frame owns
+ * the bus from its start to its end, so transactions submitted meanwhile (e.g. from an interrupt)
+ * are queued and started afterwards.
  */
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <elob/elob.h>
+#include "../../../../config.h"
 
 #ifndef I2C_MASTER_H_
 #define I2C_MASTER_H_
 
+// Use the default timeout if none is configured
+#ifndef I2C_MASTER_TIMEOUT
+/**
+ * @brief Timeout in milliseconds for the blocking I2C functions, e.g. for a single byte
+ * transmission of @ref i2c_master_sendByte. Also used as the default transaction timeout.
+ * 
+ */
+#define I2C_MASTER_TIMEOUT 25
+#endif
+
+/**
+ * @brief Type holding a precomputed bitrate setting, i.e. the TWBR value in the lower byte
+ * and the TWPS prescaler bits in the upper byte.
+ * 
+ * Use @ref I2C_BITRATE_SETTING to calculate it at compile time.
+ */
+typedef uint16_t i2c_bitrateSetting_t;
+
+/**
+ * @brief Calculates the TWBR value for the given bitrate and prescaler bits, rounded up so the
+ * resulting bitrate never exceeds the requested one.
+ * 
+ */
+#define _I2C_TWBR(bitrate, prescalerBits) \
+	((F_CPU - 16UL * (bitrate) + (2UL << (2 * (prescalerBits))) * (bitrate) - 1) / ((2UL << (2 * (prescalerBits))) * (bitrate)))
+
+/**
+ * @brief Selects the smallest prescaler for which the TWBR value for the given bitrate fits into 8 bits.
+ * 
+ */
+#define _I2C_PRESCALER_BITS(bitrate) ( \
+	_I2C_TWBR(bitrate, 0) <= UINT8_MAX ? 0 : \
+	_I2C_TWBR(bitrate, 1) <= UINT8_MAX ? 1 : \
+	_I2C_TWBR(bitrate, 2) <= UINT8_MAX ? 2 : 3 \
+	)
+
+/**
+ * @brief Checks if the given bitrate can be generated by the hardware.
+ * 
+ */
+#define I2C_BITRATE_REACHABLE(bitrate) (16UL * (bitrate) <= F_CPU && _I2C_TWBR(bitrate, 3) <= UINT8_MAX)
+
+/**
+ * @brief Calculates the @ref i2c_bitrateSetting_t for the given bitrate without checking if it is reachable.
+ * 
+ * This works at runtime as well, but prefer @ref I2C_BITRATE_SETTING for constant bitrates.
+ */
+#define I2C_BITRATE_SETTING_UNCHECKED(bitrate) ((i2c_bitrateSetting_t)( \
+	(_I2C_PRESCALER_BITS(bitrate) << 8) | _I2C_TWBR(bitrate, _I2C_PRESCALER_BITS(bitrate)) \
+	))
+
+/**
+ * @brief Calculates the @ref i2c_bitrateSetting_t for the given constant bitrate at compile time.
+ * 
+ * Compilation fails (with a negative array size error) if the bitrate can't be reached.
+ * 
+ * @code{.c}
+ * i2c_master_setBitrateSetting(I2C_BITRATE_SETTING(100000));
+ * @endcode
+ */
+#define I2C_BITRATE_SETTING(bitrate) ((i2c_bitrateSetting_t)(I2C_BITRATE_SETTING_UNCHECKED(bitrate) + 0 * sizeof(char[ \
+	I2C_BITRATE_REACHABLE(bitrate) ? 1 : -1 \
+	])))
+
 /**
  * @brief Enumeration defining the I2C status codes supplied by the hardware I2C interface.
  * 
@@ -57,15 +132,160 @@ typedef enum {
 	I2C_ACK = 1,
 } i2c_ackType_t;
 
+/**
+ * @brief Enumeration defining the states of an asynchronous I2C transaction.
+ * 
+ * All states from @ref I2C_TRANSACTION_DONE onwards indicate a finished transaction.
+ */
+typedef enum {
+	/**
+	 * @brief The transaction is queued and waits for the bus.
+	 */
+	I2C_TRANSACTION_PENDING = 0,
+	/**
+	 * @brief The transaction is currently being executed.
+	 */
+	I2C_TRANSACTION_ACTIVE,
+	/**
+	 * @brief The transaction completed successfully.
+	 */
+	I2C_TRANSACTION_DONE,
+	/**
+	 * @brief The slave did not acknowledge its address or a data byte.
+	 */
+	I2C_TRANSACTION_NACK,
+	/**
+	 * @brief A bus error occurred, the arbitration was lost or the hardware indicated an unexpected status.
+	 */
+	I2C_TRANSACTION_ERROR,
+	/**
+	 * @brief The transaction did not complete within its timeout and was aborted.
+	 */
+	I2C_TRANSACTION_TIMEOUT
+} i2c_transactionStatus_t;
+
+/**
+ * @brief Type of an asynchronous I2C transaction.
+ */
+typedef struct i2c_transaction i2c_transaction_t;
+
+/**
+ * @brief Callback called when an asynchronous I2C transaction finished.
+ * This is called from the TWI interrupt service routine, so keep it short.
+ */
+typedef void (*i2c_transactionCallback_t)(i2c_transaction_t* transaction);
+
+/**
+ * @brief Struct describing an asynchronous I2C transaction.
+ * 
+ * A transaction first writes the optional register address and @ref txLength bytes and then,
+ * after a repeated start condition, reads @ref rxLength bytes. Either part can be empty. The struct and the data buffers are
+ * owned by the caller and have to stay valid until the transaction finished.
+ */
+struct i2c_transaction {
+	/**
+	 * @brief 7-bit address of the slave.
+	 */
+	uint8_t slaveAddress;
+	/**
+	 * @brief Whether @ref registerAddress is written before @ref txData.
+	 */
+	bool useRegisterAddress;
+	/**
+	 * @brief Register address written first if @ref useRegisterAddress is set, e.g. to set the
+	 * internal memory pointer of the slave when reading or writing a block of registers.
+	 */
+	uint8_t registerAddress;
+	/**
+	 * @brief Data to write to the slave.
+	 */
+	const uint8_t* txData;
+	/**
+	 * @brief Number of bytes to write to the slave.
+	 */
+	uint8_t txLength;
+	/**
+	 * @brief Buffer the data read from the slave is stored to.
+	 */
+	uint8_t* rxData;
+	/**
+	 * @brief Number of bytes to read from the slave.
+	 */
+	uint8_t rxLength;
+	/**
+	 * @brief Timeout in milliseconds, counted from the start of the transaction on the bus.
+	 * Enforced by @ref i2c_master_tick and @ref i2c_master_wait.
+	 */
+	uint16_t timeout;
+	/**
+	 * @brief Optional callback called when the transaction finished. May be `NULL`.
+	 */
+	i2c_transactionCallback_t callback;
+	/**
+	 * @brief Optional pointer for use by the callback.
+	 */
+	void* context;
+	/**
+	 * @brief The current state of the transaction.
+	 */
+	volatile i2c_transactionStatus_t status;
+	
+	// Internal fields, do not access these in your application.
+	uint8_t _index;
+	bool _reading;
+	volatile uint16_t _remainingTime;
+	i2c_transaction_t* _next;
+};
+
+/**
+ * @brief Static initializer for a @ref i2c_transaction_t using the default timeout.
+ * 
+ * @param address The 7-bit slave address.
+ * @param tx The data to write, may be `NULL`.
+ * @param txLen The number of bytes to write.
+ * @param rx The buffer to read to, may be `NULL`.
+ * @param rxLen The number of bytes to read.
+ */
+#define I2C_TRANSACTION(address, tx, txLen, rx, rxLen) { \
+	.slaveAddress = (address), .useRegisterAddress = false, .registerAddress = 0, .txData = (tx), .txLength = (txLen), .rxData = (rx), .rxLength = (rxLen), \
+	.timeout = I2C_MASTER_TIMEOUT, .callback = NULL, .context = NULL, .status = I2C_TRANSACTION_DONE \
+	}
+
+/**
+ * @brief Static initializer for a @ref i2c_transaction_t which accesses a block of registers
+ * starting at the given register address, using the default timeout.
+ * 
+ * @param address The 7-bit slave address.
+ * @param reg The register address written before the data.
+ * @param tx The data to write, may be `NULL`.
+ * @param txLen The number of bytes to write.
+ * @param rx The buffer to read to, may be `NULL`.
+ * @param rxLen The number of bytes to read.
+ */
+#define I2C_REGISTER_TRANSACTION(address, reg, tx, txLen, rx, rxLen) { \
+	.slaveAddress = (address), .useRegisterAddress = true, .registerAddress = (reg), .txData = (tx), .txLength = (txLen), \
+	.rxData = (rx), .rxLength = (rxLen), .timeout = I2C_MASTER_TIMEOUT, .callback = NULL, .context = NULL, .status = I2C_TRANSACTION_DONE \
+	}
+
 /**
  * @brief Sets the I2C interface bitrate.
  * 
+ * The setting is calculated at runtime, prefer @ref i2c_master_setBitrateSetting with
+ * @ref I2C_BITRATE_SETTING for constant bitrates.
+ * 
  * @param bitrate The bitrate to set the interface to.
  * 
  * @exception ERR_BITRATE_TOO_LOW Raised when the passed bitrate is not achievable with the available prescalers.
  */
 void i2c_master_setBitrate(uint32_t bitrate);
 
+/**
+ * @brief Sets the I2C interface bitrate using a precomputed setting.
+ * 
+ * @param setting The setting, see @ref I2C_BITRATE_SETTING.
+ */
+void i2c_master_setBitrateSetting(i2c_bitrateSetting_t setting);
+
 /**
  * @brief Enables the I2C master interface.
  * 
@@ -78,6 +298,105 @@ void i2c_master_enable();
  */
 void i2c_master_disable();
 
+/**
+ * @brief Queues an asynchronous I2C transaction. The transaction is executed in the
+ * background by the TWI interrupt as soon as the bus is free. While a frame started with
+ * @ref i2c_master_startFrame owns the bus, the transaction only starts after @ref i2c_master_endFrame.
+ * 
+ * This can also be called from interrupt service routines (e.g. from a transaction callback).
+ * 
+ * @param transaction The transaction to execute. It must not already be queued.
+ */
+void i2c_master_submit(i2c_transaction_t* transaction);
+
+/**
+ * @brief Checks if the asynchronous transaction engine is executing or has queued transactions.
+ * 
+ * @return `true` if a transaction is active or queued, otherwise `false`.
+ */
+bool i2c_master_busy();
+
+/**
+ * @brief Checks if the given transaction has finished (successfully or not).
+ * 
+ * @param transaction The transaction to check.
+ * @return `true` if the transaction has finished, otherwise `false`.
+ */
+bool i2c_master_finished(i2c_transaction_t* transaction);
+
+/**
+ * @brief Blocks until the given transaction has finished. While waiting, any transaction
+ * occupying the bus longer than its timeout (measured from the call of this function) is aborted,
+ * so this works without @ref i2c_master_tick as well.
+ * 
+ * If interrupts are disabled, the TWI interrupt can't advance the transactions, so this polls the
+ * TWINT flag and advances them itself. As all blocking functions wait using this function, they also
+ * work in interrupt service routines, in an `ATOMIC_BLOCK` and before interrupts were enabled.
+ * 
+ * @param transaction The transaction to wait for.
+ * @return The final status of the transaction.
+ */
+i2c_transactionStatus_t i2c_master_wait(i2c_transaction_t* transaction);
+
+/**
+ * @brief Advances the timeouts of the asynchronous transaction engine by one millisecond.
+ * 
+ * Call this every millisecond (e.g. from a timer interrupt) to bound the duration of background
+ * transactions. The active transaction is aborted with @ref I2C_TRANSACTION_TIMEOUT if its timeout expired.
+ */
+void i2c_master_tick();
+
+/**
+ * @brief Executes a write-then-read transaction and blocks until it finished.
+ * 
+ * @param slaveAddress The 7-bit slave address.
+ * @param txData The data to write, may be `NULL` if @p txLength is 0.
+ * @param txLength The number of bytes to write.
+ * @param rxData The buffer to read to, may be `NULL` if @p rxLength is 0.
+ * @param rxLength The number of bytes to read.
+ * 
+ * @exception ERR_I2C_TRANSMISSION The slave did not acknowledge or a bus error occurred.
+ * @exception ERR_I2C_TIMEOUT The transaction did not finish within @ref I2C_MASTER_TIMEOUT.
+ */
+void i2c_master_transfer(uint8_t slaveAddress, const uint8_t* txData, uint8_t txLength, uint8_t* rxData, uint8_t rxLength);
+
+/**
+ * @brief Executes the given transaction and blocks until it finished. Unlike the other blocking
+ * functions, this uses the timeout of the transaction, e.g. for long transfers at a low bitrate.
+ * 
+ * @param transaction The transaction to execute. It must not already be queued.
+ * 
+ * @exception ERR_I2C_TRANSMISSION The slave did not acknowledge or a bus error occurred.
+ * @exception ERR_I2C_TIMEOUT The transaction did not finish within its timeout.
+ */
+void i2c_master_execute(i2c_transaction_t* transaction);
+
+/**
+ * @brief Reads a block of consecutive registers in one burst transaction and blocks until it finished.
+ * 
+ * @param slaveAddress The 7-bit slave address.
+ * @param registerAddress The address of the first register.
+ * @param dst The buffer to store the register values to.
+ * @param n The number of registers to read.
+ * 
+ * @exception ERR_I2C_TRANSMISSION The slave did not acknowledge or a bus error occurred.
+ * @exception ERR_I2C_TIMEOUT The transaction did not finish within @ref I2C_MASTER_TIMEOUT.
+ */
+void i2c_master_readRegisters(uint8_t slaveAddress, uint8_t registerAddress, uint8_t* dst, uint8_t n);
+
+/**
+ * @brief Writes a block of consecutive registers in one burst transaction and blocks until it finished.
+ * 
+ * @param slaveAddress The 7-bit slave address.
+ * @param registerAddress The address of the first register.
+ * @param src The register values to write.
+ * @param n The number of registers to write.
+ * 
+ * @exception ERR_I2C_TRANSMISSION The slave did not acknowledge or a bus error occurred.
+ * @exception ERR_I2C_TIMEOUT The transaction did not finish within @ref I2C_MASTER_TIMEOUT.
+ */
+void i2c_master_writeRegisters(uint8_t slaveAddress, uint8_t registerAddress, const uint8_t* src, uint8_t n);
+
 /**
  * @brief Checks the current status code indicated by the hardware TWI interface.
  * If there is a transmission or bus error, this throws an error.
@@ -92,12 +411,15 @@ i2c_masterStatus_t i2c_master_checkStatus();
  * @brief Starts an I2C frame with the given slave address and communication direction.
  * 
  * Under the hood, this sends a start condition and then sends the slave address and a
- * read/write bit.
+ * read/write bit. The first call waits until the queued transactions finished, afterwards the frame
+ * owns the bus until @ref i2c_master_endFrame, also after an error. Calling this again within the
+ * frame generates a repeated start condition.
  * 
  * @param slaveAddress The slave address you want to start the frame with.
  * @param direction The direction the frame is going to go (transmit/receive).
  * 
  * @exception ERR_I2C_TRANSMISSION A I2C transmission error occurred.
+ * @exception ERR_I2C_TIMEOUT The bus did not respond within @ref I2C_MASTER_TIMEOUT.
  */
 void i2c_master_startFrame(uint8_t slaveAddress, i2c_communicationDirection_t direction);
 
@@ -108,6 +430,7 @@ void i2c_master_startFrame(uint8_t slaveAddress, i2c_communicationDirection_t di
  * @param data The data byte you want to send to the interface.
  * 
  * @exception ERR_I2C_TRANSMISSION A I2C transmission error occurred.
+ * @exception ERR_I2C_TIMEOUT The bus did not respond within @ref I2C_MASTER_TIMEOUT.
  */
 void i2c_master_sendByte(uint8_t data);
 
@@ -117,11 +440,15 @@ void i2c_master_sendByte(uint8_t data);
  * 
  * @param ackType The type of acknowledgement you want to send to the I2C slave.
  * @return The data byte received from the interface.
+ * 
+ * @exception ERR_I2C_TRANSMISSION A I2C transmission error occurred.
+ * @exception ERR_I2C_TIMEOUT The bus did not respond within @ref I2C_MASTER_TIMEOUT.
  */
 uint8_t i2c_master_readByte(i2c_ackType_t ackType);
 
 /**
- * @brief Ends a I2C frame. This sends a stop condition.
+ * @brief Ends a I2C frame. This sends a stop condition, releases the bus and starts the
+ * transactions queued in the meantime.
  * 
  */
 void i2c_master_endFrame();
@@ -0,0 +1,197 @@
+/**
+ * @file input.h
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Debounced inputs for the switches (PORTC) and buttons (PORTJ) of the ELO-Board.
+ * 
+ * A timer interrupt samples both ports every @ref INPUT_SAMPLE_PERIOD milliseconds and debounces
+ * all 8 bits of a port in parallel using vertical counters: a bit of the stable state only changes
+ * after 4 consecutive samples differed from it, i.e. after 4 sample periods (20 ms by default).
+ * Reading the stable state is a single memory access, so there are no busy-wait delays anymore.
+ * 
+ * Every change of the stable state is queued as a press or release event. If the scheduler is
+ * enabled, queueing an event signals @ref SCHEDULER_EVENT_INPUT.
+ * 
+ * The functions are only available if @ref INPUT_ENABLED is enabled.
+ * 
+ * @code{.c}
+ * void handleInputs(void* context) {
+ *     InputEvent_t event;
+ *     while(input_getEvent(&event)) {
+ *         if(event.port == INPUT_BUTTONS && event.pressed) PORTA ^= 1 << event.bit;
+ *     }
+ * }
+ * 
+ * scheduler_onEvent(SCHEDULER_EVENT_INPUT, handleInputs, NULL);
+ * @endcode
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <elob/util/buffer.h>
+#include <elob/util/scheduler.h>
+#include "../../../../config.h"
+
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#ifndef INPUT_ENABLED
+/**
+ * @brief Enables the debounced inputs. If enabled, @ref elob_init starts sampling.
+ * 
+ */
+#define INPUT_ENABLED 0
+#endif
+
+#ifndef INPUT_TIMER
+/**
+ * @brief 8-bit timer sampling the inputs, either 0 or 2. The timer is reserved if @ref INPUT_ENABLED
+ * is enabled, so it has to differ from @ref SCHEDULER_TIMER if the scheduler is enabled as well.
+ * 
+ */
+#define INPUT_TIMER 2
+#endif
+
+#ifndef INPUT_SAMPLE_PERIOD
+/**
+ * @brief Time between two samples in milliseconds, from 1 to 16. The debounce time is 4 sample periods.
+ * 
+ */
+#define INPUT_SAMPLE_PERIOD 5
+#endif
+
+#ifndef INPUT_EVENT_QUEUE_SIZE
+/**
+ * @brief Number of events which can be queued, a power of two not larger than @ref BUFFER_MAX_SIZE.
+ * Events are dropped while the queue is full.
+ * 
+ */
+#define INPUT_EVENT_QUEUE_SIZE 16
+#endif
+
+#ifndef INPUT_SWITCHES_ACTIVE_LOW
+/**
+ * @brief Whether a switch reads as 0 when it is on. The stable state is always 1 for an active input.
+ * 
+ */
+#define INPUT_SWITCHES_ACTIVE_LOW 0
+#endif
+
+#ifndef INPUT_BUTTONS_ACTIVE_LOW
+/**
+ * @brief Whether a button reads as 0 when it is pressed. The stable state is always 1 for an active input.
+ * 
+ */
+#define INPUT_BUTTONS_ACTIVE_LOW 0
+#endif
+
+#if INPUT_SAMPLE_PERIOD < 1 || INPUT_SAMPLE_PERIOD > 16
+#error "INPUT_SAMPLE_PERIOD has to be between 1 and 16."
+#endif
+
+#if !BUFFER_SIZE_VALID(INPUT_EVENT_QUEUE_SIZE)
+#error "INPUT_EVENT_QUEUE_SIZE has to be a power of two not larger than BUFFER_MAX_SIZE."
+#endif
+
+#if INPUT_ENABLED && SCHEDULER_ENABLED && INPUT_TIMER == SCHEDULER_TIMER
+#error "INPUT_TIMER and SCHEDULER_TIMER have to differ."
+#endif
+
+/**
+ * @brief Enumerator defining the sampled ports.
+ * 
+ */
+typedef enum {
+	/**
+	 * @brief The switches on PORTC.
+	 * 
+	 */
+	INPUT_SWITCHES = 0,
+	/**
+	 * @brief The buttons on PORTJ.
+	 * 
+	 */
+	INPUT_BUTTONS = 1
+} Input_Port_t;
+
+/**
+ * @brief Number of sampled ports.
+ * 
+ */
+#define INPUT_PORTS 2
+
+/**
+ * @brief Struct describing a change of the stable state of an input.
+ * 
+ */
+typedef struct {
+	/**
+	 * @brief The port of the input.
+	 */
+	Input_Port_t port;
+	/**
+	 * @brief The bit of the input within the port (0 to 7).
+	 */
+	uint8_t bit;
+	/**
+	 * @brief `true` if the input became active (pressed or switched on), `false` if it was released.
+	 */
+	bool pressed;
+} InputEvent_t;
+
+#if INPUT_ENABLED
+/**
+ * @brief Internal stable states of the ports. Do not access this in your application, use @ref input_state instead.
+ * 
+ */
+extern volatile uint8_t _input_states[INPUT_PORTS];
+
+/**
+ * @brief Starts sampling the inputs. The current levels are taken as the initial stable state,
+ * so no events are queued for inputs which are already active. Called automatically by @ref elob_init.
+ * 
+ */
+void input_init();
+
+/**
+ * @brief Gets the debounced state of all inputs of a port, with a 1 for every active input.
+ * 
+ * @param port The port.
+ * @return The stable state.
+ */
+static inline uint8_t input_state(Input_Port_t port) {
+	return _input_states[port];
+}
+
+/**
+ * @brief Checks if a single input is active, according to its debounced state.
+ * 
+ * @param port The port of the input.
+ * @param bit The bit of the input within the port (0 to 7).
+ * @return `true` if the input is active, otherwise `false`.
+ */
+static inline bool input_isActive(Input_Port_t port, uint8_t bit) {
+	return (_input_states[port] >> bit) & 1;
+}
+
+/**
+ * @brief Removes the oldest event from the queue. This doesn't block.
+ * 
+ * @param event Target for the event.
+ * @return `true` if there was an event, otherwise `false`.
+ */
+bool input_getEvent(InputEvent_t* event);
+
+/**
+ * @brief Removes all events from the queue.
+ * 
+ */
+void input_clearEvents();
+
+/**
+ * @brief Gets the number of events which were dropped because the queue was full, and resets it.
+ * 
+ * @return The number of dropped events.
+ */
+uint8_t input_droppedEvents();
+#endif
+
+#endif /* INPUT_H_ */
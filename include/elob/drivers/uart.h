@@ -7,16 +7,292 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <elob/elob.h>
 #include "../../../../config.h"
 
 #ifndef UART_H_
 #define UART_H_
 
-// Check if UART_BUFFER_SIZE is defined
+#include <elob/util/buffer.h>
+
+// Enable all UART interfaces unless configured otherwise
+#ifndef UART0_ENABLED
+#define UART0_ENABLED 1
+#endif
+#ifndef UART1_ENABLED
+#define UART1_ENABLED 1
+#endif
+#ifndef UART2_ENABLED
+#define UART2_ENABLED 1
+#endif
+#ifndef UART3_ENABLED
+#define UART3_ENABLED 1
+#endif
+
+// Use the default buffer sizes for all interfaces which are not configured individually
 #ifndef UART_BUFFER_SIZE
-#error Please define UART_BUFFER_SIZE in your configuration.
+#define UART_BUFFER_SIZE 64
+#endif
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 64
+#endif
+
+#ifndef UART0_RX_BUFFER_SIZE
+#define UART0_RX_BUFFER_SIZE UART_BUFFER_SIZE
+#endif
+#ifndef UART0_TX_BUFFER_SIZE
+#define UART0_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART1_RX_BUFFER_SIZE
+#define UART1_RX_BUFFER_SIZE UART_BUFFER_SIZE
+#endif
+#ifndef UART1_TX_BUFFER_SIZE
+#define UART1_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART2_RX_BUFFER_SIZE
+#define UART2_RX_BUFFER_SIZE UART_BUFFER_SIZE
+#endif
+#ifndef UART2_TX_BUFFER_SIZE
+#define UART2_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART3_RX_BUFFER_SIZE
+#define UART3_RX_BUFFER_SIZE UART_BUFFER_SIZE
+#endif
+#ifndef UART3_TX_BUFFER_SIZE
+#define UART3_TX_BUFFER_SIZE UART_TX_BUFFER_SIZE
+#endif
+
+// The buffers are ring buffers which require a power-of-two size (or 0 to disable them)
+#if UART0_RX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART0_RX_BUFFER_SIZE)
+#error UART0_RX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART0_TX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART0_TX_BUFFER_SIZE)
+#error UART0_TX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART1_RX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART1_RX_BUFFER_SIZE)
+#error UART1_RX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART1_TX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART1_TX_BUFFER_SIZE)
+#error UART1_TX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART2_RX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART2_RX_BUFFER_SIZE)
+#error UART2_RX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART2_TX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART2_TX_BUFFER_SIZE)
+#error UART2_TX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART3_RX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART3_RX_BUFFER_SIZE)
+#error UART3_RX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+#if UART3_TX_BUFFER_SIZE != 0 && !BUFFER_SIZE_VALID(UART3_TX_BUFFER_SIZE)
+#error UART3_TX_BUFFER_SIZE has to be 0 or a power of two not larger than BUFFER_MAX_SIZE.
+#endif
+
+/**
+ * @brief Number of bytes of buffer memory used by the UART driver, i.e. the sum of the
+ * sizes of all buffers of the enabled interfaces. This can be used in `#if` directives.
+ * 
+ * Use @ref uart_sramUsage to get the total SRAM usage including the bookkeeping data.
+ */
+#define UART_BUFFER_SRAM_USAGE ( \
+	(UART0_ENABLED ? UART0_RX_BUFFER_SIZE + UART0_TX_BUFFER_SIZE : 0) + \
+	(UART1_ENABLED ? UART1_RX_BUFFER_SIZE + UART1_TX_BUFFER_SIZE : 0) + \
+	(UART2_ENABLED ? UART2_RX_BUFFER_SIZE + UART2_TX_BUFFER_SIZE : 0) + \
+	(UART3_ENABLED ? UART3_RX_BUFFER_SIZE + UART3_TX_BUFFER_SIZE : 0) \
+	)
+
+/**
+ * @brief RX overflow policy: bytes received while the receive buffer is full are discarded.
+ * 
+ */
+#define UART_OVERFLOW_DROP_NEWEST 0
+/**
+ * @brief RX overflow policy: the oldest byte in the receive buffer is discarded to make room
+ * for a byte received while the receive buffer is full.
+ * 
+ */
+#define UART_OVERFLOW_OVERWRITE_OLDEST 1
+/**
+ * @brief RX overflow policy: bytes received while the receive buffer is full are discarded and
+ * a flag is set, which can be checked with @ref uart_rxOverflowed.
+ * 
+ */
+#define UART_OVERFLOW_FLAG 2
+
+// Use the default RX overflow policy if none is configured
+#ifndef UART_RX_OVERFLOW_POLICY
+#define UART_RX_OVERFLOW_POLICY UART_OVERFLOW_FLAG
+#endif
+
+// Enable the UART statistics counters unless configured otherwise
+#ifndef UART_STATS_ENABLED
+#define UART_STATS_ENABLED 1
+#endif
+
+// Enable the delimiter detection unless configured otherwise
+#ifndef UART_LINE_DETECTION
+/**
+ * @brief Enables counting the delimiters in the receive buffers in the receive interrupt,
+ * see @ref uart_linesAvailable and @ref uart_readUntil.
+ * 
+ */
+#define UART_LINE_DETECTION 1
+#endif
+
+#ifndef UART_DEFAULT_DELIMITER
+/**
+ * @brief Delimiter counted on all interfaces until it is changed using @ref uart_setDelimiter.
+ * 
+ */
+#define UART_DEFAULT_DELIMITER '\n'
+#endif
+
+// Enable the master SPI mode unless configured otherwise
+#ifndef UART_SPI_ENABLED
+/**
+ * @brief Enables the master SPI (MSPIM) mode of the UART interfaces, see @ref uart_spiInit.
+ * 
+ */
+#define UART_SPI_ENABLED 1
 #endif
 
+#ifndef UART_SPI_FILL_BYTE
+/**
+ * @brief Byte sent by the SPI transfers if no transmit data is given.
+ * 
+ */
+#define UART_SPI_FILL_BYTE 0xFF
+#endif
+
+// Use the default baud rate tolerance if none is configured
+#ifndef UART_BAUD_TOLERANCE
+/**
+ * @brief Maximum accepted deviation of the actual baud rate from the requested baud rate
+ * for @ref UART_BAUD_SETTING, in permille.
+ * 
+ * The default of 2.5 % accepts 115200 baud at 16 MHz (2.1 % error), which works in practice.
+ */
+#define UART_BAUD_TOLERANCE 25
+#endif
+
+/**
+ * @brief Type holding a precomputed baud rate setting, i.e. the UBRR value in the lower
+ * 12 bits and the double speed (U2X) flag in the highest bit.
+ * 
+ * Use @ref UART_BAUD_SETTING to calculate it at compile time.
+ */
+typedef uint16_t UART_BaudSetting_t;
+
+/**
+ * @brief Flag in a @ref UART_BaudSetting_t indicating that double speed mode (U2X) is used.
+ * 
+ */
+#define UART_BAUD_SETTING_U2X 0x8000
+
+/**
+ * @brief Internal macro calculating the rounded baud rate divider, i.e. UBRR + 1, for the
+ * given baud rate and samples per bit (16 in normal mode, 8 in double speed mode).
+ * Evaluates to 1 for baud rates which are too high to be reached.
+ */
+#define _UART_DIVIDER(baudrate, samples) \
+	(((F_CPU + (samples) * (unsigned long)(baudrate) / 2) / ((samples) * (unsigned long)(baudrate))) ? \
+	((F_CPU + (samples) * (unsigned long)(baudrate) / 2) / ((samples) * (unsigned long)(baudrate))) : 1)
+
+/**
+ * @brief Internal macro calculating the actual baud rate for the given samples per bit.
+ */
+#define _UART_ACTUAL_BAUDRATE(baudrate, samples) (F_CPU / ((samples) * _UART_DIVIDER(baudrate, samples)))
+
+/**
+ * @brief Internal macro calculating the baud rate error in permille for the given samples per bit.
+ */
+#define _UART_BAUDRATE_ERROR(baudrate, samples) \
+	((_UART_ACTUAL_BAUDRATE(baudrate, samples) > (unsigned long)(baudrate) ? \
+		_UART_ACTUAL_BAUDRATE(baudrate, samples) - (unsigned long)(baudrate) : \
+		(unsigned long)(baudrate) - _UART_ACTUAL_BAUDRATE(baudrate, samples) \
+	) * 1000UL / (unsigned long)(baudrate))
+
+/**
+ * @brief Internal macro deciding whether double speed mode results in a smaller baud rate error.
+ */
+#define _UART_USE_U2X(baudrate) \
+	(_UART_BAUDRATE_ERROR(baudrate, 8) < _UART_BAUDRATE_ERROR(baudrate, 16) && _UART_DIVIDER(baudrate, 8) <= 4096)
+
+/**
+ * @brief Checks if the given baud rate can be configured, i.e. if the UBRR value fits into 12 bits.
+ */
+#define UART_BAUDRATE_REACHABLE(baudrate) (_UART_DIVIDER(baudrate, 16) <= 4096)
+
+/**
+ * @brief Gets the error of the baud rate which is actually configured for the given
+ * baud rate, in permille.
+ */
+#define UART_BAUDRATE_ERROR(baudrate) \
+	(_UART_USE_U2X(baudrate) ? _UART_BAUDRATE_ERROR(baudrate, 8) : _UART_BAUDRATE_ERROR(baudrate, 16))
+
+/**
+ * @brief Calculates the @ref UART_BaudSetting_t for the given baud rate without any checks.
+ * This works at runtime as well, but prefer @ref UART_BAUD_SETTING for constant baud rates.
+ */
+#define UART_BAUD_SETTING_UNCHECKED(baudrate) ((UART_BaudSetting_t)( \
+	_UART_USE_U2X(baudrate) ? \
+		(UART_BAUD_SETTING_U2X | (_UART_DIVIDER(baudrate, 8) - 1)) : \
+		(_UART_DIVIDER(baudrate, 16) - 1) \
+	))
+
+/**
+ * @brief Calculates the @ref UART_BaudSetting_t for the given constant baud rate at compile time.
+ * 
+ * Compilation fails (with a negative array size error) if the baud rate can't be reached or
+ * if the baud rate error exceeds @ref UART_BAUD_TOLERANCE.
+ * 
+ * @code{.c}
+ * uart_initWithBaudSetting(UART0, UART_BAUD_SETTING(115200), UART_PARITY_DISABLED, UART_STOP_1BIT, UART_CLOCK_POLARITY_SAMPLE_ON_FALLING);
+ * @endcode
+ */
+#define UART_BAUD_SETTING(baudrate) ((UART_BaudSetting_t)(UART_BAUD_SETTING_UNCHECKED(baudrate) + 0 * sizeof(char[ \
+	(UART_BAUDRATE_REACHABLE(baudrate) && UART_BAUDRATE_ERROR(baudrate) <= UART_BAUD_TOLERANCE) ? 1 : -1 \
+	])))
+
+/**
+ * @brief Internal macro calculating the baud rate divider of the master SPI mode, i.e. UBRR + 1,
+ * rounded up so the resulting bitrate never exceeds the requested one. Evaluates to 1 (`F_CPU / 2`)
+ * for bitrates which are too high to be reached.
+ */
+#define _UART_SPI_DIVIDER(bitrate) \
+	(((F_CPU + 2UL * (bitrate) - 1) / (2UL * (bitrate))) ? ((F_CPU + 2UL * (bitrate) - 1) / (2UL * (bitrate))) : 1)
+
+/**
+ * @brief Checks if the given bitrate can be configured in master SPI mode, i.e. if the UBRR value fits into 12 bits.
+ */
+#define UART_SPI_BITRATE_REACHABLE(bitrate) (_UART_SPI_DIVIDER(bitrate) <= 4096)
+
+/**
+ * @brief Calculates the @ref UART_BaudSetting_t of the master SPI mode for the given bitrate without any checks.
+ * The bitrate is `F_CPU / (2 * (UBRR + 1))`, so at most `F_CPU / 2`, and there is no double speed mode.
+ * This works at runtime as well, but prefer @ref UART_SPI_BAUD_SETTING for constant bitrates.
+ */
+#define UART_SPI_BAUD_SETTING_UNCHECKED(bitrate) ((UART_BaudSetting_t)(_UART_SPI_DIVIDER(bitrate) - 1))
+
+/**
+ * @brief Calculates the @ref UART_BaudSetting_t of the master SPI mode for the given constant bitrate at compile time.
+ * 
+ * Compilation fails (with a negative array size error) if the bitrate can't be reached.
+ * 
+ * @code{.c}
+ * uart_spiInitWithBaudSetting(UART2, UART_SPI_BAUD_SETTING(4000000), UART_SPI_MODE_0, UART_SPI_MSB_FIRST);
+ * @endcode
+ */
+#define UART_SPI_BAUD_SETTING(bitrate) ((UART_BaudSetting_t)(UART_SPI_BAUD_SETTING_UNCHECKED(bitrate) + 0 * sizeof(char[ \
+	UART_SPI_BITRATE_REACHABLE(bitrate) ? 1 : -1 \
+	])))
+
+/**
+ * @brief Timeout value for @ref uart_read which makes it wait until all requested bytes are received.
+ * 
+ */
+#define UART_TIMEOUT_INFINITE UINT16_MAX
+
 /**
  * @brief Enumeration defining the parity modes of the UART interface.
  * 
@@ -73,6 +349,85 @@ typedef enum {
 	UART_CLOCK_POLARITY_SAMPLE_ON_RISING = 1
 } UART_ClockPolarityMode_t;
 
+/**
+ * @brief Enumerator defining the SPI modes of the master SPI mode, i.e. the clock polarity (CPOL,
+ * upper bit) and the clock phase (CPHA, lower bit).
+ * 
+ */
+typedef enum {
+	/**
+	 * @brief The clock idles low, data is sampled on the rising edge.
+	 * 
+	 */
+	UART_SPI_MODE_0 = 0,
+	/**
+	 * @brief The clock idles low, data is sampled on the falling edge.
+	 * 
+	 */
+	UART_SPI_MODE_1 = 1,
+	/**
+	 * @brief The clock idles high, data is sampled on the falling edge.
+	 * 
+	 */
+	UART_SPI_MODE_2 = 2,
+	/**
+	 * @brief The clock idles high, data is sampled on the rising edge.
+	 * 
+	 */
+	UART_SPI_MODE_3 = 3
+} UART_SpiMode_t;
+
+/**
+ * @brief Enumerator defining the bit orders of the master SPI mode.
+ * 
+ */
+typedef enum {
+	/**
+	 * @brief The most significant bit is sent first.
+	 * 
+	 */
+	UART_SPI_MSB_FIRST = 0,
+	/**
+	 * @brief The least significant bit is sent first.
+	 * 
+	 */
+	UART_SPI_LSB_FIRST = 1
+} UART_SpiDataOrder_t;
+
+/**
+ * @brief Struct containing the statistics counters of a UART interface.
+ * 
+ * The counters are updated by the receive interrupt service routine if `UART_STATS_ENABLED`
+ * is set. Use @ref uart_getStats to read them.
+ */
+typedef struct {
+	/**
+	 * @brief Number of bytes received by the hardware, including dropped bytes.
+	 */
+	uint32_t receivedBytes;
+	/**
+	 * @brief Number of received bytes which were lost because the receive buffer was full.
+	 */
+	uint16_t droppedBytes;
+	/**
+	 * @brief Number of bytes received with a framing error (FE flag).
+	 */
+	uint16_t framingErrors;
+	/**
+	 * @brief Number of bytes received with a parity error (UPE flag).
+	 */
+	uint16_t parityErrors;
+	/**
+	 * @brief Number of hardware data overruns (DOR flag), i.e. bytes lost before the receive
+	 * interrupt service routine could read them.
+	 */
+	uint16_t dataOverruns;
+	/**
+	 * @brief Maximum number of bytes which were in the receive buffer at the same time.
+	 */
+	uint8_t highWaterMark;
+} UART_Stats_t;
+
 /**
  * @brief Enumerator defining the available UART interfaces.
  * 
@@ -100,26 +455,50 @@ typedef enum {
 	UART3 = 3
 } UART_Interface_t;
 
+#if UART0_ENABLED
 /**
- * @brief Read-and-write-capable `FILE*` stream for the UART0 interface.
+ * @brief Read-and-write-capable `FILE*` stream for the UART0 interface. The stream is statically allocated,
+ * so it can be used without any heap allocation, even before @ref uart_init.
+ * 
+ * The first interface initialized by @ref uart_init becomes `stdin`, `stdout` and `stderr`, as with `fdevopen`.
+ * @ref usb_terminal_init replaces them with the USB terminal streams.
  * 
  */
-FILE* UART0_f;
+extern FILE* UART0_f;
+#endif
+#if UART1_ENABLED
 /**
- * @brief Read-and-write-capable `FILE*` stream for the UART1 interface.
+ * @brief Read-and-write-capable `FILE*` stream for the UART1 interface. The stream is statically allocated,
+ * so it can be used without any heap allocation, even before @ref uart_init.
+ * 
+ * The first interface initialized by @ref uart_init becomes `stdin`, `stdout` and `stderr`, as with `fdevopen`.
+ * @ref usb_terminal_init replaces them with the USB terminal streams.
  * 
  */
-FILE* UART1_f;
+extern FILE* UART1_f;
+#endif
+#if UART2_ENABLED
 /**
- * @brief Read-and-write-capable `FILE*` stream for the UART2 interface.
+ * @brief Read-and-write-capable `FILE*` stream for the UART2 interface. The stream is statically allocated,
+ * so it can be used without any heap allocation, even before @ref uart_init.
+ * 
+ * The first interface initialized by @ref uart_init becomes `stdin`, `stdout` and `stderr`, as with `fdevopen`.
+ * @ref usb_terminal_init replaces them with the USB terminal streams.
  * 
  */
-FILE* UART2_f;
+extern FILE* UART2_f;
+#endif
+#if UART3_ENABLED
 /**
- * @brief Read-and-write-capable `FILE*` stream for the UART3 interface.
+ * @brief Read-and-write-capable `FILE*` stream for the UART3 interface. The stream is statically allocated,
+ * so it can be used without any heap allocation, even before @ref uart_init.
+ * 
+ * The first interface initialized by @ref uart_init becomes `stdin`, `stdout` and `stderr`, as with `fdevopen`.
+ * @ref usb_terminal_init replaces them with the USB terminal streams.
  * 
  */
-FILE* UART3_f;
+extern FILE* UART3_f;
+#endif
 
 /**
  * @brief Initializes the given UART interface with the given parameters.
@@ -129,6 +508,9 @@ FILE* UART3_f;
  * @param parityMode The parity mode to configure.
  * @param stopbitMode The stop bit mode to configure.
  * @param clockPolarityMode The clock polarity mode to configure.
+ * 
+ * @exception ERR_BITRATE_TOO_LOW Raised when the passed baud rate is too low to be configured.
+ * @exception ERR_INVALID_INTERFACE Raised when the interface is disabled in the configuration.
  */
 void uart_init(
 	UART_Interface_t uartInterface,
@@ -137,13 +519,39 @@ void uart_init(
 	UART_StopBitMode_t stopbitMode,
 	UART_ClockPolarityMode_t clockPolarityMode
 );
+/**
+ * @brief Initializes the given UART interface with a precomputed baud rate setting.
+ * This avoids any baud rate calculations at runtime.
+ * 
+ * @param uartInterface The @ref UART_Interface_t to initialize.
+ * @param baudSetting The baud rate setting to configure, see @ref UART_BAUD_SETTING.
+ * @param parityMode The parity mode to configure.
+ * @param stopbitMode The stop bit mode to configure.
+ * @param clockPolarityMode The clock polarity mode to configure.
+ */
+void uart_initWithBaudSetting(
+	UART_Interface_t uartInterface,
+	UART_BaudSetting_t baudSetting,
+	UART_ParityMode_t parityMode,
+	UART_StopBitMode_t stopbitMode,
+	UART_ClockPolarityMode_t clockPolarityMode
+);
 /**
  * @brief Configures the baud rate of the given UART interface.
  * 
  * @param uartInterface The @ref UART_Interface_t to set the baud rate of.
  * @param baudrate The baud rate to configure.
+ * 
+ * @exception ERR_BITRATE_TOO_LOW Raised when the passed baud rate is too low to be configured.
  */
 void uart_setBaudrate(UART_Interface_t uartInterface, unsigned long baudrate);
+/**
+ * @brief Configures a precomputed baud rate setting on the given UART interface.
+ * 
+ * @param uartInterface The @ref UART_Interface_t to set the baud rate of.
+ * @param baudSetting The baud rate setting to configure, see @ref UART_BAUD_SETTING.
+ */
+void uart_setBaudSetting(UART_Interface_t uartInterface, UART_BaudSetting_t baudSetting);
 
 /**
  * @brief Checks if there is any data available on the given UART interface.
@@ -157,10 +565,31 @@ bool uart_available(UART_Interface_t uartInterface);
 /**
  * @brief Sends a single byte to the given UART interface.
  * 
+ * The byte is queued in the transmit buffer and sent in the background by the UDRE
+ * interrupt. This only blocks if the transmit buffer is full. If interrupts are disabled
+ * globally (e.g. when called from an interrupt service routine), the byte is sent synchronously.
+ * 
  * @param uartInterface The UART interface to send the data to.
  * @param data The data byte to send to the interface.
  */
 void uart_sendByte(UART_Interface_t uartInterface, uint8_t data);
+
+/**
+ * @brief Gets the number of bytes which can be queued in the transmit buffer of the
+ * given UART interface without blocking.
+ * 
+ * @param uartInterface The UART interface to check.
+ * @return The number of free bytes in the transmit buffer.
+ */
+uint8_t uart_txBytesFree(UART_Interface_t uartInterface);
+
+/**
+ * @brief Blocks until all queued data has been sent on the given UART interface,
+ * including the last byte in the transmit shift register.
+ * 
+ * @param uartInterface The UART interface to flush.
+ */
+void uart_flush(UART_Interface_t uartInterface);
 /**
  * @brief Reads a single byte from the given UART interface. If no data
  * is available from the buffer, this blocks until something is received.
@@ -170,6 +599,233 @@ void uart_sendByte(UART_Interface_t uartInterface, uint8_t data);
  */
 uint8_t uart_readByte(UART_Interface_t uartInterface);
 
+/**
+ * @brief Sends a block of data to the given UART interface.
+ * 
+ * The data is copied into the transmit buffer in contiguous chunks and sent in the background.
+ * This only blocks while the transmit buffer is full.
+ * 
+ * @param uartInterface The UART interface to send the data to.
+ * @param data The data to send to the interface.
+ * @param length The number of bytes in @p data.
+ */
+void uart_write(UART_Interface_t uartInterface, const uint8_t* data, size_t length);
+
+/**
+ * @brief Reads a block of data from the given UART interface.
+ * 
+ * This copies the received data out of the receive buffer in contiguous chunks and
+ * waits for more data until either @p length bytes have been read or the timeout expired.
+ * 
+ * @param uartInterface The UART interface to read the data from.
+ * @param dst The array the received data is copied to.
+ * @param length The number of bytes to read.
+ * @param timeout The approximate maximum time to wait in milliseconds. Pass `0` to only read
+ * the data which is already available, or @ref UART_TIMEOUT_INFINITE to wait without a timeout.
+ * @return The number of bytes copied to @p dst.
+ */
+size_t uart_read(UART_Interface_t uartInterface, uint8_t* dst, size_t length, uint16_t timeout);
+
+#if UART_LINE_DETECTION
+/**
+ * @brief Sets the delimiter counted by the receive interrupt of the given UART interface, e.g. `'\n'` for
+ * text lines or `0` for COBS frames. The default is @ref UART_DEFAULT_DELIMITER.
+ * 
+ * This recounts the delimiters already in the receive buffer.
+ * 
+ * @param uartInterface The UART interface to configure.
+ * @param delimiter The delimiter to count.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface or its receiver is disabled in the configuration.
+ */
+void uart_setDelimiter(UART_Interface_t uartInterface, uint8_t delimiter);
+
+/**
+ * @brief Gets the number of complete lines (or frames) in the receive buffer of the given UART
+ * interface, i.e. the number of delimiters set using @ref uart_setDelimiter. This doesn't scan
+ * the buffer, the delimiters are counted by the receive interrupt.
+ * 
+ * @param uartInterface The UART interface to check.
+ * @return The number of complete lines.
+ */
+uint8_t uart_linesAvailable(UART_Interface_t uartInterface);
+
+/**
+ * @brief Reads a line (or frame) terminated by @p delimiter from the given UART interface.
+ * 
+ * If the receive buffer contains the delimiter within the first @p max bytes, everything up to
+ * and including the delimiter is copied to @p dst in contiguous chunks. If the line doesn't fit
+ * into @p max bytes or the receive buffer is full, the first @p max bytes are copied, so the caller
+ * can handle overlong lines. Otherwise, nothing is copied. This never blocks.
+ * 
+ * @param uartInterface The UART interface to read from.
+ * @param delimiter The byte terminating the line, usually the one set using @ref uart_setDelimiter.
+ * @param dst The array the line is copied to. It isn't null-terminated.
+ * @param max The maximum number of bytes to copy, including the delimiter.
+ * @return The number of bytes copied to @p dst, 0 if there is no complete line. The line is complete
+ * if the last copied byte is the delimiter.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface or its receiver is disabled in the configuration.
+ */
+size_t uart_readUntil(UART_Interface_t uartInterface, uint8_t delimiter, uint8_t* dst, size_t max);
+#endif
+
+/**
+ * @brief Reserves space for a block which is built in place in the transmit buffer of the given
+ * UART interface, e.g. by an encoder which has to fill in bytes after the data they depend on.
+ * 
+ * This blocks until at least @p n bytes are free. The block is then written using @ref buffer_poke
+ * on the returned buffer and sent using @ref uart_txCommit. Nothing else may be written to the interface
+ * in between.
+ * 
+ * @param uartInterface The UART interface to send the block to.
+ * @param n The maximum size of the block.
+ * @return The transmit buffer of the interface.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is disabled or has no transmit buffer.
+ * @exception ERR_BUFFER_OVERFLOW @p n is larger than the transmit buffer.
+ */
+Buffer_t* uart_txReserve(UART_Interface_t uartInterface, uint8_t n);
+
+/**
+ * @brief Sends the first @p n bytes of a block reserved using @ref uart_txReserve. If interrupts are
+ * disabled globally, the block is sent synchronously.
+ * 
+ * @param uartInterface The UART interface the block was reserved on.
+ * @param n The size of the block, at most the reserved size.
+ */
+void uart_txCommit(UART_Interface_t uartInterface, uint8_t n);
+
+#if UART_SPI_ENABLED
+/**
+ * @brief Switches the given UART interface to the master SPI mode (MSPIM), with TXDn as MOSI, RXDn as
+ * MISO and XCKn as SCK. The slave select line has to be driven by the application using a GPIO.
+ * 
+ * The interface can only be used with the `uart_spi*` functions until it is switched back to the
+ * UART mode using @ref uart_init.
+ * 
+ * @param uartInterface The UART interface to configure.
+ * @param bitrate The bitrate, at most `F_CPU / 2`. The configured bitrate never exceeds it.
+ * @param mode The SPI mode (clock polarity and phase).
+ * @param dataOrder The bit order.
+ * 
+ * @exception ERR_BITRATE_TOO_LOW The bitrate is too low to be configured.
+ * @exception ERR_INVALID_INTERFACE The interface is disabled in the configuration.
+ */
+void uart_spiInit(UART_Interface_t uartInterface, unsigned long bitrate, UART_SpiMode_t mode, UART_SpiDataOrder_t dataOrder);
+
+/**
+ * @brief Switches the given UART interface to the master SPI mode with a precomputed bitrate setting,
+ * see @ref uart_spiInit.
+ * 
+ * @param uartInterface The UART interface to configure.
+ * @param baudSetting The bitrate setting, see @ref UART_SPI_BAUD_SETTING.
+ * @param mode The SPI mode (clock polarity and phase).
+ * @param dataOrder The bit order.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is disabled in the configuration.
+ */
+void uart_spiInitWithBaudSetting(UART_Interface_t uartInterface, UART_BaudSetting_t baudSetting, UART_SpiMode_t mode, UART_SpiDataOrder_t dataOrder);
+
+/**
+ * @brief Exchanges a block of bytes with the slave and blocks until the transfer is complete.
+ * 
+ * Both directions are transferred at the same time. The double-buffered data register keeps the next
+ * byte queued while the current one is shifted, so there are no gaps between the bytes.
+ * 
+ * @param uartInterface The UART interface in master SPI mode.
+ * @param tx The bytes to send, `NULL` to send @ref UART_SPI_FILL_BYTE.
+ * @param rx The buffer the received bytes are stored to, `NULL` to discard them. May be equal to @p tx.
+ * @param n The number of bytes to exchange.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is disabled or not in master SPI mode.
+ */
+void uart_spiTransfer(UART_Interface_t uartInterface, const uint8_t* tx, uint8_t* rx, size_t n);
+
+/**
+ * @brief Exchanges a single byte with the slave and blocks until the transfer is complete.
+ * 
+ * @param uartInterface The UART interface in master SPI mode.
+ * @param data The byte to send.
+ * @return The received byte.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is disabled or not in master SPI mode.
+ */
+uint8_t uart_spiTransferByte(UART_Interface_t uartInterface, uint8_t data);
+
+/**
+ * @brief Starts exchanging a block of bytes with the slave in the background, driven by the receive
+ * complete interrupt. A transfer which is still running on the interface is waited for first.
+ * 
+ * The buffers have to stay valid until @ref uart_spiBusy returns `false`. When the transfer is complete,
+ * the @ref SCHEDULER_EVENT_UART_TX event of the interface is signaled. Every byte costs an interrupt,
+ * so this reaches lower bitrates than @ref uart_spiTransfer, but frees the CPU during slow transfers.
+ * If interrupts are disabled globally, the block is transferred synchronously.
+ * 
+ * @param uartInterface The UART interface in master SPI mode.
+ * @param tx The bytes to send, `NULL` to send @ref UART_SPI_FILL_BYTE.
+ * @param rx The buffer the received bytes are stored to, `NULL` to discard them. May be equal to @p tx.
+ * @param n The number of bytes to exchange.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is disabled or not in master SPI mode.
+ */
+void uart_spiTransferAsync(UART_Interface_t uartInterface, const uint8_t* tx, uint8_t* rx, size_t n);
+
+/**
+ * @brief Checks if a background transfer started using @ref uart_spiTransferAsync is still running.
+ * 
+ * @param uartInterface The UART interface in master SPI mode.
+ * @return `true` if the transfer is running, otherwise `false`.
+ */
+bool uart_spiBusy(UART_Interface_t uartInterface);
+
+/**
+ * @brief Blocks until a background transfer started using @ref uart_spiTransferAsync is complete.
+ * 
+ * @param uartInterface The UART interface in master SPI mode.
+ */
+void uart_spiWait(UART_Interface_t uartInterface);
+#endif
+
+/**
+ * @brief Gets a consistent snapshot of the statistics counters of the given UART interface.
+ * 
+ * If `UART_STATS_ENABLED` is not set, all counters are zero.
+ * 
+ * @param uartInterface The UART interface to get the statistics of.
+ * @param stats Pointer to the @ref UART_Stats_t struct the statistics are copied to.
+ */
+void uart_getStats(UART_Interface_t uartInterface, UART_Stats_t* stats);
+
+/**
+ * @brief Resets all statistics counters of the given UART interface to zero.
+ * 
+ * @param uartInterface The UART interface to reset the statistics of.
+ */
+void uart_resetStats(UART_Interface_t uartInterface);
+
+/**
+ * @brief Checks if received data was discarded because the receive buffer was full
+ * since the last call of this function, and clears the flag.
+ * 
+ * The flag is only set with the @ref UART_OVERFLOW_FLAG policy.
+ * 
+ * @param uartInterface The UART interface to check.
+ * @return `true` if received data was discarded, otherwise `false`.
+ */
+bool uart_rxOverflowed(UART_Interface_t uartInterface);
+
+/**
+ * @brief Gets the total number of bytes of SRAM statically allocated by the UART driver,
+ * including the buffers, the buffer bookkeeping and the interface descriptions.
+ * 
+ * This is a compile-time constant and can be used to check how much memory is left for
+ * the application after reducing the buffer sizes with `UARTn_RX_BUFFER_SIZE` and `UARTn_TX_BUFFER_SIZE`.
+ * 
+ * @return The number of bytes of SRAM used by the UART driver.
+ */
+size_t uart_sramUsage(void);
+
 /**
  * @brief Sends a string of characters to the specified UART interface.
  * 
@@ -178,4 +834,46 @@ uint8_t uart_readByte(UART_Interface_t uartInterface);
  */
 void uart_sendString(UART_Interface_t uartInterface, uint8_t* s);
 
+/**
+ * @brief Declares the interface-specific variants of the UART functions for the interface
+ * with the number @p n, e.g. `uart1_sendByte(data)` for `uart_sendByte(UART1, data)`.
+ * 
+ * These behave exactly like their generic counterparts, but access the registers and buffers
+ * of the interface directly instead of selecting them at runtime. Prefer them in hot paths.
+ */
+#define _UART_DECLARE_INTERFACE(n) \
+	bool uart##n##_available(void); \
+	void uart##n##_sendByte(uint8_t data); \
+	void uart##n##_write(const uint8_t* data, size_t length); \
+	uint8_t uart##n##_txBytesFree(void); \
+	void uart##n##_flush(void); \
+	uint8_t uart##n##_readByte(void); \
+	size_t uart##n##_read(uint8_t* dst, size_t length, uint16_t timeout); \
+	_UART_DECLARE_LINE_FUNCTIONS(n)
+
+#if UART_LINE_DETECTION
+/**
+ * @brief Declares the interface-specific variants of the line functions for the interface with the number @p n.
+ * 
+ */
+#define _UART_DECLARE_LINE_FUNCTIONS(n) \
+	uint8_t uart##n##_linesAvailable(void); \
+	size_t uart##n##_readUntil(uint8_t delimiter, uint8_t* dst, size_t max);
+#else
+#define _UART_DECLARE_LINE_FUNCTIONS(n)
+#endif
+
+#if UART0_ENABLED
+_UART_DECLARE_INTERFACE(0)
+#endif
+#if UART1_ENABLED
+_UART_DECLARE_INTERFACE(1)
+#endif
+#if UART2_ENABLED
+_UART_DECLARE_INTERFACE(2)
+#endif
+#if UART3_ENABLED
+_UART_DECLARE_INTERFACE(3)
+#endif
+
 #endif /* UART_H_ */
\ No newline at end of file
@@ -2,6 +2,12 @@
  * @file buffer.h
  * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
  * @brief Simple FIFO buffer library implementing a 1-byte FIFO buffer.
+ * 
+ * The buffer is implemented as a ring buffer with free-running 8-bit head and tail
+ * indices. As long as only one context writes to the buffer (e.g. an interrupt service
+ * routine) and only one context reads from it (e.g. the main loop), no interrupt
+ * protection is required: @ref buffer_put only ever modifies `head` and
+ * @ref buffer_get only ever modifies `tail`.
  */
 #include <stdint.h>
 #include <stdbool.h>
@@ -10,6 +16,26 @@
 #ifndef BUFFER_H_
 #define BUFFER_H_
 
+/**
+ * @brief Maximum number of elements a buffer can hold. The buffer size has to be a
+ * power of two which is not larger than this value.
+ */
+#define BUFFER_MAX_SIZE 128
+
+/**
+ * @brief Checks at compile time if @p size is a valid buffer size, i.e. a power of two
+ * between 1 and @ref BUFFER_MAX_SIZE. This can also be used in `#if` directives.
+ */
+#define BUFFER_SIZE_VALID(size) ((size) > 0 && (size) <= BUFFER_MAX_SIZE && ((size) & ((size) - 1)) == 0)
+
+/**
+ * @brief Static initializer for a @ref Buffer_t.
+ * 
+ * @param storage The array used as the internal buffer memory.
+ * @param size The number of elements in @p storage. Has to be a power of two, see @ref BUFFER_SIZE_VALID.
+ */
+#define BUFFER_INITIALIZER(storage, size) { .type = BUFFER_TYPE_FIFO, .head = 0, .tail = 0, .mask = (size) - 1, .ptr = (storage) }
+
 /**
  * @brief Enumerator defining the available buffer types.
  */
@@ -33,15 +59,20 @@ typedef struct {
 	 */
 	BufferType_t type;
 	/**
-	 * @brief Current number of elements in the buffer.
+	 * @brief Free-running write index. Only modified by the producer.
+	 * 
+	 */
+	volatile uint8_t head;
+	/**
+	 * @brief Free-running read index. Only modified by the consumer.
 	 * 
 	 */
-	size_t size;
+	volatile uint8_t tail;
 	/**
-	 * @brief Maximum number of elements in the buffer.
+	 * @brief Index mask, i.e. the maximum number of elements in the buffer minus one.
 	 * 
 	 */
-	size_t maxSize;
+	uint8_t mask;
 	/**
 	 * @brief Pointer to the buffer's internal array.
 	 * 
@@ -49,14 +80,49 @@ typedef struct {
 	uint8_t* ptr;
 } Buffer_t;
 
+/**
+ * @brief Initializes a buffer at runtime. Use @ref BUFFER_INITIALIZER for statically allocated buffers.
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to initialize.
+ * @param storage The array used as the internal buffer memory.
+ * @param size The number of elements in @p storage. Has to be a power of two, see @ref BUFFER_SIZE_VALID.
+ */
+void buffer_init(Buffer_t* buffer, uint8_t* storage, uint8_t size);
+
 /**
  * @brief Inserts a new element at the end of the buffer.
  * 
  * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
  * @param data The data byte you want to append to the buffer.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW The buffer is already full.
  */
 void buffer_put(Buffer_t* buffer, uint8_t data);
 
+/**
+ * @brief Tries to insert a new element at the end of the buffer. Unlike @ref buffer_put,
+ * this never throws and can therefore be used from interrupt service routines.
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
+ * @param data The data byte you want to append to the buffer.
+ * @return Returns `true` if the element was inserted, `false` if the buffer is full.
+ */
+bool buffer_tryPut(Buffer_t* buffer, uint8_t data);
+
+/**
+ * @brief Inserts a new element at the end of the buffer. If the buffer is full, the
+ * oldest element is discarded to make room for the new one.
+ * 
+ * This modifies the read index when the buffer is full, so the producer and the consumer
+ * are no longer strictly separated: if the consumer reads concurrently while an element is
+ * discarded, it may receive the new element instead of the discarded one.
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
+ * @param data The data byte you want to append to the buffer.
+ * @return Returns `true` if the element was inserted without discarding, `false` if the oldest element was discarded.
+ */
+bool buffer_putOverwrite(Buffer_t* buffer, uint8_t data);
+
 /**
  * @brief Asserts if the buffer is empty.
  * 
@@ -73,19 +139,104 @@ bool buffer_empty(Buffer_t* buffer);
  */
 bool buffer_full(Buffer_t* buffer);
 
+/**
+ * @brief Gets the number of elements currently stored in the buffer.
+ * 
+ * @param buffer A pointer to the buffer you want to read from.
+ * @return The number of elements in the buffer.
+ */
+uint8_t buffer_count(Buffer_t* buffer);
+
+/**
+ * @brief Gets the number of elements which can still be inserted into the buffer.
+ * 
+ * @param buffer A pointer to the buffer you want to read from.
+ * @return The number of free elements in the buffer.
+ */
+uint8_t buffer_space(Buffer_t* buffer);
+
+/**
+ * @brief Stores an element behind the end of the buffer without inserting it yet.
+ * 
+ * Together with @ref buffer_commit, this allows the producer to build a block in place, e.g. to
+ * fill in a header byte after the data it describes. The consumer doesn't see the elements until
+ * they are committed. The caller has to make sure that at least `offset + 1` elements are free
+ * (see @ref buffer_space).
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
+ * @param offset The position behind the current end of the buffer, 0 is the next element to be inserted.
+ * @param data The data byte to store.
+ */
+void buffer_poke(Buffer_t* buffer, uint8_t offset, uint8_t data);
+
+/**
+ * @brief Inserts the first @p n elements stored using @ref buffer_poke at the end of the buffer.
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
+ * @param n The number of elements to insert. Has to be at most the number of free elements.
+ */
+void buffer_commit(Buffer_t* buffer, uint8_t n);
+
 /**
  * @brief Gets a single element from the buffer. This also removes the element from the buffer.
  * 
  * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
  * @return The element which was read from the buffer.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW The buffer is empty.
  */
 uint8_t buffer_get(Buffer_t* buffer);
 
+/**
+ * @brief Appends up to @p n bytes from @p src to the end of the buffer.
+ * 
+ * The data is copied in at most two contiguous chunks. Unlike @ref buffer_put, this does
+ * not throw if the buffer is full, but only copies as many bytes as fit into the buffer.
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
+ * @param src The data you want to append to the buffer.
+ * @param n The number of bytes in @p src.
+ * @return The number of bytes which were actually appended to the buffer.
+ */
+size_t buffer_write(Buffer_t* buffer, const uint8_t* src, size_t n);
+
+/**
+ * @brief Gets up to @p n bytes from the buffer and removes them from the buffer.
+ * 
+ * The data is copied in at most two contiguous chunks. Unlike @ref buffer_get, this does
+ * not throw if the buffer is empty, but only copies as many bytes as are available.
+ * 
+ * @param buffer A pointer to the @ref Buffer_t struct you want to modify.
+ * @param dst The array the data is copied to.
+ * @param n The maximum number of bytes to copy to @p dst.
+ * @return The number of bytes which were actually copied to @p dst.
+ */
+size_t buffer_read(Buffer_t* buffer, uint8_t* dst, size_t n);
+
+/**
+ * @brief Searches the buffer for an element without removing anything.
+ * 
+ * The search is done using `memchr` in at most two contiguous chunks. This only reads the
+ * elements, but relies on them not being removed concurrently, so only call this from the
+ * consumer side.
+ * 
+ * @param buffer A pointer to the buffer you want to search.
+ * @param value The element to search for.
+ * @param offset The number of elements to skip, starting at the oldest one.
+ * @param n The number of elements to search after the skipped ones. Has to be at most the
+ * number of elements in the buffer minus @p offset.
+ * @return The number of elements up to and including the first match counted from the oldest
+ * element, or 0 if @p value wasn't found.
+ */
+size_t buffer_find(Buffer_t* buffer, uint8_t value, uint8_t offset, size_t n);
+
 /**
  * @brief Empties the buffer and removes all elements.
  * 
+ * This modifies the read index, so only call this from the consumer side.
+ * 
  * @param buffer A pointer to the @ref Buffer_t struct you want to empty.
  */
 void buffer_clear(Buffer_t* buffer);
 
-#endif /* BUFFER_H_ */
\ No newline at end of file
+#endif /* BUFFER_H_ */
@@ -7,6 +7,29 @@
 #define ERROR_H_
 
 #include <setjmp.h>
+#include <avr/pgmspace.h>
+#include "../../../../config.h"
+
+#ifndef ERROR_FUNCTION_NAMES
+/**
+ * @brief Enables storing the function name in @ref Error_t. Function names can't be placed in flash
+ * (`__FUNCTION__` is not a string literal), so they cost SRAM and are disabled by default.
+ * 
+ */
+#define ERROR_FUNCTION_NAMES 0
+#endif
+
+#ifndef ERROR_RETURN_CODES
+/**
+ * @brief If set to 1, the internal functions of the library report errors by returning an @ref ErrorCode_t
+ * (see @ref ELOB_STATUS) instead of throwing. The public functions still throw at the boundary to the
+ * application, so `try`/`catch` keeps working, but an internal call only costs a branch on the success path.
+ * 
+ * The error thrown at the boundary keeps the error code and message, but reports the file and line of
+ * the public function it was thrown from.
+ */
+#define ERROR_RETURN_CODES 0
+#endif
 
 /**
  * @brief List of possible errors in the library.
@@ -56,18 +79,41 @@ typedef enum {
 	 * @brief Occurs when the specified prefix can't possibly represent
 	 * the number withuot violating the precision.
 	 */
-	ERR_PRECISION_VIOLATED
+	ERR_PRECISION_VIOLATED,
+	/**
+	 * @brief Occurs when a hardware interface is used which is disabled in the configuration.
+	 */
+	ERR_INVALID_INTERFACE,
+	/**
+	 * @brief Occurs when an I2C transmission does not complete within its timeout, e.g. because the bus is stuck.
+	 */
+	ERR_I2C_TIMEOUT
 } ErrorCode_t;
 
 /**
  * @brief Struct containing all error information.
  * 
+ * The strings @ref name, @ref message and @ref file are stored in flash (program memory),
+ * read them using the `_P` functions of avr-libc (e.g. `printf_P("%S", error.name)`).
  */
 typedef struct {
 	unsigned int code;
-	const char* name;
-	const char* message;
-	const char* file;
+	/**
+	 * @brief Name of the error code, stored in flash.
+	 */
+	PGM_P name;
+	/**
+	 * @brief Error message, stored in flash. `NULL` if no message was thrown.
+	 */
+	PGM_P message;
+	/**
+	 * @brief Name of the source file the error was thrown in, stored in flash.
+	 */
+	PGM_P file;
+	/**
+	 * @brief Name of the function the error was thrown in, stored in SRAM.
+	 * `NULL` unless @ref ERROR_FUNCTION_NAMES is enabled.
+	 */
 	const char* functionName;
 	unsigned int line;
 } Error_t;
@@ -132,22 +178,31 @@ Error_t _error_h_currentError;
 	errorVariable = _error_h_currentError; \
 	if(_error_h_setjmpReturnValue)
 
+#if ERROR_FUNCTION_NAMES
+/**
+ * @brief Internal macro for the function name passed on throwing.
+ */
+#define _ERROR_H_FUNCTION_NAME __FUNCTION__
+#else
+#define _ERROR_H_FUNCTION_NAME NULL
+#endif
+
 /**
  * @brief Thrwos an error with the specified error code.
  * Please refer to the @ref error-handling section for more information.
  * 
  * @param error The error code you want to throw.
  */
-#define throw(error) _error_h_throw(error, #error, 0, __LINE__, __FILE__, __FUNCTION__)
+#define throw(error) _error_h_throw(error, PSTR(#error), NULL, __LINE__, PSTR(__FILE__), _ERROR_H_FUNCTION_NAME)
 
 /**
  * @brief Throws an error with the specified error code and message.
  * Please refer to the @ref error-handling section for more information.
  * 
  * @param error The error code you want to throw.
- * @param msg The error message you want to throw.
+ * @param msg The error message you want to throw. This has to be a string literal, as it is placed in flash.
  */
-#define throwMessage(error, msg) _error_h_throw(error, #error, msg, __LINE__, __FILE__, __FUNCTION__)
+#define throwMessage(error, msg) _error_h_throw(error, PSTR(#error), PSTR(msg), __LINE__, PSTR(__FILE__), _ERROR_H_FUNCTION_NAME)
 
 /**
  * @brief Evaluates the specified @p condition and throws an @p error if the condition is `false`.
@@ -162,10 +217,79 @@ Error_t _error_h_currentError;
  * 
  * @param condition The condition to evaluate before throwing an error.
  * @param error The error code you want to throw.
- * @param message The error message you want to pass with the error.
+ * @param message The error message you want to pass with the error. This has to be a string literal.
  */
 #define assertMessage(condition, error, message) if(!(condition)) { throwMessage(error, message); }
 
+/**
+ * @brief Return type of internal functions reporting errors as an @ref ErrorCode_t. These functions
+ * return @ref ERR_NONE on success. Use @ref ELOB_RAISE to report an error, @ref ELOB_CHECK to propagate
+ * the error of another internal function and @ref ELOB_THROW_ON_ERROR to throw it at the boundary to the application.
+ * 
+ * @code{.c}
+ * static ELOB_STATUS _sensor_readRaw(uint16_t* raw) {
+ *     ELOB_CHECK(_sensor_awaitReady());
+ *     if(*raw == 0xFFFF) ELOB_RAISE(ERR_OUT_OF_RANGE, "sensor: Invalid reading.");
+ *     return ERR_NONE;
+ * }
+ * 
+ * uint16_t sensor_read() {
+ *     uint16_t raw;
+ *     ELOB_THROW_ON_ERROR(_sensor_readRaw(&raw));
+ *     return raw;
+ * }
+ * @endcode
+ * 
+ * If @ref ERROR_RETURN_CODES is disabled, @ref ELOB_RAISE throws directly and the other macros don't check
+ * the returned value at all.
+ */
+#define ELOB_STATUS ErrorCode_t
+
+#if ERROR_RETURN_CODES
+/**
+ * @brief Internal message of the last error reported with @ref ELOB_RAISE.
+ * Do not access this in your application.
+ */
+PGM_P _error_h_statusMessage;
+
+/**
+ * @brief Reports an @p error with a message from an @ref ELOB_STATUS function.
+ * 
+ * @param error The error code to return.
+ * @param msg The error message. This has to be a string literal, as it is placed in flash.
+ */
+#define ELOB_RAISE(error, msg) do { _error_h_statusMessage = PSTR(msg); return (error); } while(0)
+
+/**
+ * @brief Evaluates the @ref ELOB_STATUS expression @p expr and returns its error from the calling
+ * @ref ELOB_STATUS function, if there is one.
+ * 
+ * @param expr The expression to evaluate.
+ */
+#define ELOB_CHECK(expr) do { ErrorCode_t _error_h_status = (expr); if(_error_h_status != ERR_NONE) return _error_h_status; } while(0)
+
+/**
+ * @brief Evaluates the @ref ELOB_STATUS expression @p expr and throws its error, if there is one.
+ * 
+ * @param expr The expression to evaluate.
+ */
+#define ELOB_THROW_ON_ERROR(expr) do { ErrorCode_t _error_h_status = (expr); if(_error_h_status != ERR_NONE) { \
+		_error_h_throw(_error_h_status, error_codeName(_error_h_status), _error_h_statusMessage, __LINE__, PSTR(__FILE__), _ERROR_H_FUNCTION_NAME); \
+	} } while(0)
+#else
+#define ELOB_RAISE(error, msg) throwMessage(error, msg)
+#define ELOB_CHECK(expr) ((void)(expr))
+#define ELOB_THROW_ON_ERROR(expr) ((void)(expr))
+#endif
+
+/**
+ * @brief Returns the name of the given error code of the library.
+ * 
+ * @param code The error code.
+ * @return The name of the error code, stored in flash. `"ERR_UNKNOWN"` for codes which are not part of @ref ErrorCode_t.
+ */
+PGM_P error_codeName(unsigned int code);
+
 /**
  * @brief Initializes the error library. Call this before using any functions
  * or macros of this library.
@@ -191,7 +315,7 @@ void error_print(Error_t errorStruct);
 /**
  * @brief Internal error throw function. Do not use in your code, use @ref throw (or similar) instead.
  */
-void _error_h_throw(unsigned int errorCode, const char* errorName, const char* errorMessage, int line, const char* file, const char* functionName);
+void _error_h_throw(unsigned int errorCode, PGM_P errorName, PGM_P errorMessage, int line, PGM_P file, const char* functionName) __attribute__((noreturn));
 
 /**
  * @brief Internal uncaught error handler. Called automatically, do not use in your code.
@@ -0,0 +1,188 @@
+/**
+ * @file error_log.h
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Ring log of compact error records, which survives fatal errors.
+ * 
+ * Every thrown error (see @ref error.h) is stored as an @ref ErrorRecord_t in a fixed-size ring in SRAM,
+ * including errors which are caught later. If enabled using @ref ERROR_LOG_STORAGE, the newest records are
+ * persisted to the EEPROM or the battery-backed RAM of the DS1307 on an uncaught error, so they can be read
+ * back after the reset using @ref error_log_loadPersisted.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include <avr/pgmspace.h>
+#include "../../../../config.h"
+
+#ifndef ERROR_LOG_H_
+#define ERROR_LOG_H_
+
+/**
+ * @brief Value of @ref ERROR_LOG_STORAGE to not persist the error log.
+ * 
+ */
+#define ERROR_LOG_STORAGE_NONE 0
+/**
+ * @brief Value of @ref ERROR_LOG_STORAGE to persist the error log to the internal EEPROM.
+ * 
+ */
+#define ERROR_LOG_STORAGE_EEPROM 1
+/**
+ * @brief Value of @ref ERROR_LOG_STORAGE to persist the error log to the battery-backed RAM of the DS1307.
+ * The DS1307 has to be initialized using @ref DS1307_init.
+ * 
+ */
+#define ERROR_LOG_STORAGE_DS1307 2
+
+#ifndef ERROR_LOG_SIZE
+/**
+ * @brief Number of records in the ring log. Has to be a power of two up to 128, or 0 to disable the log.
+ * Each record takes `sizeof(ErrorRecord_t)` (10) bytes of SRAM.
+ * 
+ */
+#define ERROR_LOG_SIZE 8
+#endif
+
+#ifndef ERROR_LOG_STORAGE
+/**
+ * @brief Storage the error log is persisted to on an uncaught error. One of @ref ERROR_LOG_STORAGE_NONE,
+ * @ref ERROR_LOG_STORAGE_EEPROM and @ref ERROR_LOG_STORAGE_DS1307. Nothing is persisted by default,
+ * as the log overwrites the storage area of the application.
+ * 
+ */
+#define ERROR_LOG_STORAGE ERROR_LOG_STORAGE_NONE
+#endif
+
+#ifndef ERROR_LOG_EEPROM_ADDRESS
+/**
+ * @brief Start address of the persisted error log in the EEPROM.
+ * 
+ */
+#define ERROR_LOG_EEPROM_ADDRESS 0
+#endif
+
+#ifndef ERROR_LOG_DS1307_OFFSET
+/**
+ * @brief Offset of the persisted error log in the battery-backed RAM of the DS1307. Only as many
+ * records as fit into the rest of the RAM are persisted.
+ * 
+ */
+#define ERROR_LOG_DS1307_OFFSET 0
+#endif
+
+#ifndef ERROR_LOG_WATCHDOG_RESET
+/**
+ * @brief If set to 1, the microcontroller is reset by the watchdog after an uncaught error was reported,
+ * instead of halting until the board is reset manually.
+ * 
+ */
+#define ERROR_LOG_WATCHDOG_RESET 0
+#endif
+
+#if ERROR_LOG_SIZE < 0 || ERROR_LOG_SIZE > 128 || (ERROR_LOG_SIZE & (ERROR_LOG_SIZE - 1)) != 0
+#error "ERROR_LOG_SIZE has to be a power of two up to 128, or 0."
+#endif
+
+#if ERROR_LOG_STORAGE != ERROR_LOG_STORAGE_NONE && ERROR_LOG_STORAGE != ERROR_LOG_STORAGE_EEPROM && ERROR_LOG_STORAGE != ERROR_LOG_STORAGE_DS1307
+#error "ERROR_LOG_STORAGE has to be ERROR_LOG_STORAGE_NONE, ERROR_LOG_STORAGE_EEPROM or ERROR_LOG_STORAGE_DS1307."
+#endif
+
+/**
+ * @brief Struct representing a single error record.
+ * 
+ */
+typedef struct {
+	/**
+	 * @brief The error code.
+	 */
+	uint16_t code;
+	/**
+	 * @brief The line the error was thrown on.
+	 */
+	uint16_t line;
+	/**
+	 * @brief ID of the source file the error was thrown in. This is the address of the file name
+	 * in flash, so it's unique within a firmware build and can be looked up in its map file.
+	 */
+	uint16_t fileId;
+	/**
+	 * @brief Time the error was thrown at, taken from the cached clock of the DS1307 (see @ref DS1307_CACHED_CLOCK).
+	 * 0 if the cached clock is disabled.
+	 */
+	time_t timestamp;
+} ErrorRecord_t;
+
+/**
+ * @brief Returns the number of records in the ring log.
+ * 
+ * @return The number of records, at most @ref ERROR_LOG_SIZE.
+ */
+uint8_t error_log_count();
+
+/**
+ * @brief Gets a record of the ring log.
+ * 
+ * @param index The index of the record, 0 is the newest one.
+ * @param record Target for the record.
+ * @return `true` if the record exists, otherwise `false`.
+ */
+bool error_log_get(uint8_t index, ErrorRecord_t* record);
+
+/**
+ * @brief Removes all records from the ring log.
+ * 
+ */
+void error_log_clear();
+
+/**
+ * @brief Persists the newest records of the ring log to @ref ERROR_LOG_STORAGE, replacing the previously
+ * persisted ones. This is called automatically on an uncaught error, but can also be called by the application.
+ * 
+ * @exception ERR_I2C_TRANSMISSION Persisting to the DS1307 failed.
+ * @exception ERR_I2C_TIMEOUT Persisting to the DS1307 failed.
+ */
+void error_log_persist();
+
+/**
+ * @brief Loads the persisted records, e.g. after a reset caused by an uncaught error.
+ * 
+ * @param records Target for the records, newest first.
+ * @param max The maximum number of records to load.
+ * @return The number of records loaded, 0 if there are none.
+ * 
+ * @exception ERR_I2C_TRANSMISSION Reading from the DS1307 failed.
+ * @exception ERR_I2C_TIMEOUT Reading from the DS1307 failed.
+ */
+uint8_t error_log_loadPersisted(ErrorRecord_t* records, uint8_t max);
+
+/**
+ * @brief Removes the persisted records.
+ * 
+ * @exception ERR_I2C_TRANSMISSION Writing to the DS1307 failed.
+ * @exception ERR_I2C_TIMEOUT Writing to the DS1307 failed.
+ */
+void error_log_clearPersisted();
+
+/**
+ * @brief Prints the records of the ring log to the given stream, newest first.
+ * 
+ * @param stream The stream to print to, e.g. `stderr`.
+ */
+void error_log_print(FILE* stream);
+
+/**
+ * @brief Prints the persisted records to the given stream, newest first. As they may have been
+ * written by a different firmware, the file is printed as its ID.
+ * 
+ * @param stream The stream to print to, e.g. `stderr`.
+ */
+void error_log_printPersisted(FILE* stream);
+
+/**
+ * @brief Internal function storing a record in the ring log in constant time. Called automatically
+ * when an error is thrown, do not use in your code.
+ */
+void _error_log_record(unsigned int code, unsigned int line, PGM_P file);
+
+#endif /* ERROR_LOG_H_ */
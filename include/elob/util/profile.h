@@ -0,0 +1,207 @@
+/**
+ * @file profile.h
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Profiling instrumentation based on a free-running hardware timer.
+ * 
+ * Code sections are measured by placing them between @ref PROFILE_BEGIN and @ref PROFILE_END. The
+ * number of calls and the minimum, maximum and total duration of every probe are collected in a
+ * static table, which can be printed using @ref profile_dump. The timer runs at `F_CPU / 8`, so one
+ * timer tick is 8 CPU cycles and a single measurement can be at most 65535 ticks (32 ms at 16 MHz) long.
+ * 
+ * The library has built-in probes (see @ref Profile_Probe_t). If @ref PROFILE_ENABLED is disabled,
+ * the macros are empty and the probes cost nothing. The functions are only available if it is enabled.
+ * 
+ * @code{.c}
+ * enum { PROBE_CONTROLLER = PROFILE_APP_PROBE(0) };
+ * 
+ * PROFILE_BEGIN(PROBE_CONTROLLER);
+ * controller_update();
+ * PROFILE_END(PROBE_CONTROLLER);
+ * @endcode
+ */
+#include <stdint.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "../../../../config.h"
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#ifndef PROFILE_ENABLED
+/**
+ * @brief Enables the profiling instrumentation. If disabled, @ref PROFILE_BEGIN and @ref PROFILE_END
+ * are empty and the timer is not used.
+ * 
+ */
+#define PROFILE_ENABLED 0
+#endif
+
+#ifndef PROFILE_TIMER
+/**
+ * @brief 16-bit timer used for profiling, either 1 or 5. The timer is reserved if @ref PROFILE_ENABLED is enabled.
+ * 
+ */
+#define PROFILE_TIMER 5
+#endif
+
+#ifndef PROFILE_APP_PROBES
+/**
+ * @brief Number of probes available to the application, see @ref PROFILE_APP_PROBE.
+ * Each probe takes 10 bytes of SRAM.
+ * 
+ */
+#define PROFILE_APP_PROBES 4
+#endif
+
+#if PROFILE_TIMER == 1
+#define _PROFILE_TCCRA TCCR1A
+#define _PROFILE_TCCRB TCCR1B
+#define _PROFILE_TCNT TCNT1
+#define _PROFILE_CLOCK_SELECT (1 << CS11)
+#elif PROFILE_TIMER == 5
+#define _PROFILE_TCCRA TCCR5A
+#define _PROFILE_TCCRB TCCR5B
+#define _PROFILE_TCNT TCNT5
+#define _PROFILE_CLOCK_SELECT (1 << CS51)
+#else
+#error "PROFILE_TIMER has to be 1 or 5."
+#endif
+
+/**
+ * @brief Number of CPU cycles per timer tick.
+ * 
+ */
+#define PROFILE_CYCLES_PER_TICK 8
+
+/**
+ * @brief Probes of the library. Application probes follow after them, see @ref PROFILE_APP_PROBE.
+ * 
+ */
+typedef enum {
+	/**
+	 * @brief Receive complete interrupt service routines of all UART interfaces.
+	 */
+	PROFILE_UART_RX_ISR = 0,
+	/**
+	 * @brief Synchronous I2C transactions (@ref i2c_master_transfer, @ref i2c_master_readRegisters and @ref i2c_master_writeRegisters).
+	 */
+	PROFILE_I2C_TRANSACTION,
+	/**
+	 * @brief @ref DS1307_getDatetime.
+	 */
+	PROFILE_DS1307_GET_DATETIME,
+	/**
+	 * @brief @ref SI_toString.
+	 */
+	PROFILE_SI_TO_STRING,
+	/**
+	 * @brief Number of probes of the library.
+	 */
+	PROFILE_LIBRARY_PROBES
+} Profile_Probe_t;
+
+/**
+ * @brief ID of the application probe with the given index (0 to @ref PROFILE_APP_PROBES - 1).
+ * 
+ */
+#define PROFILE_APP_PROBE(index) (PROFILE_LIBRARY_PROBES + (index))
+
+/**
+ * @brief Total number of probes.
+ * 
+ */
+#define PROFILE_PROBES (PROFILE_LIBRARY_PROBES + PROFILE_APP_PROBES)
+
+/**
+ * @brief Struct containing the collected data of a probe. All durations are in timer ticks.
+ * 
+ */
+typedef struct {
+	uint16_t count;
+	uint16_t min;
+	uint16_t max;
+	uint32_t total;
+} ProfileProbe_t;
+
+#if PROFILE_ENABLED
+/**
+ * @brief Internal table of the probes. Do not access this in your application, use @ref profile_get instead.
+ * 
+ */
+extern ProfileProbe_t _profile_probes[PROFILE_PROBES];
+
+/**
+ * @brief Current timer value.
+ * 
+ */
+#define PROFILE_NOW() ((uint16_t)_PROFILE_TCNT)
+
+/**
+ * @brief Starts a measurement of the probe @p id. Has to be followed by @ref PROFILE_END with the
+ * same @p id in the same scope.
+ * 
+ * @param id The ID of the probe, a @ref Profile_Probe_t or a constant defined as @ref PROFILE_APP_PROBE.
+ * This has to be a single identifier or number, as it is also used to name the start time variable.
+ */
+#define PROFILE_BEGIN(id) uint16_t _profile_start_##id = PROFILE_NOW()
+
+/**
+ * @brief Ends a measurement of the probe @p id and records its duration.
+ * 
+ * @param id The ID of the probe, as passed to @ref PROFILE_BEGIN.
+ */
+#define PROFILE_END(id) _profile_record((id), PROFILE_NOW() - _profile_start_##id)
+
+/**
+ * @brief Internal function recording a duration. Inlined, so probes in interrupt service routines
+ * don't add a function call to them. Do not use in your code, use @ref PROFILE_END instead.
+ * 
+ * @param id The ID of the probe.
+ * @param ticks The duration in timer ticks.
+ */
+static inline void _profile_record(uint8_t id, uint16_t ticks) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ProfileProbe_t* probe = &_profile_probes[id];
+		if(probe->count == 0 || ticks < probe->min) probe->min = ticks;
+		if(ticks > probe->max) probe->max = ticks;
+		
+		// Stop counting instead of wrapping, so the average stays meaningful
+		if(probe->count < UINT16_MAX) {
+			probe->count++;
+			probe->total += ticks;
+		}
+	}
+}
+
+/**
+ * @brief Starts the free-running timer. Called automatically by @ref elob_init.
+ * 
+ */
+void profile_init();
+
+/**
+ * @brief Resets the collected data of all probes.
+ * 
+ */
+void profile_reset();
+
+/**
+ * @brief Gets the collected data of a probe.
+ * 
+ * @param id The ID of the probe.
+ * @param probe Target for the data.
+ */
+void profile_get(uint8_t id, ProfileProbe_t* probe);
+
+/**
+ * @brief Prints the collected data of all probes which were hit to the USB terminal (@ref usb_terminal_f),
+ * in CPU cycles.
+ * 
+ */
+void profile_dump();
+#else
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+#endif
+
+#endif /* PROFILE_H_ */
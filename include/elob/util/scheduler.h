@@ -0,0 +1,238 @@
+/**
+ * @file scheduler.h
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Cooperative event loop with periodic tasks, one-shot tasks and event flags.
+ * 
+ * A hardware timer generates a tick every millisecond, which also advances the timeouts of the
+ * asynchronous I2C transactions (see @ref i2c_master_tick). Tasks are registered in a static table
+ * and run from @ref scheduler_run, one after the other, so they don't need any locking among each other.
+ * Tasks are registered and removed from the main context (including other tasks), not from interrupts.
+ * When no task is ready, the CPU enters `SLEEP_MODE_IDLE` until the next interrupt, so a task is woken
+ * up at most one tick after it became ready.
+ * 
+ * The UART, I2C and input interrupt service routines signal events (see @ref Scheduler_Events_t), which run
+ * the tasks registered with @ref scheduler_onEvent. Applications can signal their own events
+ * (@ref SCHEDULER_APP_EVENT) using @ref scheduler_signal, also from interrupt service routines.
+ * 
+ * The functions are only available if @ref SCHEDULER_ENABLED is enabled.
+ * 
+ * @code{.c}
+ * void blink(void* context) { PORTA ^= 0x01; }
+ * void handleLine(void* context) { ... uart_readUntil(USB_UART_IF, '\n', line, sizeof(line)); ... }
+ * 
+ * int main() {
+ *     elob_init();
+ *     scheduler_every(500, blink, NULL);
+ *     scheduler_onEvent(SCHEDULER_EVENT_UART_RX(1), handleLine, NULL);
+ *     scheduler_run();
+ * }
+ * @endcode
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <util/atomic.h>
+#include "../../../../config.h"
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#ifndef SCHEDULER_ENABLED
+/**
+ * @brief Enables the scheduler. If enabled, @ref elob_init starts the tick timer and the UART and I2C
+ * interrupt service routines signal their events.
+ * 
+ */
+#define SCHEDULER_ENABLED 0
+#endif
+
+#ifndef SCHEDULER_TIMER
+/**
+ * @brief 8-bit timer generating the tick, either 0 or 2. The timer is reserved if @ref SCHEDULER_ENABLED is enabled.
+ * 
+ */
+#define SCHEDULER_TIMER 0
+#endif
+
+#ifndef SCHEDULER_MAX_TASKS
+/**
+ * @brief Maximum number of registered tasks, up to 254. Each task takes 13 bytes of SRAM.
+ * 
+ */
+#define SCHEDULER_MAX_TASKS 8
+#endif
+
+#if SCHEDULER_MAX_TASKS < 1 || SCHEDULER_MAX_TASKS > 254
+#error "SCHEDULER_MAX_TASKS has to be between 1 and 254."
+#endif
+
+/**
+ * @brief Type holding a set of event flags.
+ * 
+ * Bits 0 to 3 are the receive events of the UART interfaces 0 to 3, bits 4 to 7 their transmit
+ * complete events, bit 8 the I2C event, bit 9 the input event and bits 10 to 15 are available to the application.
+ */
+typedef uint16_t Scheduler_Events_t;
+
+/**
+ * @brief Event signaled when the UART interface @p n received a byte.
+ * 
+ */
+#define SCHEDULER_EVENT_UART_RX(n) ((Scheduler_Events_t)1 << (n))
+
+/**
+ * @brief Event signaled when the UART interface @p n moved the last byte of its transmit buffer
+ * to the hardware, i.e. when the transmit buffer became empty.
+ * 
+ */
+#define SCHEDULER_EVENT_UART_TX(n) ((Scheduler_Events_t)1 << (4 + (n)))
+
+/**
+ * @brief Event signaled when an asynchronous I2C transaction finished (successfully or not).
+ * 
+ */
+#define SCHEDULER_EVENT_I2C ((Scheduler_Events_t)1 << 8)
+
+/**
+ * @brief Event signaled when an input event was queued, see @ref input_getEvent.
+ * 
+ */
+#define SCHEDULER_EVENT_INPUT ((Scheduler_Events_t)1 << 9)
+
+/**
+ * @brief Number of events available to the application, see @ref SCHEDULER_APP_EVENT.
+ * 
+ */
+#define SCHEDULER_APP_EVENTS 6
+
+/**
+ * @brief Event of the application with the given index (0 to @ref SCHEDULER_APP_EVENTS - 1).
+ * 
+ */
+#define SCHEDULER_APP_EVENT(index) ((Scheduler_Events_t)1 << (10 + (index)))
+
+/**
+ * @brief Handle of a registered task, the index in the task table.
+ * 
+ */
+typedef uint8_t SchedulerTask_t;
+
+/**
+ * @brief Handle which never refers to a task.
+ * 
+ */
+#define SCHEDULER_NO_TASK ((SchedulerTask_t)0xFF)
+
+/**
+ * @brief Function executed by a task. This is called from @ref scheduler_run, not from an interrupt.
+ * 
+ */
+typedef void (*SchedulerCallback_t)(void* context);
+
+#if SCHEDULER_ENABLED
+/**
+ * @brief Internal set of the signaled events. Do not access this in your application, use @ref scheduler_signal instead.
+ * 
+ */
+extern volatile Scheduler_Events_t _scheduler_events;
+
+/**
+ * @brief Signals the given events. The tasks waiting for them run with the next iteration of
+ * @ref scheduler_run. Inlined, so this can be called from interrupt service routines without overhead.
+ * 
+ * @param events The events to signal.
+ */
+static inline void scheduler_signal(Scheduler_Events_t events) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_scheduler_events |= events;
+	}
+}
+
+/**
+ * @brief Internal macro signaling events from the library, empty if @ref SCHEDULER_ENABLED is disabled.
+ * 
+ */
+#define _SCHEDULER_SIGNAL(events) scheduler_signal(events)
+
+/**
+ * @brief Starts the tick timer and removes all tasks. Called automatically by @ref elob_init.
+ * 
+ */
+void scheduler_init();
+
+/**
+ * @brief Gets the number of milliseconds since @ref scheduler_init was called. Wraps after 49 days.
+ * 
+ * @return The number of ticks.
+ */
+uint32_t scheduler_millis();
+
+/**
+ * @brief Registers a task which runs every @p period milliseconds, the first time after one period.
+ * 
+ * @param period The period in milliseconds, at least 1.
+ * @param callback The function to run.
+ * @param context Pointer passed to @p callback.
+ * @return The handle of the task.
+ * 
+ * @exception ERR_OUT_OF_RANGE @p period is 0.
+ * @exception ERR_BUFFER_OVERFLOW All @ref SCHEDULER_MAX_TASKS tasks are in use.
+ */
+SchedulerTask_t scheduler_every(uint16_t period, SchedulerCallback_t callback, void* context);
+
+/**
+ * @brief Registers a task which runs once after @p delay milliseconds and is removed afterwards.
+ * 
+ * @param delay The delay in milliseconds. 0 runs the task with the next iteration of @ref scheduler_run.
+ * @param callback The function to run.
+ * @param context Pointer passed to @p callback.
+ * @return The handle of the task, which is only valid until the task ran.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW All @ref SCHEDULER_MAX_TASKS tasks are in use.
+ */
+SchedulerTask_t scheduler_after(uint16_t delay, SchedulerCallback_t callback, void* context);
+
+/**
+ * @brief Registers a task which runs whenever one of the given events was signaled. Multiple signals
+ * of the same event before the task runs are merged, so the task has to process all pending data.
+ * 
+ * @param events The events the task waits for.
+ * @param callback The function to run.
+ * @param context Pointer passed to @p callback.
+ * @return The handle of the task.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW All @ref SCHEDULER_MAX_TASKS tasks are in use.
+ */
+SchedulerTask_t scheduler_onEvent(Scheduler_Events_t events, SchedulerCallback_t callback, void* context);
+
+/**
+ * @brief Removes a task. Removing a task which was already removed (or @ref SCHEDULER_NO_TASK) has no effect.
+ * This can also be called from the task itself.
+ * 
+ * @param task The handle of the task.
+ */
+void scheduler_cancel(SchedulerTask_t task);
+
+/**
+ * @brief Runs all tasks which are ready, each at most once. This doesn't block.
+ * 
+ * @return `true` if a task ran, otherwise `false`.
+ */
+bool scheduler_runPending();
+
+/**
+ * @brief Enters `SLEEP_MODE_IDLE` until the next interrupt, unless an event was signaled or a timed task is due. The check and the sleep are atomic, so no wake-up is lost.
+ * Interrupts are enabled afterwards.
+ * 
+ */
+void scheduler_idle();
+
+/**
+ * @brief Runs the event loop, i.e. @ref scheduler_runPending and @ref scheduler_idle, forever.
+ * 
+ */
+void scheduler_run() __attribute__((noreturn));
+#else
+#define _SCHEDULER_SIGNAL(events)
+#endif
+
+#endif /* SCHEDULER_H_ */
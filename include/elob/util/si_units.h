@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <avr/pgmspace.h>
 
 #ifndef SI_UNITS_H_
 #define SI_UNITS_H_
@@ -79,12 +80,12 @@ typedef enum {
  */
 struct Unit {
     /**
-     * @brief Full name of the unit, e.g. _Volt_.
+     * @brief Full name of the unit, e.g. _Volt_. Stored in flash (use `PROGMEM` for custom units).
      * 
      */
     const char* const name;
     /**
-     * @brief Unit abbreviation, e.g. _V_.
+     * @brief Unit abbreviation, e.g. _V_. Stored in flash (use `PROGMEM` for custom units).
      * 
      */
     const char* const abbreviation;
@@ -128,12 +129,53 @@ struct Quantity {
 };
 
 /**
- * @brief Gets the prefix factor from a SI prefix.
+ * @brief Defines a type representing a fixed-point quantity.
+ */
+typedef struct QuantityFx QuantityFx_t;
+
+/**
+ * @brief Defines a struct representing a fixed-point quantity, i.e. an integer mantissa
+ * and a decimal exponent. The value is \f$mantissa \cdot 10^{exponent}\f$ in the unit.
+ * 
+ * In contrast to @ref Quantity_t, no floating point arithmetic is required.
+ */
+struct QuantityFx {
+    /**
+     * @brief The integer mantissa of the quantity.
+     */
+	int32_t _mantissa;
+    /**
+     * @brief The decimal exponent of the quantity.
+     */
+	int8_t _exponent;
+    /**
+     * @brief The unit the quantity is stored in.
+     */
+	const Unit_t* _unit;
+	/**
+	 * @brief The number of significant digits (excluding leading zeros, including trailing zeros)
+     * the quantity includes.
+	 */
+	uint8_t _precision;
+};
+
+#ifndef SI_ARRAY_DELIMITER
+/**
+ * @brief Delimiter between the values written by @ref SI_formatArray.
+ * 
+ */
+#define SI_ARRAY_DELIMITER ", "
+#endif
+
+/**
+ * @brief Gets the prefix factor from a SI prefix. The factor is taken from a table, so this doesn't need `pow`.
  * 
  * @param prefix A SI prefix, as a @ref SI_Prefix_t type.
+ * @return The prefix factor, e.g. `1e-3` for @ref MILLI.
  * 
+ * @exception ERR_OUT_OF_RANGE @p prefix is not one of the values of @ref SI_Prefix_t.
  */
-#define SI_getPrefixFactor(prefix) pow(10, prefix)
+double SI_getPrefixFactor(SI_Prefix_t prefix);
 
 /** @brief Dimensionless unit. */
 extern const Unit_t* const DIMENSIONLESS;
@@ -186,6 +228,7 @@ void SI_removePrefix(Quantity_t* quantity);
  * 
  * @exception ERR_PRECISION_VIOLATED The number can't possibly be expressed without violating the quantities precision. However,
  * the quantity was still adjusted. This means you can catch the error and therefore bypass this check.
+ * @exception ERR_OUT_OF_RANGE @p prefix is not one of the values of @ref SI_Prefix_t.
  */
 void SI_setPrefix(Quantity_t* quantity, SI_Prefix_t prefix);
 
@@ -202,9 +245,9 @@ Quantity_t SI_convert(Quantity_t quantity, const Unit_t* const unit);
  * @brief Gets a pointer pointing to the string with the prefix abbreviation of prefix of the specified quantity.
  * 
  * @param prefix The quantity you want to get the prefix abbreviation from.
- * @return A pointer to the string-form prefix abbreviation.
+ * @return A pointer to the string-form prefix abbreviation, stored in flash.
  */
-const char* SI_getPrefixString(Quantity_t quantity);
+PGM_P SI_getPrefixString(Quantity_t quantity);
 
 /**
  * @brief Converts a given quantity a string and stores it in @p s.
@@ -221,4 +264,85 @@ void SI_toString(Quantity_t quantity, char* s, size_t maxLength);
  */
 void SI_print(Quantity_t quantity);
 
+/**
+ * @brief Initializes a new @ref QuantityFx_t.
+ * 
+ * @code{.c}
+ * // A 10-bit ADC reading with a reference of 5000 mV, in mV
+ * QuantityFx_t voltage = SI_fx(adc * 5000L / 1024, MILLI, VOLT, 4);
+ * @endcode
+ * 
+ * @param mantissa The integer mantissa of the quantity.
+ * @param exponent The decimal exponent of the quantity, e.g. a @ref SI_Prefix_t.
+ * @param unit The unit the quantity is given in.
+ * @param precision The number of significant digits of the quantity.
+ * @return A new @ref QuantityFx_t struct containing the specified information.
+ */
+QuantityFx_t SI_fx(int32_t mantissa, int8_t exponent, const Unit_t* unit, uint8_t precision);
+/**
+ * @brief Converts a given fixed-point quantity to the specified target unit.
+ * 
+ * Only conversions which are a power of ten (e.g. gram to kilogram) are supported, as they only
+ * change the exponent.
+ * 
+ * @param quantity The initial quantity you want to convert from.
+ * @param unit The unit you want to convert to.
+ * @return A new @ref QuantityFx_t struct containing the converted quantity.
+ * 
+ * @exception ERR_INVALID_UNIT The conversion is not a power of ten (e.g. decibels) or the units are incompatible.
+ */
+QuantityFx_t SI_fx_convert(QuantityFx_t quantity, const Unit_t* unit);
+/**
+ * @brief Converts a given fixed-point quantity to a string with a matching SI prefix
+ * (e.g. _12.30 mV_) and stores it in @p s, using integer arithmetic only.
+ * 
+ * @param quantity The quantity you want to convert into a string.
+ * @param s A pointer to the string you want to convert to.
+ * @param maxLength Length of @p s limiting the maximum output length.
+ */
+void SI_fx_toString(QuantityFx_t quantity, char* s, size_t maxLength);
+/**
+ * @brief Prints the given fixed-point quantity to stdout.
+ * 
+ * @param quantity The quantity you want to print.
+ */
+void SI_fx_print(QuantityFx_t quantity);
+
+/**
+ * @brief Converts a block of values from one unit to another.
+ * 
+ * If the conversion is a power of ten (e.g. gram to kilogram), the whole block is scaled with a
+ * single factor. Otherwise, the converters of the units are called for each value.
+ * 
+ * @param src The values to convert, given in @p from without prefix.
+ * @param dst The array the converted values are stored to (may be the same as @p src), in @p to without prefix.
+ * @param n The number of values.
+ * @param from The unit of the source values.
+ * @param to The unit to convert to.
+ */
+void SI_convertArray(const double* src, double* dst, size_t n, const Unit_t* from, const Unit_t* to);
+/**
+ * @brief Selects the SI prefix which fits all values of a block, based on the value with the largest magnitude.
+ * 
+ * @param values The values, without prefix.
+ * @param n The number of values.
+ * @param precision The number of significant digits.
+ * @return The selected prefix.
+ */
+SI_Prefix_t SI_selectArrayPrefix(const double* values, size_t n, uint8_t precision);
+/**
+ * @brief Formats a block of values with one shared SI prefix into a single string, separated by
+ * @ref SI_ARRAY_DELIMITER and followed by the prefix and unit (e.g. _1.20, 0.85, 12.00 mV_).
+ * All values are written with the same number of decimals.
+ * 
+ * @param values The values, given in @p unit without prefix.
+ * @param n The number of values.
+ * @param unit The unit of the values.
+ * @param precision The number of significant digits of the largest value.
+ * @param out The string to write to.
+ * @param len Length of @p out limiting the maximum output length.
+ * @return The length of the written string.
+ */
+size_t SI_formatArray(const double* values, size_t n, const Unit_t* unit, uint8_t precision, char* out, size_t len);
+
 #endif /* SI_UNITS_H_ */
\ No newline at end of file
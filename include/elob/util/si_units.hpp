@@ -0,0 +1,319 @@
+/**
+ * @file si_units.hpp
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Header-only C++ layer for compile-time dimensional analysis on top of @ref si_units.h.
+ *
+ * Quantities are templated on their dimension (exponents of the SI base units) and their SI prefix.
+ * Prefix scaling is resolved at compile time, and adding, subtracting or assigning quantities of
+ * different dimensions does not compile. At runtime, a quantity is just a plain number.
+ *
+ * @code{.cpp}
+ * using namespace elob::si;
+ *
+ * Volts<MILLI> voltage(adcReading * 5000.0f / 1024);
+ * Amperes<MICRO> current(350);
+ * Ohms<KILO> resistance = voltage / current; // V / A = Ohm, prefixes are resolved at compile time
+ *
+ * char s[16];
+ * toString(resistance, s, sizeof(s), 3);
+ * @endcode
+ */
+#include <stdint.h>
+
+extern "C" {
+#include <elob/util/si_units.h>
+}
+
+#ifndef SI_UNITS_HPP_
+#define SI_UNITS_HPP_
+
+namespace elob {
+namespace si {
+
+/**
+ * @brief Type describing a physical dimension by the exponents of the SI base units.
+ *
+ * @tparam Length Exponent of the length (meter).
+ * @tparam Mass Exponent of the mass (kilogram).
+ * @tparam Time Exponent of the time (second).
+ * @tparam Current Exponent of the electrical current (ampere).
+ */
+template<int8_t Length, int8_t Mass, int8_t Time, int8_t Current>
+struct Dimension {
+	static const int8_t length = Length;
+	static const int8_t mass = Mass;
+	static const int8_t time = Time;
+	static const int8_t current = Current;
+};
+
+/** @brief Dimension of dimensionless quantities. */
+typedef Dimension<0, 0, 0, 0> DimensionlessDimension;
+/** @brief Dimension of a length, m. */
+typedef Dimension<1, 0, 0, 0> LengthDimension;
+/** @brief Dimension of a mass, kg. */
+typedef Dimension<0, 1, 0, 0> MassDimension;
+/** @brief Dimension of a time, s. */
+typedef Dimension<0, 0, 1, 0> TimeDimension;
+/** @brief Dimension of an electrical current, A. */
+typedef Dimension<0, 0, 0, 1> CurrentDimension;
+/** @brief Dimension of a frequency, 1/s. */
+typedef Dimension<0, 0, -1, 0> FrequencyDimension;
+/** @brief Dimension of an electrical charge, A s. */
+typedef Dimension<0, 0, 1, 1> ChargeDimension;
+/** @brief Dimension of a power, kg m^2 / s^3. */
+typedef Dimension<2, 1, -3, 0> PowerDimension;
+/** @brief Dimension of an electrical voltage, kg m^2 / (s^3 A). */
+typedef Dimension<2, 1, -3, -1> VoltageDimension;
+/** @brief Dimension of an electrical resistance, kg m^2 / (s^3 A^2). */
+typedef Dimension<2, 1, -3, -2> ResistanceDimension;
+
+/**
+ * @brief Internal metafunction multiplying two dimensions.
+ */
+template<typename A, typename B>
+struct _DimensionProduct {
+	typedef Dimension<A::length + B::length, A::mass + B::mass, A::time + B::time, A::current + B::current> type;
+};
+
+/**
+ * @brief Internal metafunction dividing two dimensions.
+ */
+template<typename A, typename B>
+struct _DimensionQuotient {
+	typedef Dimension<A::length - B::length, A::mass - B::mass, A::time - B::time, A::current - B::current> type;
+};
+
+/**
+ * @brief Internal metafunction checking if two dimensions are equal.
+ */
+template<typename A, typename B>
+struct _SameDimension {
+	static const bool value = A::length == B::length && A::mass == B::mass && A::time == B::time && A::current == B::current;
+};
+
+/**
+ * @brief Calculates \f$10^{exponent}\f$ at compile time.
+ */
+template<typename T>
+constexpr T _pow10(int exponent) {
+	return exponent <= 0 ? T(1) : T(10) * _pow10<T>(exponent - 1);
+}
+
+/**
+ * @brief Scales a value by \f$10^{exponent}\f$. Negative exponents divide, so integers stay exact where possible.
+ */
+template<typename T>
+constexpr T _scale(T value, int exponent) {
+	return exponent >= 0 ? value * _pow10<T>(exponent) : value / _pow10<T>(-exponent);
+}
+
+/**
+ * @brief Gets the smaller of two prefixes.
+ */
+constexpr int8_t _minPrefix(int8_t a, int8_t b) {
+	return a < b ? a : b;
+}
+
+/**
+ * @brief Quantity with a dimension and SI prefix known at compile time.
+ *
+ * @tparam D The dimension, see @ref Dimension.
+ * @tparam Prefix The decimal exponent of the stored value relative to the SI base unit, e.g. a @ref SI_Prefix_t.
+ * @tparam T The type of the stored value, an integer type for fixed-point data paths.
+ */
+template<typename D, int8_t Prefix = 0, typename T = float>
+class Quantity {
+public:
+	typedef D dimension;
+	typedef T value_type;
+	static const int8_t prefix = Prefix;
+
+	/**
+	 * @brief Creates a quantity with the value 0.
+	 */
+	constexpr Quantity() : _value(0) {}
+
+	/**
+	 * @brief Creates a quantity from a value given in the quantity's prefix and unit.
+	 */
+	constexpr explicit Quantity(T value) : _value(value) {}
+
+	/**
+	 * @brief Converts a quantity with another prefix (and value type). The scaling is resolved at compile time.
+	 * Quantities of other dimensions can't be converted.
+	 */
+	template<typename D2, int8_t Prefix2, typename T2>
+	constexpr Quantity(const Quantity<D2, Prefix2, T2>& other) : _value(_scale<T>(T(other.count()), Prefix2 - Prefix)) {
+		static_assert(_SameDimension<D, D2>::value, "si_units: Dimension mismatch.");
+	}
+
+	/**
+	 * @brief Gets the value in the quantity's prefix and unit.
+	 */
+	constexpr T count() const { return _value; }
+
+	/**
+	 * @brief Gets the value in the SI base unit, without prefix.
+	 */
+	constexpr T siValue() const { return _scale<T>(_value, Prefix); }
+
+	Quantity& operator+=(const Quantity& other) { _value += other._value; return *this; }
+	Quantity& operator-=(const Quantity& other) { _value -= other._value; return *this; }
+	Quantity& operator*=(T factor) { _value *= factor; return *this; }
+	Quantity& operator/=(T divisor) { _value /= divisor; return *this; }
+	constexpr Quantity operator-() const { return Quantity(-_value); }
+
+private:
+	T _value;
+};
+
+/** @brief Adds two quantities of the same dimension, the result uses the finer prefix. */
+template<typename D, int8_t P1, int8_t P2, typename T>
+constexpr Quantity<D, _minPrefix(P1, P2), T> operator+(const Quantity<D, P1, T>& a, const Quantity<D, P2, T>& b) {
+	return Quantity<D, _minPrefix(P1, P2), T>(
+		Quantity<D, _minPrefix(P1, P2), T>(a).count() + Quantity<D, _minPrefix(P1, P2), T>(b).count()
+	);
+}
+
+/** @brief Subtracts two quantities of the same dimension, the result uses the finer prefix. */
+template<typename D, int8_t P1, int8_t P2, typename T>
+constexpr Quantity<D, _minPrefix(P1, P2), T> operator-(const Quantity<D, P1, T>& a, const Quantity<D, P2, T>& b) {
+	return Quantity<D, _minPrefix(P1, P2), T>(
+		Quantity<D, _minPrefix(P1, P2), T>(a).count() - Quantity<D, _minPrefix(P1, P2), T>(b).count()
+	);
+}
+
+/** @brief Multiplies two quantities, the dimensions and prefixes are combined at compile time. */
+template<typename D1, int8_t P1, typename D2, int8_t P2, typename T>
+constexpr Quantity<typename _DimensionProduct<D1, D2>::type, P1 + P2, T> operator*(const Quantity<D1, P1, T>& a, const Quantity<D2, P2, T>& b) {
+	return Quantity<typename _DimensionProduct<D1, D2>::type, P1 + P2, T>(a.count() * b.count());
+}
+
+/** @brief Divides two quantities, the dimensions and prefixes are combined at compile time. */
+template<typename D1, int8_t P1, typename D2, int8_t P2, typename T>
+constexpr Quantity<typename _DimensionQuotient<D1, D2>::type, P1 - P2, T> operator/(const Quantity<D1, P1, T>& a, const Quantity<D2, P2, T>& b) {
+	return Quantity<typename _DimensionQuotient<D1, D2>::type, P1 - P2, T>(a.count() / b.count());
+}
+
+/** @brief Multiplies a quantity by a scalar. */
+template<typename D, int8_t P, typename T>
+constexpr Quantity<D, P, T> operator*(const Quantity<D, P, T>& a, typename Quantity<D, P, T>::value_type factor) {
+	return Quantity<D, P, T>(a.count() * factor);
+}
+
+/** @brief Multiplies a quantity by a scalar. */
+template<typename D, int8_t P, typename T>
+constexpr Quantity<D, P, T> operator*(typename Quantity<D, P, T>::value_type factor, const Quantity<D, P, T>& a) {
+	return Quantity<D, P, T>(a.count() * factor);
+}
+
+/** @brief Divides a quantity by a scalar. */
+template<typename D, int8_t P, typename T>
+constexpr Quantity<D, P, T> operator/(const Quantity<D, P, T>& a, typename Quantity<D, P, T>::value_type divisor) {
+	return Quantity<D, P, T>(a.count() / divisor);
+}
+
+/** @brief Compares two quantities of the same dimension and prefix. */
+template<typename D, int8_t P, typename T>
+constexpr bool operator==(const Quantity<D, P, T>& a, const Quantity<D, P, T>& b) { return a.count() == b.count(); }
+/** @brief Compares two quantities of the same dimension and prefix. */
+template<typename D, int8_t P, typename T>
+constexpr bool operator!=(const Quantity<D, P, T>& a, const Quantity<D, P, T>& b) { return a.count() != b.count(); }
+/** @brief Compares two quantities of the same dimension and prefix. */
+template<typename D, int8_t P, typename T>
+constexpr bool operator<(const Quantity<D, P, T>& a, const Quantity<D, P, T>& b) { return a.count() < b.count(); }
+/** @brief Compares two quantities of the same dimension and prefix. */
+template<typename D, int8_t P, typename T>
+constexpr bool operator>(const Quantity<D, P, T>& a, const Quantity<D, P, T>& b) { return a.count() > b.count(); }
+/** @brief Compares two quantities of the same dimension and prefix. */
+template<typename D, int8_t P, typename T>
+constexpr bool operator<=(const Quantity<D, P, T>& a, const Quantity<D, P, T>& b) { return a.count() <= b.count(); }
+/** @brief Compares two quantities of the same dimension and prefix. */
+template<typename D, int8_t P, typename T>
+constexpr bool operator>=(const Quantity<D, P, T>& a, const Quantity<D, P, T>& b) { return a.count() >= b.count(); }
+
+/** @brief Dimensionless quantity. */
+template<int8_t P = NONE, typename T = float> using Dimensionless = Quantity<DimensionlessDimension, P, T>;
+/** @brief Length in meters. */
+template<int8_t P = NONE, typename T = float> using Meters = Quantity<LengthDimension, P, T>;
+/** @brief Mass, the prefix is relative to the kilogram (i.e. grams are `Kilograms<MILLI>`). */
+template<int8_t P = NONE, typename T = float> using Kilograms = Quantity<MassDimension, P, T>;
+/** @brief Mass in grams. */
+template<int8_t P = NONE, typename T = float> using Grams = Quantity<MassDimension, P - 3, T>;
+/** @brief Time in seconds. */
+template<int8_t P = NONE, typename T = float> using Seconds = Quantity<TimeDimension, P, T>;
+/** @brief Electrical current in amperes. */
+template<int8_t P = NONE, typename T = float> using Amperes = Quantity<CurrentDimension, P, T>;
+/** @brief Frequency in hertz. */
+template<int8_t P = NONE, typename T = float> using Hertz = Quantity<FrequencyDimension, P, T>;
+/** @brief Electrical charge in coulombs. */
+template<int8_t P = NONE, typename T = float> using Coulombs = Quantity<ChargeDimension, P, T>;
+/** @brief Power in watts. */
+template<int8_t P = NONE, typename T = float> using Watts = Quantity<PowerDimension, P, T>;
+/** @brief Electrical voltage in volts. */
+template<int8_t P = NONE, typename T = float> using Volts = Quantity<VoltageDimension, P, T>;
+/** @brief Electrical resistance in ohms. */
+template<int8_t P = NONE, typename T = float> using Ohms = Quantity<ResistanceDimension, P, T>;
+
+/**
+ * @brief Internal mapping of a dimension to a @ref Unit_t of the C library.
+ * Only specialized for dimensions which have a unit in @ref si_units.h.
+ */
+template<typename D>
+struct _UnitOf;
+
+template<> struct _UnitOf<DimensionlessDimension> { static const Unit_t* unit() { return DIMENSIONLESS; } static const int8_t exponent = 0; };
+template<> struct _UnitOf<LengthDimension> { static const Unit_t* unit() { return METER; } static const int8_t exponent = 0; };
+template<> struct _UnitOf<TimeDimension> { static const Unit_t* unit() { return SECOND; } static const int8_t exponent = 0; };
+template<> struct _UnitOf<CurrentDimension> { static const Unit_t* unit() { return AMPERE; } static const int8_t exponent = 0; };
+template<> struct _UnitOf<VoltageDimension> { static const Unit_t* unit() { return VOLT; } static const int8_t exponent = 0; };
+template<> struct _UnitOf<ResistanceDimension> { static const Unit_t* unit() { return OHM; } static const int8_t exponent = 0; };
+// The mass is output in grams, so the SI prefixes apply
+template<> struct _UnitOf<MassDimension> { static const Unit_t* unit() { return GRAM; } static const int8_t exponent = 3; };
+
+/**
+ * @brief Converts the quantity to a @ref Quantity_t of the C library (floating point) with a matching prefix.
+ *
+ * @param quantity The quantity to convert.
+ * @param precision The number of significant digits.
+ * @return The @ref Quantity_t.
+ */
+template<typename D, int8_t P, typename T>
+Quantity_t toQuantity(const Quantity<D, P, T>& quantity, uint8_t precision) {
+	return SI(_scale<double>(double(quantity.count()), P + _UnitOf<D>::exponent), _UnitOf<D>::unit(), precision);
+}
+
+/**
+ * @brief Converts the quantity to a @ref QuantityFx_t of the C library without floating point arithmetic.
+ *
+ * @param quantity The quantity to convert, its value has to fit into 32 bits.
+ * @param precision The number of significant digits.
+ * @return The @ref QuantityFx_t.
+ */
+template<typename D, int8_t P, typename T>
+QuantityFx_t toQuantityFx(const Quantity<D, P, T>& quantity, uint8_t precision) {
+	return SI_fx(int32_t(quantity.count()), P + _UnitOf<D>::exponent, _UnitOf<D>::unit(), precision);
+}
+
+/**
+ * @brief Converts the quantity to a string with a matching SI prefix. Integer quantities are
+ * formatted without floating point arithmetic.
+ *
+ * @param quantity The quantity to convert.
+ * @param s A pointer to the string you want to convert to.
+ * @param maxLength Length of @p s limiting the maximum output length.
+ * @param precision The number of significant digits.
+ */
+template<typename D, int8_t P, typename T>
+void toString(const Quantity<D, P, T>& quantity, char* s, size_t maxLength, uint8_t precision) {
+	if(T(0.5) == T(0)) {
+		SI_fx_toString(toQuantityFx(quantity, precision), s, maxLength);
+	} else {
+		SI_toString(toQuantity(quantity, precision), s, maxLength);
+	}
+}
+
+} // namespace si
+} // namespace elob
+
+#endif /* SI_UNITS_HPP_ */
@@ -0,0 +1,247 @@
+/**
+ * @file telemetry.h
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Binary telemetry frames over a UART interface.
+ * 
+ * A frame consists of a message type byte, up to @ref TELEMETRY_MAX_PAYLOAD payload bytes and a CRC-16
+ * over both (CCITT polynomial, reflected, initial value `0xFFFF`, transmitted little-endian, computed
+ * using `_crc_ccitt_update` of avr-libc). The frame is COBS encoded, so it contains no zero bytes, and
+ * terminated by a zero byte. A receiver can therefore resynchronize at any zero byte.
+ * 
+ * Frames are encoded byte by byte directly into the transmit buffer of @ref TELEMETRY_UART, without
+ * an intermediate copy, and sent as soon as they are complete. Multi-byte values are sent in the
+ * native little-endian byte order. `tools/telemetry_decode.py` decodes the frames on the host.
+ * 
+ * @code{.c}
+ * TelemetryWriter_t writer;
+ * telemetry_begin(&writer, MSG_SAMPLE);
+ * telemetry_putUint32(&writer, timestamp);
+ * telemetry_putInt16(&writer, temperature);
+ * telemetry_end(&writer);
+ * @endcode
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <elob/util/buffer.h>
+#include <elob/drivers/uart.h>
+#include "../../../../config.h"
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#ifndef TELEMETRY_UART
+/**
+ * @brief UART interface the frames are sent on, by default the USB UART (see @ref USB_UART_IF).
+ * Its transmit buffer has to hold at least @ref TELEMETRY_MAX_FRAME_SIZE bytes.
+ * 
+ */
+#define TELEMETRY_UART USB_UART_IF
+#endif
+
+#ifndef TELEMETRY_MAX_PAYLOAD
+/**
+ * @brief Maximum number of payload bytes per frame, up to 120. Each @ref TelemetryDecoder_t
+ * takes this plus 14 bytes of SRAM.
+ * 
+ */
+#define TELEMETRY_MAX_PAYLOAD 32
+#endif
+
+#if TELEMETRY_MAX_PAYLOAD < 1 || TELEMETRY_MAX_PAYLOAD > 120
+#error "TELEMETRY_MAX_PAYLOAD has to be between 1 and 120."
+#endif
+
+/**
+ * @brief Maximum size of an encoded frame: the COBS code byte, the type, the payload, the CRC and
+ * the delimiter. Frames are shorter than 254 bytes, so COBS never adds a second code byte.
+ * 
+ */
+#define TELEMETRY_MAX_FRAME_SIZE (TELEMETRY_MAX_PAYLOAD + 5)
+
+/**
+ * @brief Struct holding the state of a frame which is being encoded.
+ * 
+ * Always use the functions from @ref telemetry.h to modify this struct.
+ * 
+ */
+typedef struct {
+	/**
+	 * @brief Transmit buffer the frame is encoded into.
+	 */
+	Buffer_t* _buffer;
+	/**
+	 * @brief Number of encoded bytes, relative to the end of the transmit buffer.
+	 */
+	uint8_t _length;
+	/**
+	 * @brief Position of the code byte of the current COBS block.
+	 */
+	uint8_t _codeOffset;
+	/**
+	 * @brief Code of the current COBS block, i.e. its length plus one.
+	 */
+	uint8_t _code;
+	/**
+	 * @brief Number of payload bytes written.
+	 */
+	uint8_t _payloadLength;
+	/**
+	 * @brief CRC of the type and the payload written so far.
+	 */
+	uint16_t _crc;
+} TelemetryWriter_t;
+
+/**
+ * @brief Starts a new frame. This blocks until @ref TELEMETRY_MAX_FRAME_SIZE bytes are free in the
+ * transmit buffer. Nothing else may be sent on @ref TELEMETRY_UART until @ref telemetry_end is called.
+ * 
+ * @param writer The writer, which doesn't have to be initialized.
+ * @param type The message type of the frame.
+ * 
+ * @exception ERR_INVALID_INTERFACE @ref TELEMETRY_UART is disabled or has no transmit buffer.
+ * @exception ERR_BUFFER_OVERFLOW The transmit buffer is smaller than @ref TELEMETRY_MAX_FRAME_SIZE.
+ */
+void telemetry_begin(TelemetryWriter_t* writer, uint8_t type);
+
+/**
+ * @brief Appends a payload byte to the frame.
+ * 
+ * @param writer The writer of the frame.
+ * @param data The byte to append.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW The payload would exceed @ref TELEMETRY_MAX_PAYLOAD bytes.
+ */
+void telemetry_putByte(TelemetryWriter_t* writer, uint8_t data);
+
+/**
+ * @brief Appends a block of payload bytes to the frame.
+ * 
+ * @param writer The writer of the frame.
+ * @param data The bytes to append.
+ * @param n The number of bytes in @p data.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW The payload would exceed @ref TELEMETRY_MAX_PAYLOAD bytes.
+ */
+void telemetry_write(TelemetryWriter_t* writer, const void* data, uint8_t n);
+
+/**
+ * @brief Appends an unsigned 16-bit value to the frame.
+ * 
+ */
+static inline void telemetry_putUint16(TelemetryWriter_t* writer, uint16_t value) { telemetry_write(writer, &value, sizeof(value)); }
+
+/**
+ * @brief Appends a signed 16-bit value to the frame.
+ * 
+ */
+static inline void telemetry_putInt16(TelemetryWriter_t* writer, int16_t value) { telemetry_write(writer, &value, sizeof(value)); }
+
+/**
+ * @brief Appends an unsigned 32-bit value to the frame.
+ * 
+ */
+static inline void telemetry_putUint32(TelemetryWriter_t* writer, uint32_t value) { telemetry_write(writer, &value, sizeof(value)); }
+
+/**
+ * @brief Appends a 32-bit floating point value to the frame.
+ * 
+ */
+static inline void telemetry_putFloat(TelemetryWriter_t* writer, float value) { telemetry_write(writer, &value, sizeof(value)); }
+
+/**
+ * @brief Finishes the frame and sends it.
+ * 
+ * @param writer The writer of the frame.
+ */
+void telemetry_end(TelemetryWriter_t* writer);
+
+/**
+ * @brief Sends a complete frame.
+ * 
+ * @param type The message type of the frame.
+ * @param payload The payload of the frame.
+ * @param length The number of bytes in @p payload.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW @p length exceeds @ref TELEMETRY_MAX_PAYLOAD.
+ */
+void telemetry_send(uint8_t type, const void* payload, uint8_t length);
+
+/**
+ * @brief Struct holding the state of a frame decoder.
+ * 
+ * The fields `type`, `payload` and `length` describe the last frame, after @ref telemetry_decoder_feed
+ * or @ref telemetry_decoder_poll returned `true`, until the next byte is fed. They must not be modified.
+ * 
+ */
+typedef struct {
+	/**
+	 * @brief Message type of the frame.
+	 */
+	uint8_t type;
+	/**
+	 * @brief Payload of the frame, followed by the CRC.
+	 */
+	uint8_t payload[TELEMETRY_MAX_PAYLOAD + 2];
+	/**
+	 * @brief Number of payload bytes.
+	 */
+	uint8_t length;
+	/**
+	 * @brief Number of valid frames received.
+	 */
+	uint16_t frames;
+	/**
+	 * @brief Number of frames dropped because of an invalid encoding, a wrong CRC or an oversized payload.
+	 */
+	uint16_t errors;
+	/**
+	 * @brief Number of decoded bytes of the current frame, including the type.
+	 */
+	uint8_t _index;
+	/**
+	 * @brief Number of bytes left in the current COBS block.
+	 */
+	uint8_t _remaining;
+	/**
+	 * @brief Code of the current COBS block.
+	 */
+	uint8_t _code;
+	/**
+	 * @brief Flags of the current frame, see `_TELEMETRY_DECODER_*` in telemetry.c.
+	 */
+	uint8_t _flags;
+	/**
+	 * @brief CRC of the decoded bytes of the current frame.
+	 */
+	uint16_t _crc;
+} TelemetryDecoder_t;
+
+/**
+ * @brief Initializes a decoder. Bytes before the first zero byte are discarded, as the decoder
+ * can't know whether it started in the middle of a frame.
+ * 
+ * @param decoder The decoder to initialize.
+ */
+void telemetry_decoder_init(TelemetryDecoder_t* decoder);
+
+/**
+ * @brief Feeds a received byte to the decoder. This runs in constant time and never throws,
+ * so it can be called from interrupt service routines.
+ * 
+ * @param decoder The decoder.
+ * @param data The received byte.
+ * @return `true` if the byte completed a valid frame, otherwise `false`.
+ */
+bool telemetry_decoder_feed(TelemetryDecoder_t* decoder, uint8_t data);
+
+/**
+ * @brief Feeds the bytes available in the receive buffer of the given UART interface to the decoder,
+ * until a frame is complete. This doesn't block.
+ * 
+ * @param decoder The decoder.
+ * @param uartInterface The UART interface to read from.
+ * @return `true` if a valid frame was completed, otherwise `false`.
+ */
+bool telemetry_decoder_poll(TelemetryDecoder_t* decoder, UART_Interface_t uartInterface);
+
+#endif /* TELEMETRY_H_ */
@@ -4,6 +4,9 @@
  * @brief Terminal emulator customization using ANSI escape sequences.
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifndef TERMINAL_H_
 #define TERMINAL_H_
 
@@ -39,6 +42,25 @@ typedef enum {
 	TERMINAL_STYLE_STRIKETHROUGH = 9
 } USB_TerminalStyle_t;
 
+/**
+ * @brief Sets the colors and the style of the terminal emulator with a single escape sequence
+ * (e.g. `ESC[0;1;31;40m`), written with a single write.
+ * 
+ * The library keeps track of the terminal state, so only changed attributes are sent and nothing
+ * is sent at all if the terminal already is in the requested state.
+ * 
+ * @param foreground The foreground color.
+ * @param background The background color.
+ * @param style The only style to be active, @ref TERMINAL_STYLE_RESET for no style.
+ */
+void terminal_apply(USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style);
+/**
+ * @brief Marks the cached terminal state as unknown, so the next change is sent completely.
+ * Call this e.g. after the terminal emulator was reconnected or reset.
+ * 
+ */
+void terminal_invalidate();
+
 /**
  * @brief Sets the foreground color of the terminal emulator.
  * 
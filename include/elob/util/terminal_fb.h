@@ -0,0 +1,120 @@
+/**
+ * @file terminal_fb.h
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Framebuffer for the terminal emulator which only sends the changed parts of the screen.
+ * 
+ * The application writes characters with their attributes to a grid of cells. @ref terminal_fb_present
+ * then sends only the changed runs of cells, using cursor positioning escape sequences and merged
+ * attribute changes (see @ref terminal_apply). The refresh cost therefore scales with what changed,
+ * not with the screen size.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+#include <elob/util/terminal.h>
+#include "../../../../config.h"
+
+#ifndef TERMINAL_FB_H_
+#define TERMINAL_FB_H_
+
+#ifndef TERMINAL_FB_COLUMNS
+/**
+ * @brief Number of columns of the framebuffer. Each cell takes 3 bytes of SRAM.
+ * 
+ */
+#define TERMINAL_FB_COLUMNS 40
+#endif
+
+#ifndef TERMINAL_FB_ROWS
+/**
+ * @brief Number of rows of the framebuffer. Each cell takes 3 bytes of SRAM.
+ * 
+ */
+#define TERMINAL_FB_ROWS 12
+#endif
+
+#if TERMINAL_FB_COLUMNS < 1 || TERMINAL_FB_COLUMNS > 255 || TERMINAL_FB_ROWS < 1 || TERMINAL_FB_ROWS > 255
+#error "TERMINAL_FB_COLUMNS and TERMINAL_FB_ROWS have to be between 1 and 255."
+#endif
+
+/**
+ * @brief Initializes the framebuffer with spaces in the default colors. The next
+ * @ref terminal_fb_present clears the screen and draws the whole framebuffer.
+ * 
+ */
+void terminal_fb_init();
+
+/**
+ * @brief Clears the framebuffer to spaces in the default colors. Only the cells which
+ * were not empty before are sent with the next @ref terminal_fb_present.
+ * 
+ */
+void terminal_fb_clear();
+
+/**
+ * @brief Marks all cells as changed, so the next @ref terminal_fb_present redraws the whole screen,
+ * e.g. after the terminal emulator was reconnected.
+ * 
+ */
+void terminal_fb_invalidate();
+
+/**
+ * @brief Sets a single cell of the framebuffer. Cells outside the framebuffer are ignored.
+ * 
+ * @param column The column of the cell (0-based).
+ * @param row The row of the cell (0-based).
+ * @param c The character, should be printable.
+ * @param foreground The foreground color.
+ * @param background The background color.
+ * @param style The style of the cell.
+ */
+void terminal_fb_setCell(uint8_t column, uint8_t row, char c, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style);
+
+/**
+ * @brief Writes a string to the framebuffer, clipped at the right edge.
+ * 
+ * @param column The column of the first character (0-based).
+ * @param row The row (0-based).
+ * @param s The string to write.
+ * @param foreground The foreground color.
+ * @param background The background color.
+ * @param style The style of the characters.
+ * @return The number of cells written.
+ */
+uint8_t terminal_fb_print(uint8_t column, uint8_t row, const char* s, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style);
+
+/**
+ * @brief Writes a string stored in flash to the framebuffer, clipped at the right edge.
+ * 
+ * @param column The column of the first character (0-based).
+ * @param row The row (0-based).
+ * @param s The string to write, stored in flash.
+ * @param foreground The foreground color.
+ * @param background The background color.
+ * @param style The style of the characters.
+ * @return The number of cells written.
+ */
+uint8_t terminal_fb_print_P(uint8_t column, uint8_t row, PGM_P s, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style);
+
+/**
+ * @brief Fills a rectangle of the framebuffer with a character, clipped at the edges.
+ * 
+ * @param column The left column (0-based).
+ * @param row The top row (0-based).
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @param c The character.
+ * @param foreground The foreground color.
+ * @param background The background color.
+ * @param style The style of the cells.
+ */
+void terminal_fb_fill(uint8_t column, uint8_t row, uint8_t width, uint8_t height, char c, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style);
+
+/**
+ * @brief Sends the changed cells to the terminal emulator (`stdout`). The framebuffer is
+ * drawn at the top left corner of the screen.
+ * 
+ */
+void terminal_fb_present();
+
+#endif /* TERMINAL_FB_H_ */
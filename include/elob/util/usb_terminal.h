@@ -6,12 +6,37 @@
 
 #include <elob/drivers/uart.h>
 #include <stdio.h>
+#include <avr/pgmspace.h>
+#include "../../../../config.h"
 
 #ifndef USB_TERMINAL_H_
 #define USB_TERMINAL_H_
 
+#ifndef USB_TERMINAL_LINE_BUFFERED
+/**
+ * @brief If set to 1, the output to @ref usb_terminal_f is collected in a line buffer and handed to the
+ * transmit buffer of the UART interface in one block write whenever a newline is written, the line buffer
+ * is full or @ref usb_terminal_flush is called. `stderr` stays unbuffered.
+ * 
+ */
+#define USB_TERMINAL_LINE_BUFFERED 0
+#endif
+
+#ifndef USB_TERMINAL_LINE_BUFFER_SIZE
+/**
+ * @brief Size of the line buffer in bytes, if @ref USB_TERMINAL_LINE_BUFFERED is enabled.
+ * 
+ */
+#define USB_TERMINAL_LINE_BUFFER_SIZE 64
+#endif
+
+#if USB_TERMINAL_LINE_BUFFERED && (USB_TERMINAL_LINE_BUFFER_SIZE < 1 || USB_TERMINAL_LINE_BUFFER_SIZE > 255)
+#error "USB_TERMINAL_LINE_BUFFER_SIZE has to be between 1 and 255."
+#endif
+
 /**
  * @brief Initializes the UART interface used for the USB-over-Serial connection and sets `stdout`, `stderr` and `stdin` to usb_terminal_f.
+ * With @ref USB_TERMINAL_LINE_BUFFERED enabled, `stderr` is set to an unbuffered stream instead.
  * 
  * @param baudrate Baudrate used for the connection.
  * @param parityMode Parity mode for the connection.
@@ -27,9 +52,18 @@ void usb_terminal_init(
 
 /**
  * @brief USB terminal `FILE` object. This allows for `printf`-like functions to be used.
+ * The stream is statically allocated, so no heap is required.
+ * 
+ */
+extern FILE* usb_terminal_f;
+
+/**
+ * @brief Hands the content of the line buffer to the transmit buffer of the UART interface.
+ * Does nothing if @ref USB_TERMINAL_LINE_BUFFERED is disabled.
  * 
+ * The line buffer is flushed automatically before reading from or writing directly to the terminal.
  */
-FILE* usb_terminal_f;
+void usb_terminal_flush();
 
 /**
  * @brief Prints a single char to the terminal.
@@ -49,6 +83,22 @@ void usb_terminal_print(char* s);
  * @param s The string to print to terminal.
  */
 void usb_terminal_println(char* s);
+/**
+ * @brief Prints a string stored in flash to the terminal.
+ * 
+ * @code{.c}
+ * usb_terminal_print_P(PSTR("Hello world"));
+ * @endcode
+ * 
+ * @param s The string to print to the terminal, stored in flash.
+ */
+void usb_terminal_print_P(PGM_P s);
+/**
+ * @brief Prints a string stored in flash to the terminal with a trailing newline.
+ * 
+ * @param s The string to print to terminal, stored in flash.
+ */
+void usb_terminal_println_P(PGM_P s);
 
 /**
  * @brief Reads a single char from the terminal.
@@ -57,13 +107,90 @@ void usb_terminal_println(char* s);
  */
 char usb_terminal_readChar();
 /**
- * @brief Reads a stream of characters from the terminal, limited by a newline or the maximum length of the target buffer.
+ * @brief Reads a line from the terminal, blocking until a CR or LF has been received. Uses a
+ * @ref USB_TerminalLineReader_t internally.
  * 
- * @param target Target buffer to write the received characters to.
- * @param maxLength The maximum length of the buffer.
+ * Throws an `ERR_BUFFER_OVERFLOW` after the whole line has been received, if it didn't fit into the target buffer.
+ * 
+ * @param target Target buffer to write the received characters to, null-terminated without the CR/LF.
+ * @param maxLength The maximum length of the buffer, including the null terminator.
  */
 void usb_terminal_readln(char* target, size_t maxLength);
 
+/**
+ * @brief Struct representing the state of a non-blocking line reader. Use @ref usb_terminal_lineReader_init
+ * to initialize it and call @ref usb_terminal_lineReader_poll from the main loop.
+ * 
+ * @code{.c}
+ * char command[32];
+ * USB_TerminalLineReader_t reader;
+ * usb_terminal_lineReader_init(&reader, command, sizeof(command));
+ * 
+ * while(1) {
+ *     sampleInputs();
+ *     if(usb_terminal_lineReader_poll(&reader)) {
+ *         handleCommand(command);
+ *         usb_terminal_lineReader_reset(&reader);
+ *     }
+ * }
+ * @endcode
+ */
+typedef struct {
+	/**
+	 * @brief Target buffer for the line.
+	 */
+	char* buffer;
+	/**
+	 * @brief Size of the target buffer, including the null terminator.
+	 */
+	size_t maxLength;
+	/**
+	 * @brief Number of characters in the buffer.
+	 */
+	size_t length;
+	/**
+	 * @brief `true` when a line is complete. The buffer is null-terminated then.
+	 */
+	bool complete;
+	/**
+	 * @brief `true` if characters of the current line had to be dropped, because the buffer was full.
+	 */
+	bool overflow;
+	/**
+	 * @brief Internal: The last received character was a CR, so a following LF is ignored.
+	 */
+	bool _lastWasCR;
+} USB_TerminalLineReader_t;
+
+/**
+ * @brief Initializes a line reader.
+ * 
+ * @param reader The line reader to initialize.
+ * @param buffer Target buffer for the line.
+ * @param maxLength Size of the target buffer, including the null terminator. Has to be at least 1.
+ */
+void usb_terminal_lineReader_init(USB_TerminalLineReader_t* reader, char* buffer, size_t maxLength);
+
+/**
+ * @brief Discards the current line, so the reader can receive the next one.
+ * 
+ * @param reader The line reader.
+ */
+void usb_terminal_lineReader_reset(USB_TerminalLineReader_t* reader);
+
+/**
+ * @brief Consumes all characters which are currently available from the terminal without blocking.
+ * The characters are echoed, backspace (DEL or BS) removes the last character. A CR, LF or CRLF
+ * completes the line. Characters which don't fit into the buffer are dropped and a BEL is echoed
+ * instead.
+ * 
+ * Once a line is complete, no more characters are consumed until @ref usb_terminal_lineReader_reset is called.
+ * 
+ * @param reader The line reader.
+ * @return `true` if a line is complete, otherwise `false`.
+ */
+bool usb_terminal_lineReader_poll(USB_TerminalLineReader_t* reader);
+
 /**
  * @brief Displays a prompt allowing the user to enter an unsigned integer with the
  * given range limits.
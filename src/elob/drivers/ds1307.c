@@ -4,9 +4,13 @@
  * @brief Source file for @ref ds1307.h.
  */
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <stdbool.h>
 #include <time.h>
 #include <elob/drivers/ds1307.h>
 #include <elob/drivers/i2c_master.h>
+#include <elob/util/profile.h>
 #include <elob/util/binary.h>
 #include <elob/util/error.h>
 
@@ -16,127 +20,409 @@
  */
 #define _DS1307_I2C_ADDR 0b1101000
 
-void DS1307_init() {
-	// Initialize the required I2C interface
-	i2c_master_setBitrate(10000); // The DS1307 requires 10 kHz as it's bitrate
-	i2c_master_enable();
-}
+/**
+ * @brief Control register value enabling the SQW output with 1 Hz.
+ * 
+ */
+#define _DS1307_CTRL_SQW_1HZ 0x10
 
-uint8_t DS1307_getRegister(DS1307Register_t reg) {
-	i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_WRITE); // Send a start condition and SLA+W
-	i2c_master_sendByte(reg); // Set the internal memory pointer of the DS1307
-	i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_READ); // Send a repeated start condition and SLA+R
-	uint8_t registerValue = i2c_master_readByte(I2C_NACK); // Read one byte from the DS1307
-	i2c_master_endFrame(); // Send a stop condition
-	
-	return registerValue;
-}
+/**
+ * @brief Register address of the first byte of the battery-backed RAM.
+ * 
+ */
+#define _DS1307_RAM_ADDR 0x08
+
+/**
+ * @brief Number of time registers of the DS1307 (seconds to year).
+ * 
+ */
+#define _DS1307_TIME_REGISTER_COUNT 7
+
+/**
+ * @brief Timeout in milliseconds of a register transaction transferring @p n data bytes. Adds the time of
+ * the data, the register address and the slave addresses (9 bits each) at @ref DS1307_I2C_BITRATE to
+ * @ref I2C_MASTER_TIMEOUT, as a long transfer at a low bitrate exceeds the default timeout.
+ * 
+ */
+#define _DS1307_TIMEOUT(n) (I2C_MASTER_TIMEOUT + ((n) + 3) * 9000UL / DS1307_I2C_BITRATE + 1)
+
+/**
+ * @brief Number of seconds per day.
+ * 
+ */
+#define _DS1307_SECONDS_PER_DAY 86400UL
 
-void DS1307_getAllRegisters(uint8_t* registerTable) {	
-	i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_WRITE); // Send a start condition and SLA+W
-	i2c_master_sendByte(0); // Reset the internal memory pointer of the DS1307
-	i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_READ); // Send a repeated start condition and SLA+R
+/**
+ * @brief Number of days in a leap year cycle of four years.
+ * 
+ */
+#define _DS1307_DAYS_PER_4_YEARS (4 * 365 + 1)
+
+/**
+ * @brief Number of days before the first day of each month in a non-leap year.
+ * 
+ */
+static const uint16_t _DS1307_daysBeforeMonth[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+
+/**
+ * @brief Decodes the time registers of the DS1307 to the datetime fields.
+ * 
+ * @param registers The values of the time registers, indexed by the register address.
+ * @param datetime The struct to store the fields to.
+ */
+static void _DS1307_decodeRegisters(const uint8_t* registers, DS1307_Datetime_t* datetime) {
+	datetime->second = FROM_BCD(registers[DS1307_SECOND_REGISTER] & 0x7F);
+	datetime->minute = FROM_BCD(registers[DS1307_MINUTE_REGISTER] & 0x7F);
 	
-	// Read all 8 registers from the DS1307
-	for(int registerAddress = 0; registerAddress < 8; registerAddress++) {
-		registerTable[registerAddress] = i2c_master_readByte(
-			registerAddress < 7 ? I2C_ACK : I2C_NACK // Send a NACK for the last read
-		); // Read one byte from the DS1307
+	// Parse the hour register value
+	uint8_t hour = registers[DS1307_HOUR_REGISTER];
+	if(CHECKBIT(hour, 6)) { // Check if 12h is activated
+		// The RTC is in 12h mode, 12 AM is hour 0 and 12 PM is hour 12
+		datetime->hour = FROM_BCD(hour & 0x1F) % 12;
+		
+		if(CHECKBIT(hour, 5)) { // Check if it's PM
+			datetime->hour += 12;
+		}
+	} else {
+		// The RTC is in 24h mode
+		datetime->hour = FROM_BCD(hour & 0x3F);
 	}
 	
-	i2c_master_endFrame(); // Send a stop condition
+	datetime->dayOfWeek = registers[DS1307_DOW_REGISTER] & 0x07;
+	datetime->day = FROM_BCD(registers[DS1307_DATE_REGISTER] & 0x3F);
+	datetime->month = FROM_BCD(registers[DS1307_MONTH_REGISTER] & 0x1F);
+	datetime->year = FROM_BCD(registers[DS1307_YEAR_REGISTER]);
 }
 
-void DS1307_setRegister(DS1307Register_t reg, uint8_t data) {
-	i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_WRITE); // Send a start condition and SLA+W
-	i2c_master_sendByte(reg); // Set the internal memory pointer of the DS1307
-	i2c_master_sendByte(data); // Set the register value of the DS1307
-	i2c_master_endFrame(); // Send a stop condition
+/**
+ * @brief Encodes the datetime fields to the time registers of the DS1307 (24h mode, oscillator enabled).
+ * 
+ * @param datetime The fields to encode.
+ * @param registers The array of 7 bytes the register values are stored to.
+ */
+static void _DS1307_encodeRegisters(const DS1307_Datetime_t* datetime, uint8_t* registers) {
+	registers[DS1307_SECOND_REGISTER] = TO_BCD(datetime->second) & 0x7F; // This also clears the clock halt bit
+	registers[DS1307_MINUTE_REGISTER] = TO_BCD(datetime->minute) & 0x7F;
+	registers[DS1307_HOUR_REGISTER] = TO_BCD(datetime->hour) & 0x3F; // This also ensures the RTC is in 24-hour mode
+	registers[DS1307_DOW_REGISTER] = datetime->dayOfWeek & 0x07;
+	registers[DS1307_DATE_REGISTER] = TO_BCD(datetime->day) & 0x3F;
+	registers[DS1307_MONTH_REGISTER] = TO_BCD(datetime->month) & 0x1F;
+	registers[DS1307_YEAR_REGISTER] = TO_BCD(datetime->year);
 }
 
-void DS1307_setAllRegisters(uint8_t* registerTable) {	
-	i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_WRITE); // Send a start condition and SLA+W
-	i2c_master_sendByte(0); // Reset the internal memory pointer of the DS1307
+time_t DS1307_toTimestamp(const DS1307_Datetime_t* datetime) {
+	// Every year from 2000 to 2099 divisible by 4 is a leap year,
+	// so the leap days before the year are (year + 3) / 4.
+	uint16_t days = datetime->year * 365 + (datetime->year + 3) / 4
+		+ _DS1307_daysBeforeMonth[(datetime->month - 1) % 12] + datetime->day - 1;
 	
-	// Set all 8 registers of the DS1307
-	for(int i = 0; i < 8; i++) {
-		i2c_master_sendByte(registerTable[i]); // Read one byte from the DS1307
+	// Add the leap day of the current year
+	if(datetime->month > 2 && datetime->year % 4 == 0) {
+		days++;
 	}
 	
-	i2c_master_endFrame(); // Send a stop condition
+	return days * _DS1307_SECONDS_PER_DAY
+		+ datetime->hour * 3600UL + datetime->minute * 60U + datetime->second;
 }
 
-time_t DS1307_getDatetime() {	
-	// Read the values of all 8 registers.
-	uint8_t registers[8];
-	DS1307_getAllRegisters(registers);
+void DS1307_fromTimestamp(time_t time, DS1307_Datetime_t* datetime) {
+	uint16_t days = time / _DS1307_SECONDS_PER_DAY;
+	uint32_t secondOfDay = time % _DS1307_SECONDS_PER_DAY;
 	
-	// Construct a 'struct tm' with the time from the DS1307
-	struct tm currentTime;
-	currentTime.tm_sec = FROM_BCD(registers[DS1307_SECOND_REGISTER] & 0x7F); // Parse the second register value
-	currentTime.tm_min = FROM_BCD(registers[DS1307_MINUTE_REGISTER] & 0x7F); // Parse the minute register value
-	// Parse the hour register value
-	if(CHECKBIT(registers[DS1307_HOUR_REGISTER], 6)) { // Check if 12h is activated
-		// The RTC is in 12h mode
-		currentTime.tm_hour = FROM_BCD(registers[DS1307_HOUR_REGISTER] & 0x1F);
-		
-		if(CHECKBIT(registers[DS1307_HOUR_REGISTER], 5)) { // Check if it's PM
-			// It's PM, add 12 hours
-			currentTime.tm_hour += 12;
+	datetime->hour = secondOfDay / 3600;
+	datetime->minute = (secondOfDay / 60) % 60;
+	datetime->second = secondOfDay % 60;
+	
+	// 2000-01-01 was a saturday, the day of week is 1 (sunday) to 7 (saturday)
+	datetime->dayOfWeek = (days + 6) % 7 + 1;
+	
+	// Find the year, the first year of each 4-year cycle is a leap year
+	uint8_t year = days / _DS1307_DAYS_PER_4_YEARS * 4;
+	days %= _DS1307_DAYS_PER_4_YEARS;
+	bool leapYear = true;
+	if(days >= 366) {
+		days -= 366;
+		year += 1 + days / 365;
+		days %= 365;
+		leapYear = false;
+	}
+	datetime->year = year;
+	
+	// Find the month, skip the leap day
+	if(leapYear && days >= 59) {
+		if(days == 59) {
+			datetime->month = 2;
+			datetime->day = 29;
+			return;
 		}
+		days--;
+	}
+	
+	uint8_t month = 12;
+	while(_DS1307_daysBeforeMonth[month - 1] > days) {
+		month--;
+	}
+	datetime->month = month;
+	datetime->day = days - _DS1307_daysBeforeMonth[month - 1] + 1;
+}
+
+#if DS1307_CACHED_CLOCK
+/**
+ * @brief Concatenates the tokens after expanding them.
+ * 
+ */
+#define _DS1307_CONCAT(a, b, c) _DS1307_CONCAT_(a, b, c)
+#define _DS1307_CONCAT_(a, b, c) a ## b ## c
+
+/**
+ * @brief Interrupt vector of the external interrupt connected to SQW.
+ * 
+ */
+#define _DS1307_SQW_VECT _DS1307_CONCAT(INT, DS1307_SQW_INTERRUPT, _vect)
+
+/**
+ * @brief Locally counted time.
+ * 
+ */
+static volatile time_t _DS1307_cachedTime;
+
+/**
+ * @brief Seconds until the next resynchronization.
+ * 
+ */
+static volatile uint16_t _DS1307_resyncCountdown;
+
+/**
+ * @brief Time registers read by the resynchronization.
+ * 
+ */
+static uint8_t _DS1307_resyncRegisters[_DS1307_TIME_REGISTER_COUNT];
+
+/**
+ * @brief Called from the TWI interrupt when the resynchronization read finished.
+ * 
+ */
+static void _DS1307_resyncFinished(i2c_transaction_t* transaction) {
+	if(transaction->status == I2C_TRANSACTION_DONE) {
+		// The read is started right after the tick, so the read time is still current
+		DS1307_Datetime_t datetime;
+		_DS1307_decodeRegisters(_DS1307_resyncRegisters, &datetime);
+		_DS1307_cachedTime = DS1307_toTimestamp(&datetime);
 	} else {
-		// The RTC is in 24h mode
-		currentTime.tm_hour = FROM_BCD(registers[DS1307_HOUR_REGISTER] & 0x3F);	
+		// Keep counting locally and retry with the next tick
+		_DS1307_resyncCountdown = 1;
+	}
+}
+
+/**
+ * @brief Asynchronous transaction reading the time registers for the resynchronization.
+ * 
+ */
+static i2c_transaction_t _DS1307_resyncTransaction = {
+	.slaveAddress = _DS1307_I2C_ADDR,
+	.useRegisterAddress = true,
+	.registerAddress = DS1307_SECOND_REGISTER,
+	.txData = NULL,
+	.txLength = 0,
+	.rxData = _DS1307_resyncRegisters,
+	.rxLength = _DS1307_TIME_REGISTER_COUNT,
+	.timeout = _DS1307_TIMEOUT(_DS1307_TIME_REGISTER_COUNT),
+	.callback = _DS1307_resyncFinished,
+	.context = NULL,
+	.status = I2C_TRANSACTION_DONE
+};
+
+/**
+ * @brief Counts the seconds on the falling edge of SQW, at which the DS1307 increments its seconds register.
+ * 
+ */
+ISR(_DS1307_SQW_VECT) {
+	_DS1307_cachedTime++;
+	
+	if(--_DS1307_resyncCountdown == 0) {
+		_DS1307_resyncCountdown = DS1307_RESYNC_INTERVAL;
+		
+		// Skip the resynchronization if the previous one is still running
+		if(i2c_master_finished(&_DS1307_resyncTransaction)) {
+			i2c_master_submit(&_DS1307_resyncTransaction);
+		}
+	}
+}
+
+/**
+ * @brief Sets the cached time and restarts the resynchronization interval.
+ * 
+ * @param time The new time.
+ */
+static void _DS1307_setCachedDatetime(time_t time) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_DS1307_cachedTime = time;
+		_DS1307_resyncCountdown = DS1307_RESYNC_INTERVAL;
 	}
+}
+
+time_t DS1307_getCachedDatetime() {
+	time_t time;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		time = _DS1307_cachedTime;
+	}
+	return time;
+}
 
-	// Parse the date register value
-	currentTime.tm_mday = FROM_BCD(registers[DS1307_DATE_REGISTER] & 0x3F);
+void DS1307_requestResync() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_DS1307_resyncCountdown = 1;
+	}
+}
+#endif
+
+void DS1307_init() {
+	// Initialize the required I2C interface
+	i2c_master_setBitrateSetting(I2C_BITRATE_SETTING(DS1307_I2C_BITRATE));
+	i2c_master_enable();
+	
+#if DS1307_CACHED_CLOCK
+	// Enable the 1 Hz square wave output
+	DS1307_setRegister(DS1307_CTRL_REGISTER, _DS1307_CTRL_SQW_1HZ);
+	_DS1307_setCachedDatetime(DS1307_getDatetime());
 	
-	// Parse the month register value
-	// The month range of 'struct tm' is from 0 - 11 instead of 1 - 12
-	currentTime.tm_mon = FROM_BCD(registers[DS1307_MONTH_REGISTER] & 0x1F) - 1;
+	// SQW is an open drain output, enable the pull-up of the interrupt pin
+	CLEARBIT(DDRE, DS1307_SQW_INTERRUPT);
+	SETBIT(PORTE, DS1307_SQW_INTERRUPT);
 	
-	// Parse the year register value
-	// The year range of 'struct tm' begins at 1900, the one of the RTC at 2000
-	currentTime.tm_year = FROM_BCD(registers[DS1307_YEAR_REGISTER] & 0xFF) + 100;
+	// Trigger on the falling edge
+	EICRB = (EICRB & ~(0b11 << ((DS1307_SQW_INTERRUPT - 4) * 2))) | (0b10 << ((DS1307_SQW_INTERRUPT - 4) * 2));
+	
+	// Clear a pending interrupt and enable it
+	EIFR = (1 << DS1307_SQW_INTERRUPT);
+	SETBIT(EIMSK, DS1307_SQW_INTERRUPT);
+#endif
+}
 
-	// These are not needed, but have to be set to 0 for mktime to work right.
-	currentTime.tm_isdst = 0;
-	currentTime.tm_yday = 0;
+uint8_t DS1307_getRegister(DS1307Register_t reg) {
+	uint8_t registerValue;
+	i2c_master_readRegisters(_DS1307_I2C_ADDR, reg, &registerValue, 1);
 	
-	// Convert the 'struct tm' to timestamp as specified in the documentation of `time_t`.
-	time_t time = mktime(&currentTime);
-	return time;
+	return registerValue;
 }
 
-void DS1307_setDatetime(time_t time) {
-	// Get a 'struct tm' from the given timestamp
-	struct tm datetime;
-	gmtime_r(&time, &datetime);
+void DS1307_getAllRegisters(uint8_t* registerTable) {
+	// Read all 8 registers from the DS1307 in one burst
+	i2c_master_readRegisters(_DS1307_I2C_ADDR, 0, registerTable, 8);
+}
+
+void DS1307_setRegister(DS1307Register_t reg, uint8_t data) {
+	i2c_master_writeRegisters(_DS1307_I2C_ADDR, reg, &data, 1);
+}
+
+void DS1307_setAllRegisters(uint8_t* registerTable) {
+	// Set all 8 registers of the DS1307 in one burst
+	i2c_master_writeRegisters(_DS1307_I2C_ADDR, 0, registerTable, 8);
+}
+
+void DS1307_getDatetimeFields(DS1307_Datetime_t* datetime) {
+	// Read the values of all time registers.
+	uint8_t registers[_DS1307_TIME_REGISTER_COUNT];
+	i2c_master_readRegisters(_DS1307_I2C_ADDR, DS1307_SECOND_REGISTER, registers, _DS1307_TIME_REGISTER_COUNT);
 	
-	// Convert all the values to BCD for the DS1307
-	uint8_t registers[8];
-	registers[DS1307_SECOND_REGISTER] = TO_BCD(datetime.tm_sec) & 0x7F;
+	_DS1307_decodeRegisters(registers, datetime);
+}
+
+void DS1307_setDatetimeFields(const DS1307_Datetime_t* datetime) {
+	// Write the time registers only, the control register is left untouched
+	uint8_t registers[_DS1307_TIME_REGISTER_COUNT];
+	_DS1307_encodeRegisters(datetime, registers);
+	i2c_master_writeRegisters(_DS1307_I2C_ADDR, DS1307_SECOND_REGISTER, registers, _DS1307_TIME_REGISTER_COUNT);
 	
-	registers[DS1307_MINUTE_REGISTER] = TO_BCD(datetime.tm_min) & 0x7F;
+#if DS1307_CACHED_CLOCK
+	_DS1307_setCachedDatetime(DS1307_toTimestamp(datetime));
+#endif
+}
+
+time_t DS1307_getDatetime() {
+	PROFILE_BEGIN(PROFILE_DS1307_GET_DATETIME);
+	DS1307_Datetime_t datetime;
+	DS1307_getDatetimeFields(&datetime);
 	
-	// This also ensures the RTC is in 24-hour mode
-	registers[DS1307_HOUR_REGISTER] = TO_BCD(datetime.tm_hour) & 0x3F;
+	time_t time = DS1307_toTimestamp(&datetime);
+	PROFILE_END(PROFILE_DS1307_GET_DATETIME);
+	return time;
+}
+
+void DS1307_setDatetime(time_t time) {
+	DS1307_Datetime_t datetime;
+	DS1307_fromTimestamp(time, &datetime);
 	
-	registers[DS1307_DATE_REGISTER] =  TO_BCD(datetime.tm_mday) & 0x3F;
+	DS1307_setDatetimeFields(&datetime);
+}
+
+/**
+ * @brief Checks that the given block lies within the battery-backed RAM.
+ * 
+ * @exception ERR_OUT_OF_RANGE The block exceeds the RAM size.
+ */
+static inline void _DS1307_assertRAMRange(uint8_t offset, uint8_t n) {
+	assertMessage(offset <= DS1307_RAM_SIZE && n <= DS1307_RAM_SIZE - offset, ERR_OUT_OF_RANGE, "DS1307: RAM block out of range.");
+}
+
+void DS1307_readRAM(uint8_t offset, uint8_t* dst, uint8_t n) {
+	_DS1307_assertRAMRange(offset, n);
 	
-	// The week day range of 'struct tm' begins at 0, hence the +1
-	registers[DS1307_DOW_REGISTER] =  TO_BCD(datetime.tm_wday + 1) & 0x3F;
+	i2c_transaction_t transaction = I2C_REGISTER_TRANSACTION(_DS1307_I2C_ADDR, _DS1307_RAM_ADDR + offset, NULL, 0, dst, n);
+	transaction.timeout = _DS1307_TIMEOUT(n);
+	i2c_master_execute(&transaction);
+}
+
+void DS1307_writeRAM(uint8_t offset, const uint8_t* src, uint8_t n) {
+	_DS1307_assertRAMRange(offset, n);
 	
-	// The month range of 'struct tm' begins at 0, hence the +1
-	registers[DS1307_MONTH_REGISTER] =  TO_BCD(datetime.tm_mon + 1) & 0x3F;
+	i2c_transaction_t transaction = I2C_REGISTER_TRANSACTION(_DS1307_I2C_ADDR, _DS1307_RAM_ADDR + offset, src, n, NULL, 0);
+	transaction.timeout = _DS1307_TIMEOUT(n);
+	i2c_master_execute(&transaction);
+}
+
+void DS1307_writeRAMPolled(uint8_t offset, const uint8_t* src, uint8_t n) {
+	_DS1307_assertRAMRange(offset, n);
 	
-	// The year range of 'struct tm' begins with the year 1900, hence the -100
-	registers[DS1307_YEAR_REGISTER] =  TO_BCD(datetime.tm_year - 100);
+	Error_t error;
+	try {
+		i2c_master_startFrame(_DS1307_I2C_ADDR, I2C_WRITE);
+		i2c_master_sendByte(_DS1307_RAM_ADDR + offset);
+		for(uint8_t i = 0; i < n; i++) {
+			i2c_master_sendByte(src[i]);
+		}
+	} catchError(error) {
+		// Release the bus, so the queued transactions can start
+		i2c_master_endFrame();
+		error_rethrow(error);
+	}
+	i2c_master_endFrame();
+}
+
+void DS1307_readRAMAsync(i2c_transaction_t* transaction, uint8_t offset, uint8_t* dst, uint8_t n) {
+	_DS1307_assertRAMRange(offset, n);
 	
-	// Don't change the control register
-	registers[DS1307_CTRL_REGISTER] = DS1307_getRegister(DS1307_CTRL_REGISTER);
+	transaction->slaveAddress = _DS1307_I2C_ADDR;
+	transaction->useRegisterAddress = true;
+	transaction->registerAddress = _DS1307_RAM_ADDR + offset;
+	transaction->txData = NULL;
+	transaction->txLength = 0;
+	transaction->rxData = dst;
+	transaction->rxLength = n;
+	transaction->timeout = _DS1307_TIMEOUT(n);
+	i2c_master_submit(transaction);
+}
+
+void DS1307_writeRAMAsync(i2c_transaction_t* transaction, uint8_t offset, const uint8_t* src, uint8_t n) {
+	_DS1307_assertRAMRange(offset, n);
 	
-	// Write the values to the RTC
-	DS1307_setAllRegisters(registers);
-}
\ No newline at end of file
+	transaction->slaveAddress = _DS1307_I2C_ADDR;
+	transaction->useRegisterAddress = true;
+	transaction->registerAddress = _DS1307_RAM_ADDR + offset;
+	transaction->txData = src;
+	transaction->txLength = n;
+	transaction->rxData = NULL;
+	transaction->rxLength = 0;
+	transaction->timeout = _DS1307_TIMEOUT(n);
+	i2c_master_submit(transaction);
+}
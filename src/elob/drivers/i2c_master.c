@@ -6,14 +6,31 @@
 #include <elob/drivers/i2c_master.h>
 #include <elob/util/error.h>
 #include <elob/util/binary.h>
+#include <elob/util/profile.h>
+#include <elob/util/scheduler.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/delay.h>
+#include <util/atomic.h>
+
+/**
+ * @brief Polling interval in microseconds used by the bounded waits.
+ * 
+ */
+#define _I2C_POLL_INTERVAL_US 10
+
+/**
+ * @brief Number of polling intervals per millisecond.
+ * 
+ */
+#define _I2C_POLLS_PER_MS (1000 / _I2C_POLL_INTERVAL_US)
 
 /**
  * @brief Waits for the TWINT (TWI Interrupt flag) bit in the TWCR register to be set.
+ * Can only be used in @ref ELOB_STATUS functions, as it returns the timeout error.
  * 
  */
-#define _TWINT_AWAIT while(!CHECKBIT(TWCR, TWINT));
+#define _TWINT_AWAIT ELOB_CHECK(_i2c_master_awaitInterruptFlag());
 
 /**
  * @brief Resets the TWINT bit in the TWCR register.
@@ -27,30 +44,356 @@
  */
 #define _TWINT_RESET_AWAIT _TWINT_RESET; _TWINT_AWAIT;
 
-void i2c_master_setBitrate(uint32_t bitrate) {
-	const uint8_t prescalers[] = { 1, 4, 16, 64 };
+/**
+ * @brief TWCR value continuing the transmission with the interrupt enabled.
+ * 
+ */
+#define _TWCR_CONTINUE ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+
+/**
+ * @brief The transaction currently being executed on the bus, `NULL` if the engine is idle.
+ * 
+ */
+static i2c_transaction_t* volatile _i2c_activeTransaction = NULL;
+
+/**
+ * @brief The last transaction in the queue, `NULL` if the queue is empty.
+ * The queue is linked through @ref i2c_transaction_t::_next, starting at @ref _i2c_activeTransaction.
+ * 
+ */
+static i2c_transaction_t* volatile _i2c_lastTransaction = NULL;
+
+/**
+ * @brief Whether a frame started with @ref i2c_master_startFrame owns the bus. Transactions are only
+ * queued meanwhile, @ref i2c_master_endFrame starts them.
+ * 
+ */
+static volatile bool _i2c_busOwned = false;
+
+/**
+ * @brief Waits until the asynchronous engine released the bus. Queued transactions which
+ * exceed their timeout are aborted.
+ */
+static void _i2c_master_awaitIdle() {
+	while(_i2c_activeTransaction != NULL) {
+		i2c_master_wait(_i2c_activeTransaction);
+	}
+}
+
+/**
+ * @brief Starts the transaction at the head of the queue, if there is one.
+ * Must be called with interrupts disabled or from the TWI interrupt.
+ * 
+ * @param stop Whether a stop condition has to be generated before the start condition.
+ */
+static inline void _i2c_master_startNext(bool stop) {
+	i2c_transaction_t* transaction = _i2c_activeTransaction;
+	
+	// A polled frame owns the bus, the queue is started when it ends
+	if(_i2c_busOwned) return;
+	
+	if(transaction == NULL) {
+		// Release the bus and disable the interrupt
+		TWCR = (1 << TWINT) | (1 << TWEN) | (stop ? (1 << TWSTO) : 0);
+		return;
+	}
+	
+	transaction->_index = 0;
+	transaction->_reading = false;
+	transaction->_remainingTime = transaction->timeout;
+	transaction->status = I2C_TRANSACTION_ACTIVE;
+	
+	// If needed, the hardware generates the stop condition before the start condition
+	TWCR = _TWCR_CONTINUE | (1 << TWSTA) | (stop ? (1 << TWSTO) : 0);
+}
+
+/**
+ * @brief Finishes the active transaction with the given status and starts the next one.
+ * Must be called with interrupts disabled or from the TWI interrupt.
+ * 
+ * @param status The final status of the active transaction.
+ * @param stop Whether the bus is currently owned and a stop condition has to be generated.
+ */
+static void _i2c_master_finish(i2c_transactionStatus_t status, bool stop) {
+	i2c_transaction_t* transaction = _i2c_activeTransaction;
+	
+	// Dequeue the transaction
+	_i2c_activeTransaction = transaction->_next;
+	if(_i2c_activeTransaction == NULL) {
+		_i2c_lastTransaction = NULL;
+	}
+	
+	if(status == I2C_TRANSACTION_TIMEOUT && !_i2c_busOwned) {
+		// Clearing TWEN aborts the transmission and releases a stuck bus, so the next transaction can start
+		i2c_master_disable();
+		i2c_master_enable();
+		stop = false;
+	}
+	_i2c_master_startNext(stop);
+	
+	transaction->status = status;
+	if(transaction->callback != NULL) {
+		transaction->callback(transaction);
+	}
+	_SCHEDULER_SIGNAL(SCHEDULER_EVENT_I2C);
+}
+
+/**
+ * @brief Waits until the asynchronous engine is idle and marks the bus as owned by a polled frame.
+ * 
+ */
+static void _i2c_master_acquireBus() {
+	while(!_i2c_busOwned) {
+		_i2c_master_awaitIdle();
+		
+		// A transaction may have been submitted by an interrupt in the meantime
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			if(_i2c_activeTransaction == NULL) {
+				_i2c_busOwned = true;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Releases the bus owned by a polled frame and starts the queued transactions.
+ * 
+ * @param stop Whether a stop condition has to be generated.
+ */
+static void _i2c_master_releaseBus(bool stop) {
+	// Without a frame, the engine may own the bus
+	if(!_i2c_busOwned) return;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_i2c_busOwned = false;
+		_i2c_master_startNext(stop);
+	}
+}
+
+/**
+ * @brief Advances the active transaction after the TWINT flag was set.
+ * Called by the TWI interrupt, or by @ref i2c_master_wait while interrupts are disabled.
+ * 
+ */
+static inline void _i2c_master_advance() {
+	i2c_transaction_t* transaction = _i2c_activeTransaction;
+	i2c_masterStatus_t status = TWSR & 0xF8;
+	
+	if(transaction == NULL) {
+		// Should not happen, release the bus
+		TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+		return;
+	}
+	
+	switch(status) {
+		case I2C_MASTER_START_CONDITION_TRANSMITTED:
+		case I2C_MASTER_REAPEATED_START_CONDITION_TRANSMITTED:
+			// Address the slave for writing first if there is data to write
+			if(!transaction->_reading && (transaction->useRegisterAddress || transaction->txLength > 0 || transaction->rxLength == 0)) {
+				TWDR = transaction->slaveAddress << 1 | I2C_WRITE;
+			} else {
+				transaction->_index = 0;
+				transaction->_reading = true;
+				TWDR = transaction->slaveAddress << 1 | I2C_READ;
+			}
+			TWCR = _TWCR_CONTINUE;
+			break;
+		
+		case I2C_MASTER_SLAW_ACK:
+			// The register address is sent directly after SLA+W
+			if(transaction->useRegisterAddress) {
+				TWDR = transaction->registerAddress;
+				TWCR = _TWCR_CONTINUE;
+				break;
+			}
+			// fall through
+		case I2C_MASTER_DATA_SENT_ACK:
+			if(transaction->_index < transaction->txLength) {
+				TWDR = transaction->txData[transaction->_index++];
+				TWCR = _TWCR_CONTINUE;
+			} else if(transaction->rxLength > 0) {
+				// Switch to reading using a repeated start condition
+				transaction->_reading = true;
+				TWCR = _TWCR_CONTINUE | (1 << TWSTA);
+			} else {
+				_i2c_master_finish(I2C_TRANSACTION_DONE, true);
+			}
+			break;
+		
+		case I2C_MASTER_DATA_RECEIVED_ACK:
+			transaction->rxData[transaction->_index++] = TWDR;
+			// fall through
+		case I2C_MASTER_SLAR_ACK:
+			// Acknowledge all bytes except for the last one
+			TWCR = _TWCR_CONTINUE | (transaction->_index + 1 < transaction->rxLength ? (1 << TWEA) : 0);
+			break;
+		
+		case I2C_MASTER_DATA_RECEIVED_NACK:
+			transaction->rxData[transaction->_index++] = TWDR;
+			_i2c_master_finish(I2C_TRANSACTION_DONE, true);
+			break;
+		
+		case I2C_MASTER_SLAW_NACK:
+		case I2C_MASTER_SLAR_NACK:
+		case I2C_MASTER_DATA_SENT_NACK:
+			_i2c_master_finish(I2C_TRANSACTION_NACK, true);
+			break;
+		
+		case I2C_MASTER_ARBITRATION_LOST:
+			// The bus is not owned anymore, so no stop condition must be generated
+			_i2c_master_finish(I2C_TRANSACTION_ERROR, false);
+			break;
 		
-	float twbrValue = UINT8_MAX + 1;
-	uint8_t prescalerID;
+		default:
+			// Bus error or unexpected status
+			_i2c_master_finish(I2C_TRANSACTION_ERROR, true);
+			break;
+	}
+}
+
+/**
+ * @brief Interrupt service routine advancing the active transaction.
+ * 
+ */
+ISR(TWI_vect) {
+	_i2c_master_advance();
+}
+
+void i2c_master_setBitrate(uint32_t bitrate) {
+	if(!I2C_BITRATE_REACHABLE(bitrate)) {
+		// Even the biggest prescaler does not allow the bitrate to fit into TWBR
+		// (or the bitrate is faster than the hardware allows)
+		throwMessage(ERR_BITRATE_TOO_LOW, "i2c_master_setBitrate: Bitrate too low.");
+	}
+	
+	// Integer calculation of the prescaler (as small as possible, but as big as needed) and TWBR
+	i2c_master_setBitrateSetting(I2C_BITRATE_SETTING_UNCHECKED(bitrate));
+}
+
+void i2c_master_setBitrateSetting(i2c_bitrateSetting_t setting) {
+	// Write the values to the registers, the status bits of TWSR are read-only
+	TWBR = setting & 0xFF;
+	TWSR = (setting >> 8) & ((1 << TWPS0) | (1 << TWPS1));
+}
+
+void i2c_master_submit(i2c_transaction_t* transaction) {
+	transaction->status = I2C_TRANSACTION_PENDING;
+	transaction->_next = NULL;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(_i2c_lastTransaction == NULL) {
+			// The engine is idle, start immediately
+			_i2c_activeTransaction = transaction;
+			_i2c_lastTransaction = transaction;
+			_i2c_master_startNext(false);
+		} else {
+			_i2c_lastTransaction->_next = transaction;
+			_i2c_lastTransaction = transaction;
+		}
+	}
+}
+
+bool i2c_master_busy() {
+	return _i2c_activeTransaction != NULL;
+}
+
+bool i2c_master_finished(i2c_transaction_t* transaction) {
+	return transaction->status >= I2C_TRANSACTION_DONE;
+}
+
+i2c_transactionStatus_t i2c_master_wait(i2c_transaction_t* transaction) {
+	// Enforce the timeout of whichever transaction occupies the bus,
+	// so a stuck transaction queued before this one cannot block forever.
+	i2c_transaction_t* observed = NULL;
+	uint16_t remainingTime = 0;
+	uint8_t polls = 0;
+	
+	while(!i2c_master_finished(transaction)) {
+		if(!CHECKBIT(SREG, SREG_I) && !_i2c_busOwned && CHECKBIT(TWCR, TWINT)) {
+			// The TWI interrupt can't run, so drive the engine by polling
+			_i2c_master_advance();
+			continue;
+		}
+		_delay_us(_I2C_POLL_INTERVAL_US);
 		
-	// Calculate the appropriate prescaler for the specified bitrate
-	//  (prescaler as small as possible, but as big as needed)
-
-	// Iterate until the calculated value fits into TWBR
-	for(prescalerID = 0; twbrValue > UINT8_MAX; prescalerID++) {
-		if(prescalerID >= sizeof(prescalers) / sizeof(*prescalers)) {
-			// The biggest prescaler was already selected and yet, twbrValue did still not fit into 1 byte
-			// Therefore, the specified bitrate is too low.
-			throwMessage(ERR_BITRATE_TOO_LOW, "i2c_master_setBitrate: Bitrate too low.");
+		if(++polls < _I2C_POLLS_PER_MS) {
+			continue;
 		}
+		polls = 0;
 		
-		// Calculate the TWBR value for the specified bitrate and currently selected prescaler
-		twbrValue = ((float)F_CPU / (float)bitrate - 16.0) / ((float)(pow(4, prescalers[prescalerID])) * 2.0);
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			i2c_transaction_t* active = _i2c_activeTransaction;
+			if(active != observed) {
+				observed = active;
+				remainingTime = active != NULL ? active->timeout : 0;
+			} else if(active != NULL) {
+				if(remainingTime == 0) {
+					_i2c_master_finish(I2C_TRANSACTION_TIMEOUT, true);
+				} else {
+					remainingTime--;
+				}
+			}
+		}
 	}
 	
-	// Write the calculated values to the registers
-	TWBR = twbrValue;
-	TWSR = (TWPS0 | TWPS1) & prescalerID;
+	return transaction->status;
+}
+
+void i2c_master_tick() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		i2c_transaction_t* transaction = _i2c_activeTransaction;
+		// The transaction hasn't started yet while a polled frame owns the bus
+		if(transaction != NULL && !_i2c_busOwned) {
+			if(transaction->_remainingTime == 0) {
+				_i2c_master_finish(I2C_TRANSACTION_TIMEOUT, true);
+			} else {
+				transaction->_remainingTime--;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Submits the given transaction and waits for it to finish.
+ * 
+ * @param transaction The transaction to execute.
+ * @return The error of the transaction, `ERR_NONE` on success.
+ */
+static ELOB_STATUS _i2c_master_execute(i2c_transaction_t* transaction) {
+	PROFILE_BEGIN(PROFILE_I2C_TRANSACTION);
+	i2c_master_submit(transaction);
+	i2c_transactionStatus_t status = i2c_master_wait(transaction);
+	PROFILE_END(PROFILE_I2C_TRANSACTION);
+	
+	switch(status) {
+		case I2C_TRANSACTION_DONE:
+			return ERR_NONE;
+		case I2C_TRANSACTION_TIMEOUT:
+			ELOB_RAISE(ERR_I2C_TIMEOUT, "i2c_master: Transaction timed out.");
+		case I2C_TRANSACTION_NACK:
+			ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master: NACK received.");
+		default:
+			ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master: Transmission error.");
+	}
+}
+
+void i2c_master_transfer(uint8_t slaveAddress, const uint8_t* txData, uint8_t txLength, uint8_t* rxData, uint8_t rxLength) {
+	i2c_transaction_t transaction = I2C_TRANSACTION(slaveAddress, txData, txLength, rxData, rxLength);
+	ELOB_THROW_ON_ERROR(_i2c_master_execute(&transaction));
+}
+
+void i2c_master_execute(i2c_transaction_t* transaction) {
+	ELOB_THROW_ON_ERROR(_i2c_master_execute(transaction));
+}
+
+void i2c_master_readRegisters(uint8_t slaveAddress, uint8_t registerAddress, uint8_t* dst, uint8_t n) {
+	i2c_transaction_t transaction = I2C_REGISTER_TRANSACTION(slaveAddress, registerAddress, NULL, 0, dst, n);
+	ELOB_THROW_ON_ERROR(_i2c_master_execute(&transaction));
+}
+
+void i2c_master_writeRegisters(uint8_t slaveAddress, uint8_t registerAddress, const uint8_t* src, uint8_t n) {
+	i2c_transaction_t transaction = I2C_REGISTER_TRANSACTION(slaveAddress, registerAddress, src, n, NULL, 0);
+	ELOB_THROW_ON_ERROR(_i2c_master_execute(&transaction));
 }
 
 void i2c_master_enable() {
@@ -67,42 +410,73 @@ void i2c_master_disable() {
 	CLEARBIT(TWCR, TWEN);
 }
 
-i2c_masterStatus_t i2c_master_checkStatus() {
-	i2c_masterStatus_t status = TWSR & 0xF8;
-	if(status == I2C_BUS_ERROR) {
-		throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_checkStatus: Bus error reported.");
+/**
+ * @brief Waits for the TWINT bit to be set, but at most @ref I2C_MASTER_TIMEOUT milliseconds.
+ * On a timeout, the TWI interface is reset, so a stuck transmission doesn't block the next one.
+ * 
+ * @return `ERR_I2C_TIMEOUT` if the flag was not set in time, otherwise `ERR_NONE`.
+ */
+static ELOB_STATUS _i2c_master_awaitInterruptFlag() {
+	for(uint32_t polls = 0; !CHECKBIT(TWCR, TWINT); polls++) {
+		if(polls >= (uint32_t)I2C_MASTER_TIMEOUT * _I2C_POLLS_PER_MS) {
+			// Clearing TWEN aborts the transmission and releases the bus
+			i2c_master_disable();
+			i2c_master_enable();
+			_i2c_master_releaseBus(false);
+			ELOB_RAISE(ERR_I2C_TIMEOUT, "i2c_master: Timed out waiting for the bus.");
+		}
+		_delay_us(_I2C_POLL_INTERVAL_US);
+	}
+	return ERR_NONE;
+}
+
+/**
+ * @brief Reads the status code of the hardware TWI interface.
+ * 
+ * @param status Target for the status code.
+ * @return `ERR_I2C_TRANSMISSION` on a bus error or write collision, otherwise `ERR_NONE`.
+ */
+static ELOB_STATUS _i2c_master_checkStatus(i2c_masterStatus_t* status) {
+	*status = TWSR & 0xF8;
+	if(*status == I2C_BUS_ERROR) {
+		ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_checkStatus: Bus error reported.");
 	} else if(CHECKBIT(TWCR, TWWC)) {
-		throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_checkStatus: Write collision detected.");
+		ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_checkStatus: Write collision detected.");
 	}
-	
-	return status;
+	return ERR_NONE;
 }
 
-void i2c_master_sendByte(uint8_t data) {
+static ELOB_STATUS _i2c_master_sendByte(uint8_t data) {
 	// Put the byte into the data register and
 	// wait for it to be sent
 	TWDR = data;
 	_TWINT_RESET_AWAIT;
 
-	i2c_masterStatus_t status = i2c_master_checkStatus();
+	i2c_masterStatus_t status;
+	ELOB_CHECK(_i2c_master_checkStatus(&status));
 	if(status != I2C_MASTER_DATA_SENT_ACK) {
 		if(status == I2C_MASTER_DATA_SENT_NACK) { // A NACK has been received
-			throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_sendByte: Data sent, NACK received.");
+			ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_sendByte: Data sent, NACK received.");
 		} else { // An unexpected status code was indicated by the hardware TWI interface
-			throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_sendByte: Data sent, status invalid.");
+			ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_sendByte: Data sent, status invalid.");
 		}
 	}
+	return ERR_NONE;
 }
 
-void i2c_master_startFrame(uint8_t slaveAddress, i2c_communicationDirection_t direction) {
+static ELOB_STATUS _i2c_master_startFrame(uint8_t slaveAddress, i2c_communicationDirection_t direction) {
+	// Do not interfere with background transactions, a repeated start keeps the bus
+	_i2c_master_acquireBus();
+	
 	SETBIT(TWCR, TWSTA); // Generate a start condition
 	
 	// Wait for the start condition to be generated successfully
 	_TWINT_RESET_AWAIT;
-	i2c_masterStatus_t status = i2c_master_checkStatus();
+	i2c_masterStatus_t status;
+	ELOB_CHECK(_i2c_master_checkStatus(&status));
 	if(status != I2C_MASTER_START_CONDITION_TRANSMITTED && status != I2C_MASTER_REAPEATED_START_CONDITION_TRANSMITTED) {
 		// An unexpected status code was indicated by the hardware TWI interface
-		throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_startFrame: Failed to generate start condition.");
+		ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_startFrame: Failed to generate start condition.");
 	}
 	
 	// Send the address and RW byte
@@ -114,31 +488,53 @@ void i2c_master_startFrame(uint8_t slaveAddress, i2c_communicationDirection_t di
 	
 	// Wait for the byte to be sent successfully
 	_TWINT_RESET_AWAIT;
-	status = i2c_master_checkStatus();
+	ELOB_CHECK(_i2c_master_checkStatus(&status));
 	if(status != I2C_MASTER_SLAR_ACK && status != I2C_MASTER_SLAW_ACK) {
 		// An unexpected status code was indicated by the hardware TWI interface
-		throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_startFrame: Failed to send SLA+R/W.");
+		ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_startFrame: Failed to send SLA+R/W.");
 	}
+	return ERR_NONE;
 }
 
-uint8_t i2c_master_readByte(i2c_ackType_t ackType) {
+static ELOB_STATUS _i2c_master_readByte(i2c_ackType_t ackType, uint8_t* data) {
 	// Set the specified acknowledgement type for the TWI
 	WRITEBIT(TWCR, TWEA, ackType);
 	
 	// Start receiving the byte by clearing the TWINT bit
 	// and wait for the transmission to be finished.
 	_TWINT_RESET_AWAIT;
-	uint8_t data = TWDR; // Initiate the transmission
+	*data = TWDR; // Initiate the transmission
 	
-	i2c_masterStatus_t status = i2c_master_checkStatus();
+	i2c_masterStatus_t status;
+	ELOB_CHECK(_i2c_master_checkStatus(&status));
 	if(status != I2C_MASTER_DATA_RECEIVED_ACK && status != I2C_MASTER_DATA_RECEIVED_NACK) {
 		// An unexpected status code was indicated by the hardware TWI interface
-		throwMessage(ERR_I2C_TRANSMISSION, "i2c_master_readByte: Failed to read message from I2C.");
+		ELOB_RAISE(ERR_I2C_TRANSMISSION, "i2c_master_readByte: Failed to read message from I2C.");
 	}
-	
+	return ERR_NONE;
+}
+
+i2c_masterStatus_t i2c_master_checkStatus() {
+	i2c_masterStatus_t status;
+	ELOB_THROW_ON_ERROR(_i2c_master_checkStatus(&status));
+	return status;
+}
+
+void i2c_master_sendByte(uint8_t data) {
+	ELOB_THROW_ON_ERROR(_i2c_master_sendByte(data));
+}
+
+void i2c_master_startFrame(uint8_t slaveAddress, i2c_communicationDirection_t direction) {
+	ELOB_THROW_ON_ERROR(_i2c_master_startFrame(slaveAddress, direction));
+}
+
+uint8_t i2c_master_readByte(i2c_ackType_t ackType) {
+	uint8_t data;
+	ELOB_THROW_ON_ERROR(_i2c_master_readByte(ackType, &data));
 	return data;
 }
 
 void i2c_master_endFrame() {
-	SETBIT(TWCR, TWSTO); // Generate a stop condition
+	// Generate a stop condition, followed by the start condition of the next queued transaction
+	_i2c_master_releaseBus(true);
 }
\ No newline at end of file
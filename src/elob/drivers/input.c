@@ -0,0 +1,200 @@
+/**
+ * @file input.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref input.h.
+ */
+#include <elob/drivers/input.h>
+#include <elob/elob.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <string.h>
+
+#if INPUT_ENABLED
+/**
+ * @brief Timer compare value for the sample period at a prescaler of 1024.
+ * 
+ */
+#define _INPUT_COMPARE_VALUE ((F_CPU / 1024UL * INPUT_SAMPLE_PERIOD + 500) / 1000 - 1)
+
+#if _INPUT_COMPARE_VALUE > 255
+#error "INPUT_SAMPLE_PERIOD is too long for an 8-bit timer at this F_CPU."
+#endif
+
+#if INPUT_TIMER == 0
+#define _INPUT_TCCRA TCCR0A
+#define _INPUT_TCCRB TCCR0B
+#define _INPUT_OCRA OCR0A
+#define _INPUT_TIMSK TIMSK0
+#define _INPUT_CTC_MODE (1 << WGM01)
+#define _INPUT_CLOCK_SELECT ((1 << CS02) | (1 << CS00))
+#define _INPUT_INTERRUPT_ENABLE (1 << OCIE0A)
+#define _INPUT_TIMER_VECT TIMER0_COMPA_vect
+#elif INPUT_TIMER == 2
+#define _INPUT_TCCRA TCCR2A
+#define _INPUT_TCCRB TCCR2B
+#define _INPUT_OCRA OCR2A
+#define _INPUT_TIMSK TIMSK2
+#define _INPUT_CTC_MODE (1 << WGM21)
+#define _INPUT_CLOCK_SELECT ((1 << CS22) | (1 << CS21) | (1 << CS20))
+#define _INPUT_INTERRUPT_ENABLE (1 << OCIE2A)
+#define _INPUT_TIMER_VECT TIMER2_COMPA_vect
+#else
+#error "INPUT_TIMER has to be 0 or 2."
+#endif
+
+/**
+ * @brief Reads the level of the switches, with a 1 for every active switch.
+ * 
+ */
+#define _INPUT_READ_SWITCHES() (PINC ^ (INPUT_SWITCHES_ACTIVE_LOW ? 0xFF : 0x00))
+
+/**
+ * @brief Reads the level of the buttons, with a 1 for every active button.
+ * 
+ */
+#define _INPUT_READ_BUTTONS() (PINJ ^ (INPUT_BUTTONS_ACTIVE_LOW ? 0xFF : 0x00))
+
+/**
+ * @brief Position of the port in a queued event. The bit of the input is stored in the lowest three bits.
+ * 
+ */
+#define _INPUT_EVENT_PORT_SHIFT 3
+
+/**
+ * @brief Flag of a queued event which is a press.
+ * 
+ */
+#define _INPUT_EVENT_PRESSED (1 << 7)
+
+volatile uint8_t _input_states[INPUT_PORTS];
+
+/**
+ * @brief Lower bits of the vertical counters, one counter per input.
+ * 
+ */
+static uint8_t _input_count0[INPUT_PORTS];
+
+/**
+ * @brief Upper bits of the vertical counters, one counter per input.
+ * 
+ */
+static uint8_t _input_count1[INPUT_PORTS];
+
+/**
+ * @brief Storage of the event queue.
+ * 
+ */
+static uint8_t _input_eventStorage[INPUT_EVENT_QUEUE_SIZE];
+
+/**
+ * @brief The event queue, filled by the timer interrupt.
+ * 
+ */
+static Buffer_t _input_events = BUFFER_INITIALIZER(_input_eventStorage, INPUT_EVENT_QUEUE_SIZE);
+
+/**
+ * @brief Number of events dropped because the queue was full, saturating at 255.
+ * 
+ */
+static volatile uint8_t _input_dropped = 0;
+
+/**
+ * @brief Queues an event for every input whose stable state changed.
+ * 
+ * @param port The port of the inputs.
+ * @param changed The inputs whose stable state changed.
+ * @param state The new stable state of the port.
+ */
+static void _input_queueEvents(Input_Port_t port, uint8_t changed, uint8_t state) {
+	for(uint8_t bit = 0; changed != 0; bit++, changed >>= 1, state >>= 1) {
+		if(!(changed & 1)) continue;
+		
+		uint8_t event = (port << _INPUT_EVENT_PORT_SHIFT) | bit | ((state & 1) ? _INPUT_EVENT_PRESSED : 0);
+		if(!buffer_tryPut(&_input_events, event) && _input_dropped < UINT8_MAX) {
+			_input_dropped++;
+		}
+	}
+	_SCHEDULER_SIGNAL(SCHEDULER_EVENT_INPUT);
+}
+
+/**
+ * @brief Debounces a sample of all inputs of a port.
+ * 
+ * Every input has a two-bit counter, stored in the same bit of @ref _input_count1 and @ref _input_count0.
+ * It counts down while the sample differs from the stable state and is reset to 3 otherwise, and the
+ * stable state toggles when it wraps around after 4 differing samples.
+ * 
+ * @param port The port.
+ * @param level The sampled level, with a 1 for every active input.
+ */
+static inline void _input_sample(Input_Port_t port, uint8_t level) {
+	uint8_t state = _input_states[port];
+	uint8_t changed = state ^ level;
+	
+	uint8_t count0 = ~(_input_count0[port] & changed);
+	uint8_t count1 = count0 ^ (_input_count1[port] & changed);
+	_input_count0[port] = count0;
+	_input_count1[port] = count1;
+	
+	changed &= count0 & count1;
+	if(changed == 0) return;
+	
+	state ^= changed;
+	_input_states[port] = state;
+	_input_queueEvents(port, changed, state);
+}
+
+/**
+ * @brief Interrupt service routine of the sample timer.
+ * 
+ */
+ISR(_INPUT_TIMER_VECT) {
+	_input_sample(INPUT_SWITCHES, _INPUT_READ_SWITCHES());
+	_input_sample(INPUT_BUTTONS, _INPUT_READ_BUTTONS());
+}
+
+void input_init() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_input_states[INPUT_SWITCHES] = _INPUT_READ_SWITCHES();
+		_input_states[INPUT_BUTTONS] = _INPUT_READ_BUTTONS();
+		// Counters at 3, so a change has to be sampled 4 times
+		memset(_input_count0, 0xFF, sizeof(_input_count0));
+		memset(_input_count1, 0xFF, sizeof(_input_count1));
+		buffer_clear(&_input_events);
+		_input_dropped = 0;
+		
+		// CTC mode at F_CPU / 1024, interrupt on compare match
+		_INPUT_TCCRA = _INPUT_CTC_MODE;
+		_INPUT_OCRA = _INPUT_COMPARE_VALUE;
+		_INPUT_TCCRB = _INPUT_CLOCK_SELECT;
+		_INPUT_TIMSK |= _INPUT_INTERRUPT_ENABLE;
+	}
+}
+
+bool input_getEvent(InputEvent_t* event) {
+	if(buffer_empty(&_input_events)) return false;
+	
+	uint8_t data = buffer_get(&_input_events);
+	event->port = (data >> _INPUT_EVENT_PORT_SHIFT) & 1;
+	event->bit = data & 0x07;
+	event->pressed = (data & _INPUT_EVENT_PRESSED) != 0;
+	return true;
+}
+
+void input_clearEvents() {
+	// The timer interrupt writes to the queue as well
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		buffer_clear(&_input_events);
+	}
+}
+
+uint8_t input_droppedEvents() {
+	uint8_t dropped;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		dropped = _input_dropped;
+		_input_dropped = 0;
+	}
+	return dropped;
+}
+#endif
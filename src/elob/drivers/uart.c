@@ -7,85 +7,801 @@
 #include <elob/util/error.h>
 #include <elob/util/binary.h>
 #include <elob/util/buffer.h>
+#include <elob/util/profile.h>
+#include <elob/util/scheduler.h>
 #include "../../../../config.h"
 #include <elob/elob.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/delay.h>
+#include <util/atomic.h>
+#include <string.h>
 
 /**
- * @brief Macro for accessing the UART register with the given id.
- * This requires for `uartInterface` to be declared in the parent scope.
+ * @brief Macro for accessing the UART register with the given name.
+ * This requires for `hardware` (a pointer to a @ref _UART_Hardware_t) to be declared in the parent scope.
  * 
  */
-#define _UART_REGISTER(registerID) *(_uartRegisters[(uartInterface)][(registerID)])
+#define _UART_REGISTER(registerName) (*(hardware)->registerName)
 
 /**
- * @brief Enumerator defining the different registers stored in @ref _uartRegisters.
+ * @brief Struct holding the delimiter detection state of a single UART interface.
  * 
+ * The receive interrupt counts the received and the overwritten delimiters and the consumer the
+ * removed ones, so each counter only has a single writer and no updates can be lost.
  */
-typedef enum {
-	_DATA_REGISTER = 0,
-	_CTRL_REGISTER_A,
-	_CTRL_REGISTER_B,
-	_CTRL_REGISTER_C,
-	_BAUD_RATE_REGISTER_L,
-	_BAUD_RATE_REGISTER_H
-} _UART_RegisterID_t;
+typedef struct {
+	/**
+	 * @brief The delimiter which is counted.
+	 */
+	volatile uint8_t delimiter;
+	/**
+	 * @brief Free-running number of delimiters stored in the receive buffer.
+	 */
+	volatile uint8_t received;
+	/**
+	 * @brief Free-running number of delimiters removed from the receive buffer.
+	 */
+	volatile uint8_t consumed;
+	/**
+	 * @brief Free-running number of delimiters overwritten in the receive buffer by the receive interrupt,
+	 * see @ref UART_OVERFLOW_OVERWRITE_OLDEST.
+	 */
+	volatile uint8_t dropped;
+} _UART_Lines_t;
 
 /**
- * @brief Array containing the pointers to the interface-specific UART registers.
+ * @brief Struct holding the master SPI mode state of a single UART interface.
  * 
  */
-uint8_t* _uartRegisters[][6] = {
-	{ &UDR0, &UCSR0A, &UCSR0B, &UCSR0C, &UBRR0L, &UBRR0H },
-	{ &UDR1, &UCSR1A, &UCSR1B, &UCSR1C, &UBRR1L, &UBRR1H },
-	{ &UDR2, &UCSR2A, &UCSR2B, &UCSR2C, &UBRR2L, &UBRR2H },
-	{ &UDR3, &UCSR3A, &UCSR3B, &UCSR3C, &UBRR3L, &UBRR3H },
-};
+typedef struct {
+	/**
+	 * @brief Whether the interface is in master SPI mode.
+	 */
+	bool enabled;
+	/**
+	 * @brief Whether a background transfer is running. The other fields belong to the
+	 * receive interrupt while this is set.
+	 */
+	volatile bool busy;
+	/**
+	 * @brief Bytes to send, `NULL` to send @ref UART_SPI_FILL_BYTE.
+	 */
+	const uint8_t* tx;
+	/**
+	 * @brief Buffer for the received bytes, `NULL` to discard them.
+	 */
+	uint8_t* rx;
+	/**
+	 * @brief Number of bytes of the transfer.
+	 */
+	size_t length;
+	/**
+	 * @brief Number of bytes written to the data register.
+	 */
+	size_t sent;
+	/**
+	 * @brief Number of bytes read from the data register.
+	 */
+	size_t received;
+} _UART_Spi_t;
 
-// Allocation of raw arrays used by @ref _uartBuffers
-volatile uint8_t _rawUARTBuffers[3][UART_BUFFER_SIZE];
+/**
+ * @brief Data order bit of UCSRnC in master SPI mode, which shares the position of UCSZn1.
+ * Not all avr-libc versions define `UDORDn`.
+ * 
+ */
+#define _UART_UDORD UCSZ01
+/**
+ * @brief Clock phase bit of UCSRnC in master SPI mode, which shares the position of UCSZn0.
+ * Not all avr-libc versions define `UCPHAn`.
+ * 
+ */
+#define _UART_UCPHA UCSZ00
+
+/**
+ * @brief Struct describing the registers and buffers of a single UART interface.
+ * 
+ * There is one constant instance per enabled interface. The interface-specific functions
+ * and interrupt service routines pass a pointer to this constant to the inlined
+ * implementations below, so the compiler resolves all register addresses at compile time.
+ */
+typedef struct {
+	/**
+	 * @brief Number of the interface, which selects its scheduler events.
+	 */
+	uint8_t number;
+	volatile uint8_t* dataRegister;
+	volatile uint8_t* ctrlRegisterA;
+	volatile uint8_t* ctrlRegisterB;
+	volatile uint8_t* ctrlRegisterC;
+	volatile uint8_t* baudRateRegisterL;
+	volatile uint8_t* baudRateRegisterH;
+	/**
+	 * @brief Receive buffer, filled by the RX interrupt service routine.
+	 * `NULL` if the receiver is disabled.
+	 */
+	Buffer_t* rxBuffer;
+	/**
+	 * @brief Transmit buffer, drained by the UDRE interrupt service routine.
+	 * `NULL` if the interface transmits synchronously.
+	 */
+	Buffer_t* txBuffer;
+	/**
+	 * @brief Flag indicating that a byte was written to the data register since the
+	 * last @ref uart_flush, i.e. that the TXC flag is meaningful.
+	 */
+	volatile bool* txWritten;
+	/**
+	 * @brief Flag indicating that received data was discarded, see @ref uart_rxOverflowed.
+	 */
+	volatile bool* rxOverflowed;
+	/**
+	 * @brief Statistics counters of the interface.
+	 */
+	UART_Stats_t* stats;
+	/**
+	 * @brief Delimiter detection state of the interface, `NULL` if @ref UART_LINE_DETECTION is disabled.
+	 */
+	_UART_Lines_t* lines;
+	/**
+	 * @brief Data direction register of the XCKn pin, which is SCK in master SPI mode.
+	 */
+	volatile uint8_t* xckDirectionRegister;
+	/**
+	 * @brief Bit of the XCKn pin in @ref xckDirectionRegister.
+	 */
+	uint8_t xckBit;
+	/**
+	 * @brief Master SPI mode state of the interface, `NULL` if @ref UART_SPI_ENABLED is disabled.
+	 */
+	_UART_Spi_t* spi;
+} _UART_Hardware_t;
+
+#if UART_LINE_DETECTION
+/**
+ * @brief Accounts for the delimiters removed from the receive buffer by copying them to @p data.
+ * 
+ */
+static inline void _uart_consumeLines(const _UART_Hardware_t* hardware, const uint8_t* data, size_t n) {
+	_UART_Lines_t* lines = hardware->lines;
+	uint8_t delimiter = lines->delimiter;
+	const uint8_t* end = data + n;
+	
+	while((data = memchr(data, delimiter, end - data)) != NULL) {
+		lines->consumed++;
+		data++;
+	}
+}
+#define _UART_CONSUME_LINES(hardware, data, n) _uart_consumeLines(hardware, data, n)
+#else
+#define _UART_CONSUME_LINES(hardware, data, n)
+#endif
+
+/**
+ * @brief Writes a byte to the data register and clears the TXC flag, so that the
+ * completion of the transmission can be detected by @ref uart_flush.
+ * 
+ * Writing a one to TXC clears it, all other flags except U2X and MPCM are read-only
+ * and have to be written as zero.
+ */
+static inline void _uart_writeDataRegister(const _UART_Hardware_t* hardware, uint8_t data) {
+	_UART_REGISTER(dataRegister) = data;
+	_UART_REGISTER(ctrlRegisterA) = (_UART_REGISTER(ctrlRegisterA) & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+	*hardware->txWritten = true;
+}
+
+#if UART_SPI_ENABLED
+/**
+ * @brief Writes the next byte of the running transfer to the data register.
+ * 
+ */
+static inline void _uart_spiQueue(const _UART_Hardware_t* hardware, _UART_Spi_t* spi) {
+	_UART_REGISTER(dataRegister) = spi->tx ? spi->tx[spi->sent] : UART_SPI_FILL_BYTE;
+	spi->sent++;
+}
+
+/**
+ * @brief Handles the receive complete interrupt of a UART interface during a background
+ * transfer by storing the received byte and queueing the next one.
+ * 
+ */
+static inline void _uart_handleSpiReceive(const _UART_Hardware_t* hardware) {
+	_UART_Spi_t* spi = hardware->spi;
+	uint8_t rxData = _UART_REGISTER(dataRegister);
+	
+	if(spi->rx) spi->rx[spi->received] = rxData;
+	spi->received++;
+	
+	if(spi->sent < spi->length) {
+		// One byte is still being shifted, so the data register is free
+		_uart_spiQueue(hardware, spi);
+	} else if(spi->received == spi->length) {
+		CLEARBIT(_UART_REGISTER(ctrlRegisterB), RXCIE0);
+		spi->busy = false;
+		_SCHEDULER_SIGNAL(SCHEDULER_EVENT_UART_TX(hardware->number));
+	}
+}
+#endif
+
+/**
+ * @brief Handles the receive complete interrupt of a UART interface by storing the
+ * received byte in the receive buffer.
+ * 
+ * This runs in constant time and never throws. If the receive buffer is full, the
+ * configured `UART_RX_OVERFLOW_POLICY` is applied.
+ */
+static inline void _uart_handleReceive(const _UART_Hardware_t* hardware) {
+#if UART_SPI_ENABLED
+	if(hardware->spi->busy) {
+		_uart_handleSpiReceive(hardware);
+		return;
+	}
+#endif
+	
+	// The error flags are only valid until the data register is read
+	uint8_t status = _UART_REGISTER(ctrlRegisterA);
+	uint8_t rxData = _UART_REGISTER(dataRegister);
+	Buffer_t* rxBuffer = hardware->rxBuffer;
+	
+#if UART_RX_OVERFLOW_POLICY == UART_OVERFLOW_OVERWRITE_OLDEST
+#if UART_LINE_DETECTION
+	// Discarding the oldest byte may remove a delimiter
+	if(buffer_full(rxBuffer) && buffer_find(rxBuffer, hardware->lines->delimiter, 0, 1)) {
+		hardware->lines->dropped++;
+	}
+#endif
+	bool stored = buffer_putOverwrite(rxBuffer, rxData);
+	bool inserted = true;
+#else
+	bool stored = buffer_tryPut(rxBuffer, rxData);
+	bool inserted = stored;
+#endif
+	
+#if UART_LINE_DETECTION
+	if(inserted && rxData == hardware->lines->delimiter) hardware->lines->received++;
+#else
+	(void)inserted;
+#endif
+	
+#if UART_RX_OVERFLOW_POLICY == UART_OVERFLOW_FLAG
+	if(!stored) *hardware->rxOverflowed = true;
+#endif
+	
+#if UART_STATS_ENABLED
+	UART_Stats_t* stats = hardware->stats;
+	stats->receivedBytes++;
+	if(!stored) stats->droppedBytes++;
+	if(CHECKBIT(status, FE0)) stats->framingErrors++;
+	if(CHECKBIT(status, UPE0)) stats->parityErrors++;
+	if(CHECKBIT(status, DOR0)) stats->dataOverruns++;
+	
+	uint8_t count = buffer_count(rxBuffer);
+	if(count > stats->highWaterMark) stats->highWaterMark = count;
+#else
+	(void)status;
+	(void)stored;
+#endif
+	
+	_SCHEDULER_SIGNAL(SCHEDULER_EVENT_UART_RX(hardware->number));
+}
+
+/**
+ * @brief Handles the data register empty interrupt of a UART interface by moving the
+ * next byte from the transmit buffer into the data register.
+ * 
+ */
+static inline void _uart_handleDataRegisterEmpty(const _UART_Hardware_t* hardware) {
+	if(buffer_empty(hardware->txBuffer)) {
+		// Nothing left to send, disable the interrupt until new data is queued
+		CLEARBIT(_UART_REGISTER(ctrlRegisterB), UDRIE0);
+		_SCHEDULER_SIGNAL(SCHEDULER_EVENT_UART_TX(hardware->number));
+		return;
+	}
+	
+	_uart_writeDataRegister(hardware, buffer_get(hardware->txBuffer));
+}
+
+/**
+ * @brief Synchronously sends all bytes queued in the transmit buffer, bypassing the UDRE interrupt.
+ * 
+ */
+static void _uart_drainPolled(const _UART_Hardware_t* hardware) {
+	while(hardware->txBuffer && !buffer_empty(hardware->txBuffer)) {
+		while(!CHECKBIT(_UART_REGISTER(ctrlRegisterA), UDRE0));
+		_uart_writeDataRegister(hardware, buffer_get(hardware->txBuffer));
+	}
+}
+
+/**
+ * @brief Synchronously sends a byte, bypassing the UDRE interrupt. Any data still queued
+ * in the transmit buffer is sent first to preserve the byte order.
+ * 
+ * This is used whenever interrupts are disabled globally (e.g. inside an interrupt service
+ * routine or the uncaught error handler), where the UDRE interrupt can't drain the buffer,
+ * and for interfaces without a transmit buffer.
+ */
+static void _uart_sendBytePolled(const _UART_Hardware_t* hardware, uint8_t data) {
+	_uart_drainPolled(hardware);
+	
+	while(!CHECKBIT(_UART_REGISTER(ctrlRegisterA), UDRE0));
+	_uart_writeDataRegister(hardware, data);
+}
+
+static inline bool _uart_available(const _UART_Hardware_t* hardware) {
+	return hardware->rxBuffer && !buffer_empty(hardware->rxBuffer);
+}
 
 /**
- * @brief List of interface-specific UART receive buffers.
+ * @brief Ensures the receiver of the given interface is enabled.
  * 
+ * @exception ERR_INVALID_INTERFACE The receive buffer size of the interface is configured as 0.
  */
-volatile Buffer_t _uartBuffers[] = {
-	{ // FIFO buffer for UART0
-		.size = 0,
-		.maxSize = UART_BUFFER_SIZE,
-		.ptr = _rawUARTBuffers[0],
-		.type = BUFFER_TYPE_FIFO
-	},
-	{ // FIFO buffer for UART1
-		.size = 0,
-		.maxSize = UART_BUFFER_SIZE,
-		.ptr = _rawUARTBuffers[1],
-		.type = BUFFER_TYPE_FIFO
-	},
-	{ // FIFO buffer for UART2
-		.size = 0,
-		.maxSize = UART_BUFFER_SIZE,
-		.ptr = _rawUARTBuffers[2],
-		.type = BUFFER_TYPE_FIFO
-	},
-	{ // FIFO buffer for UART3
-		.size = 0,
-		.maxSize = UART_BUFFER_SIZE,
-		.ptr = _rawUARTBuffers[3],
-		.type = BUFFER_TYPE_FIFO
+static inline void _uart_assertReceiver(const _UART_Hardware_t* hardware) {
+	if(!hardware->rxBuffer) {
+		throwMessage(ERR_INVALID_INTERFACE, "uart: The receiver of the UART interface is disabled.");
 	}
-};
+}
+
+static inline void _uart_sendByte(const _UART_Hardware_t* hardware, uint8_t data) {
+	if(!hardware->txBuffer || !CHECKBIT(SREG, SREG_I)) {
+		_uart_sendBytePolled(hardware, data);
+		return;
+	}
+	
+	// Wait for the UDRE interrupt to free up space in the transmit buffer
+	while(buffer_full(hardware->txBuffer));
+	
+	buffer_put(hardware->txBuffer, data);
+	
+	// Enable the UDRE interrupt, which sends the data in the background
+	SETBIT(_UART_REGISTER(ctrlRegisterB), UDRIE0);
+}
+
+static inline void _uart_write(const _UART_Hardware_t* hardware, const uint8_t* data, size_t length) {
+	if(!hardware->txBuffer || !CHECKBIT(SREG, SREG_I)) {
+		for(size_t i = 0; i < length; i++) {
+			_uart_sendBytePolled(hardware, data[i]);
+		}
+		return;
+	}
+	
+	while(length > 0) {
+		// Copy as much as currently fits, waiting for the UDRE interrupt to free up space
+		size_t written = buffer_write(hardware->txBuffer, data, length);
+		if(written > 0) {
+			SETBIT(_UART_REGISTER(ctrlRegisterB), UDRIE0);
+			data += written;
+			length -= written;
+		}
+	}
+}
+
+static inline uint8_t _uart_txBytesFree(const _UART_Hardware_t* hardware) {
+	if(!hardware->txBuffer) {
+		// Without a transmit buffer, only the data register can take a byte without blocking
+		return CHECKBIT(_UART_REGISTER(ctrlRegisterA), UDRE0) ? 1 : 0;
+	}
+	return (hardware->txBuffer->mask + 1) - buffer_count(hardware->txBuffer);
+}
+
+static inline void _uart_flush(const _UART_Hardware_t* hardware) {
+	// Wait for the UDRE interrupt to move all queued bytes into the hardware
+	while(hardware->txBuffer && !buffer_empty(hardware->txBuffer));
+	
+	// Wait for the last byte to be shifted out completely
+	if(*hardware->txWritten) {
+		while(!CHECKBIT(_UART_REGISTER(ctrlRegisterA), TXC0));
+		*hardware->txWritten = false;
+	}
+}
+
+static inline uint8_t _uart_readByte(const _UART_Hardware_t* hardware) {
+	_uart_assertReceiver(hardware);
+	while(!_uart_available(hardware));
+	
+	uint8_t data = buffer_get(hardware->rxBuffer);
+#if UART_LINE_DETECTION
+	if(data == hardware->lines->delimiter) hardware->lines->consumed++;
+#endif
+	return data;
+}
+
+static inline size_t _uart_read(const _UART_Hardware_t* hardware, uint8_t* dst, size_t length, uint16_t timeout) {
+	_uart_assertReceiver(hardware);
+	size_t received = buffer_read(hardware->rxBuffer, dst, length);
+	_UART_CONSUME_LINES(hardware, dst, received);
+	
+	// Poll in steps of 10 us until the data is complete or the timeout expired
+	uint32_t remainingSteps = (uint32_t)timeout * 100;
+	while(received < length && (timeout == UART_TIMEOUT_INFINITE || remainingSteps > 0)) {
+		_delay_us(10);
+		remainingSteps--;
+		size_t chunk = buffer_read(hardware->rxBuffer, dst + received, length - received);
+		_UART_CONSUME_LINES(hardware, dst + received, chunk);
+		received += chunk;
+	}
+	
+	return received;
+}
+
+#if UART_LINE_DETECTION
+static inline uint8_t _uart_linesAvailable(const _UART_Hardware_t* hardware) {
+	const _UART_Lines_t* lines = hardware->lines;
+	return lines->received - lines->dropped - lines->consumed;
+}
+
+static inline size_t _uart_readUntil(const _UART_Hardware_t* hardware, uint8_t delimiter, uint8_t* dst, size_t max) {
+	_uart_assertReceiver(hardware);
+	Buffer_t* rxBuffer = hardware->rxBuffer;
+	uint8_t count = buffer_count(rxBuffer);
+	size_t available = count < max ? count : max;
+	
+	size_t length = buffer_find(rxBuffer, delimiter, 0, available);
+	if(length == 0) {
+		// Hand out overlong lines in parts, they would never be completed otherwise
+		if(count < max && !buffer_full(rxBuffer)) return 0;
+		length = available;
+		if(length == 0) return 0;
+	}
+	buffer_read(rxBuffer, dst, length);
+	
+	if(delimiter == hardware->lines->delimiter) {
+		// The copied span contains at most one delimiter, at its end
+		if(dst[length - 1] == delimiter) hardware->lines->consumed++;
+	} else {
+		_uart_consumeLines(hardware, dst, length);
+	}
+	return length;
+}
+#endif
+
+/**
+ * @brief Defines the receive buffer of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_RX_BUFFER(n) \
+	uint8_t _uart##n##RxStorage[UART##n##_RX_BUFFER_SIZE]; \
+	Buffer_t _uart##n##RxBuffer = BUFFER_INITIALIZER(_uart##n##RxStorage, UART##n##_RX_BUFFER_SIZE);
+
+/**
+ * @brief Defines the transmit buffer of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_TX_BUFFER(n) \
+	uint8_t _uart##n##TxStorage[UART##n##_TX_BUFFER_SIZE]; \
+	Buffer_t _uart##n##TxBuffer = BUFFER_INITIALIZER(_uart##n##TxStorage, UART##n##_TX_BUFFER_SIZE);
 
-// GET and PUT functions for the FILE-type streams
-int _uart0_put(char* c, FILE* f) { uart_sendByte(UART0, c); return 0; };
-int _uart1_put(char* c, FILE* f) { uart_sendByte(UART1, c); return 0; };
-int _uart2_put(char* c, FILE* f) { uart_sendByte(UART2, c); return 0; };
-int _uart3_put(char* c, FILE* f) { uart_sendByte(UART3, c); return 0; };
-int _uart0_get(char* c, FILE* f) { return uart_readByte(UART0); };
-int _uart1_get(char* c, FILE* f) { return uart_readByte(UART1); };
-int _uart2_get(char* c, FILE* f) { return uart_readByte(UART2); };
-int _uart3_get(char* c, FILE* f) { return uart_readByte(UART3); };
+#if UART_LINE_DETECTION
+/**
+ * @brief Defines the delimiter detection state of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_LINES(n) _UART_Lines_t _uart##n##Lines = { .delimiter = UART_DEFAULT_DELIMITER };
+/**
+ * @brief Gets a pointer to the delimiter detection state of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_LINES(n) &_uart##n##Lines
+/**
+ * @brief Defines the interface-specific line functions of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_LINE_FUNCTIONS(n) \
+	uint8_t uart##n##_linesAvailable(void) { return _uart_linesAvailable(&_uart##n##Hardware); } \
+	size_t uart##n##_readUntil(uint8_t delimiter, uint8_t* dst, size_t max) { return _uart_readUntil(&_uart##n##Hardware, delimiter, dst, max); }
+#else
+#define _UART_DEFINE_LINES(n)
+#define _UART_LINES(n) NULL
+#define _UART_DEFINE_LINE_FUNCTIONS(n)
+#endif
+
+#if UART_SPI_ENABLED
+/**
+ * @brief Defines the master SPI mode state of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_SPI(n) _UART_Spi_t _uart##n##Spi;
+/**
+ * @brief Gets a pointer to the master SPI mode state of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_SPI(n) &_uart##n##Spi
+#else
+#define _UART_DEFINE_SPI(n)
+#define _UART_SPI(n) NULL
+#endif
+
+/**
+ * @brief XCKn pins of the UART interfaces, which are SCK in master SPI mode.
+ * 
+ */
+#define _UART0_XCK_DDR DDRE
+#define _UART0_XCK_BIT 2
+#define _UART1_XCK_DDR DDRD
+#define _UART1_XCK_BIT 5
+#define _UART2_XCK_DDR DDRH
+#define _UART2_XCK_BIT 2
+#define _UART3_XCK_DDR DDRJ
+#define _UART3_XCK_BIT 2
+
+#if UART_STATS_ENABLED
+/**
+ * @brief Defines the statistics counters of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_STATS(n) UART_Stats_t _uart##n##Stats;
+/**
+ * @brief Gets a pointer to the statistics counters of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_STATS(n) &_uart##n##Stats
+#else
+#define _UART_DEFINE_STATS(n)
+#define _UART_STATS(n) NULL
+#endif
+
+/**
+ * @brief Defines the hardware description and the interface-specific functions of the
+ * UART interface with the number @p n. This requires `_UARTn_RX_BUFFER` and `_UARTn_TX_BUFFER`
+ * to be defined as the buffer pointers (or `NULL`).
+ * 
+ */
+#define _UART_DEFINE_INTERFACE(n) \
+	volatile bool _uart##n##TxWritten; \
+	volatile bool _uart##n##RxOverflowed; \
+	_UART_DEFINE_STATS(n) \
+	_UART_DEFINE_LINES(n) \
+	_UART_DEFINE_SPI(n) \
+	static const _UART_Hardware_t _uart##n##Hardware = { \
+		.number = n, \
+		.dataRegister = &UDR##n, \
+		.ctrlRegisterA = &UCSR##n##A, \
+		.ctrlRegisterB = &UCSR##n##B, \
+		.ctrlRegisterC = &UCSR##n##C, \
+		.baudRateRegisterL = &UBRR##n##L, \
+		.baudRateRegisterH = &UBRR##n##H, \
+		.rxBuffer = _UART##n##_RX_BUFFER, \
+		.txBuffer = _UART##n##_TX_BUFFER, \
+		.txWritten = &_uart##n##TxWritten, \
+		.rxOverflowed = &_uart##n##RxOverflowed, \
+		.stats = _UART_STATS(n), \
+		.lines = _UART_LINES(n), \
+		.xckDirectionRegister = &_UART##n##_XCK_DDR, \
+		.xckBit = _UART##n##_XCK_BIT, \
+		.spi = _UART_SPI(n) \
+	}; \
+	bool uart##n##_available(void) { return _uart_available(&_uart##n##Hardware); } \
+	void uart##n##_sendByte(uint8_t data) { _uart_sendByte(&_uart##n##Hardware, data); } \
+	void uart##n##_write(const uint8_t* data, size_t length) { _uart_write(&_uart##n##Hardware, data, length); } \
+	uint8_t uart##n##_txBytesFree(void) { return _uart_txBytesFree(&_uart##n##Hardware); } \
+	void uart##n##_flush(void) { _uart_flush(&_uart##n##Hardware); } \
+	uint8_t uart##n##_readByte(void) { return _uart_readByte(&_uart##n##Hardware); } \
+	size_t uart##n##_read(uint8_t* dst, size_t length, uint16_t timeout) { return _uart_read(&_uart##n##Hardware, dst, length, timeout); } \
+	_UART_DEFINE_LINE_FUNCTIONS(n)
+
+/**
+ * @brief Defines the receive complete interrupt service routine of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_RX_ISR(n) \
+	ISR(USART##n##_RX_vect) { \
+		PROFILE_BEGIN(PROFILE_UART_RX_ISR); \
+		_uart_handleReceive(&_uart##n##Hardware); \
+		PROFILE_END(PROFILE_UART_RX_ISR); \
+	}
+
+/**
+ * @brief Defines the data register empty interrupt service routine of the UART interface with the number @p n.
+ * 
+ */
+#define _UART_DEFINE_TX_ISR(n) \
+	ISR(USART##n##_UDRE_vect) { _uart_handleDataRegisterEmpty(&_uart##n##Hardware); }
+
+// Only allocate the buffers and interrupt service routines which are actually used
+#if UART0_ENABLED
+	#if UART0_RX_BUFFER_SIZE > 0
+		_UART_DEFINE_RX_BUFFER(0)
+		#define _UART0_RX_BUFFER &_uart0RxBuffer
+	#else
+		#define _UART0_RX_BUFFER NULL
+	#endif
+	#if UART0_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_BUFFER(0)
+		#define _UART0_TX_BUFFER &_uart0TxBuffer
+	#else
+		#define _UART0_TX_BUFFER NULL
+	#endif
+	_UART_DEFINE_INTERFACE(0)
+	#if UART0_RX_BUFFER_SIZE > 0 || UART_SPI_ENABLED
+		_UART_DEFINE_RX_ISR(0)
+	#endif
+	#if UART0_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_ISR(0)
+	#endif
+#endif
+
+#if UART1_ENABLED
+	#if UART1_RX_BUFFER_SIZE > 0
+		_UART_DEFINE_RX_BUFFER(1)
+		#define _UART1_RX_BUFFER &_uart1RxBuffer
+	#else
+		#define _UART1_RX_BUFFER NULL
+	#endif
+	#if UART1_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_BUFFER(1)
+		#define _UART1_TX_BUFFER &_uart1TxBuffer
+	#else
+		#define _UART1_TX_BUFFER NULL
+	#endif
+	_UART_DEFINE_INTERFACE(1)
+	#if UART1_RX_BUFFER_SIZE > 0 || UART_SPI_ENABLED
+		_UART_DEFINE_RX_ISR(1)
+	#endif
+	#if UART1_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_ISR(1)
+	#endif
+#endif
+
+#if UART2_ENABLED
+	#if UART2_RX_BUFFER_SIZE > 0
+		_UART_DEFINE_RX_BUFFER(2)
+		#define _UART2_RX_BUFFER &_uart2RxBuffer
+	#else
+		#define _UART2_RX_BUFFER NULL
+	#endif
+	#if UART2_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_BUFFER(2)
+		#define _UART2_TX_BUFFER &_uart2TxBuffer
+	#else
+		#define _UART2_TX_BUFFER NULL
+	#endif
+	_UART_DEFINE_INTERFACE(2)
+	#if UART2_RX_BUFFER_SIZE > 0 || UART_SPI_ENABLED
+		_UART_DEFINE_RX_ISR(2)
+	#endif
+	#if UART2_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_ISR(2)
+	#endif
+#endif
+
+#if UART3_ENABLED
+	#if UART3_RX_BUFFER_SIZE > 0
+		_UART_DEFINE_RX_BUFFER(3)
+		#define _UART3_RX_BUFFER &_uart3RxBuffer
+	#else
+		#define _UART3_RX_BUFFER NULL
+	#endif
+	#if UART3_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_BUFFER(3)
+		#define _UART3_TX_BUFFER &_uart3TxBuffer
+	#else
+		#define _UART3_TX_BUFFER NULL
+	#endif
+	_UART_DEFINE_INTERFACE(3)
+	#if UART3_RX_BUFFER_SIZE > 0 || UART_SPI_ENABLED
+		_UART_DEFINE_RX_ISR(3)
+	#endif
+	#if UART3_TX_BUFFER_SIZE > 0
+		_UART_DEFINE_TX_ISR(3)
+	#endif
+#endif
+
+/**
+ * @brief Gets the hardware description of the given UART interface.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is disabled in the configuration.
+ */
+static const _UART_Hardware_t* _uart_getHardware(UART_Interface_t uartInterface) {
+	switch(uartInterface) {
+#if UART0_ENABLED
+		case UART0: return &_uart0Hardware;
+#endif
+#if UART1_ENABLED
+		case UART1: return &_uart1Hardware;
+#endif
+#if UART2_ENABLED
+		case UART2: return &_uart2Hardware;
+#endif
+#if UART3_ENABLED
+		case UART3: return &_uart3Hardware;
+#endif
+		default: break;
+	}
+	
+	throwMessage(ERR_INVALID_INTERFACE, "uart: The UART interface is not enabled.");
+	return NULL;
+}
+
+// GET and PUT functions and statically allocated FILE-type streams
+#if UART0_ENABLED
+static int _uart0_put(char c, FILE* f) { uart0_sendByte(c); return 0; }
+static int _uart0_get(FILE* f) { return uart0_readByte(); }
+static FILE _uart0_stream = FDEV_SETUP_STREAM(_uart0_put, _uart0_get, _FDEV_SETUP_RW);
+FILE* UART0_f = &_uart0_stream;
+#endif
+#if UART1_ENABLED
+static int _uart1_put(char c, FILE* f) { uart1_sendByte(c); return 0; }
+static int _uart1_get(FILE* f) { return uart1_readByte(); }
+static FILE _uart1_stream = FDEV_SETUP_STREAM(_uart1_put, _uart1_get, _FDEV_SETUP_RW);
+FILE* UART1_f = &_uart1_stream;
+#endif
+#if UART2_ENABLED
+static int _uart2_put(char c, FILE* f) { uart2_sendByte(c); return 0; }
+static int _uart2_get(FILE* f) { return uart2_readByte(); }
+static FILE _uart2_stream = FDEV_SETUP_STREAM(_uart2_put, _uart2_get, _FDEV_SETUP_RW);
+FILE* UART2_f = &_uart2_stream;
+#endif
+#if UART3_ENABLED
+static int _uart3_put(char c, FILE* f) { uart3_sendByte(c); return 0; }
+static int _uart3_get(FILE* f) { return uart3_readByte(); }
+static FILE _uart3_stream = FDEV_SETUP_STREAM(_uart3_put, _uart3_get, _FDEV_SETUP_RW);
+FILE* UART3_f = &_uart3_stream;
+#endif
+
+#if UART_SPI_ENABLED
+/**
+ * @brief Waits until the background transfer of the given interface is complete.
+ * 
+ */
+static inline void _uart_spiWait(const _UART_Hardware_t* hardware) {
+	while(hardware->spi->busy);
+}
+
+/**
+ * @brief Ensures the given interface is in master SPI mode and no background transfer is running.
+ * 
+ * @exception ERR_INVALID_INTERFACE The interface is not in master SPI mode.
+ */
+static void _uart_spiPrepare(const _UART_Hardware_t* hardware) {
+	if(!hardware->spi->enabled) {
+		throwMessage(ERR_INVALID_INTERFACE, "uart_spi: The UART interface is not in SPI mode.");
+	}
+	_uart_spiWait(hardware);
+	
+	// Discard bytes left in the receive FIFO, they would be mistaken for the first received bytes
+	while(CHECKBIT(_UART_REGISTER(ctrlRegisterA), RXC0)) {
+		(void)_UART_REGISTER(dataRegister);
+	}
+}
+
+/**
+ * @brief Exchanges a block of bytes by polling the flags of the interface.
+ * 
+ */
+static void _uart_spiTransferPolled(const _UART_Hardware_t* hardware, const uint8_t* tx, uint8_t* rx, size_t n) {
+	size_t sent = 0;
+	size_t received = 0;
+	
+	while(received < n) {
+		// Keep at most two bytes in flight (shift register and data register),
+		// so the two-level receive FIFO can't overrun
+		if(sent < n && sent - received < 2 && CHECKBIT(_UART_REGISTER(ctrlRegisterA), UDRE0)) {
+			_UART_REGISTER(dataRegister) = tx ? tx[sent] : UART_SPI_FILL_BYTE;
+			sent++;
+		}
+		if(CHECKBIT(_UART_REGISTER(ctrlRegisterA), RXC0)) {
+			uint8_t rxData = _UART_REGISTER(dataRegister);
+			if(rx) rx[received] = rxData;
+			received++;
+		}
+	}
+}
+#endif
+
+/**
+ * @brief Calculates the baud rate setting for the given baud rate at runtime.
+ * This only uses integer math, so no floating point library is required.
+ * 
+ */
+static UART_BaudSetting_t _uart_calculateBaudSetting(unsigned long baudrate) {
+	if(!UART_BAUDRATE_REACHABLE(baudrate)) {
+		throwMessage(ERR_BITRATE_TOO_LOW, "uart_setBaudrate: The specified baudrate is too low.");
+	}
+	
+	// Choose between normal and double speed mode
+	return UART_BAUD_SETTING_UNCHECKED(baudrate);
+}
 
 void uart_init(
 	UART_Interface_t uartInterface, 
@@ -94,91 +810,384 @@ void uart_init(
 	UART_StopBitMode_t stopbitMode,
 	UART_ClockPolarityMode_t clockPolarityMode
 ) {
-	uart_setBaudrate(uartInterface, baudrate); // Set the baudrate
+	UART_BaudSetting_t baudSetting = _uart_calculateBaudSetting(baudrate);
+	uart_initWithBaudSetting(uartInterface, baudSetting, parityMode, stopbitMode, clockPolarityMode);
+}
+
+void uart_initWithBaudSetting(
+	UART_Interface_t uartInterface, 
+	UART_BaudSetting_t baudSetting,
+	UART_ParityMode_t parityMode,
+	UART_StopBitMode_t stopbitMode,
+	UART_ClockPolarityMode_t clockPolarityMode
+) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	
+#if UART_SPI_ENABLED
+	// Leave the master SPI mode
+	_uart_spiWait(hardware);
+	hardware->spi->enabled = false;
+#endif
+	
+	uart_setBaudSetting(uartInterface, baudSetting); // Set the baudrate
 	
 	// Configure interrupts
-	SETBIT(_UART_REGISTER(_CTRL_REGISTER_B), RXCIE0);
-	CLEARBIT(_UART_REGISTER(_CTRL_REGISTER_B), TXCIE0);
-	CLEARBIT(_UART_REGISTER(_CTRL_REGISTER_B), UDRIE0);
+	// The UDRE interrupt is only enabled while there is data in the transmit buffer
+	WRITEBIT(_UART_REGISTER(ctrlRegisterB), RXCIE0, hardware->rxBuffer != NULL);
+	CLEARBIT(_UART_REGISTER(ctrlRegisterB), TXCIE0);
+	CLEARBIT(_UART_REGISTER(ctrlRegisterB), UDRIE0);
+	if(hardware->txBuffer) buffer_clear(hardware->txBuffer);
 	sei();
 	
-	// Enable the receiver and transmitter
-	SETBIT(_UART_REGISTER(_CTRL_REGISTER_B), RXEN0);
-	SETBIT(_UART_REGISTER(_CTRL_REGISTER_B), TXEN0);
+	// Enable the receiver (only if there is a receive buffer) and transmitter
+	WRITEBIT(_UART_REGISTER(ctrlRegisterB), RXEN0, hardware->rxBuffer != NULL);
+	SETBIT(_UART_REGISTER(ctrlRegisterB), TXEN0);
 	
 	// Configure the character size
-	SETBIT(_UART_REGISTER(_CTRL_REGISTER_C), UCSZ00);
-	SETBIT(_UART_REGISTER(_CTRL_REGISTER_C), UCSZ01);
-	CLEARBIT(_UART_REGISTER(_CTRL_REGISTER_B), UCSZ02);
+	SETBIT(_UART_REGISTER(ctrlRegisterC), UCSZ00);
+	SETBIT(_UART_REGISTER(ctrlRegisterC), UCSZ01);
+	CLEARBIT(_UART_REGISTER(ctrlRegisterB), UCSZ02);
 	
 	// Select the UART mode
-	CLEARBIT(_UART_REGISTER(_CTRL_REGISTER_C), UMSEL00);
-	CLEARBIT(_UART_REGISTER(_CTRL_REGISTER_C), UMSEL01);
+	CLEARBIT(_UART_REGISTER(ctrlRegisterC), UMSEL00);
+	CLEARBIT(_UART_REGISTER(ctrlRegisterC), UMSEL01);
 	
 	// Configure the stop bit mode
-	WRITEBIT(_UART_REGISTER(_CTRL_REGISTER_C), USBS0, stopbitMode);
+	WRITEBIT(_UART_REGISTER(ctrlRegisterC), USBS0, stopbitMode);
 	
 	// Configure the clock polarity
-	WRITEBIT(_UART_REGISTER(_CTRL_REGISTER_C), UCPOL0, clockPolarityMode);
+	WRITEBIT(_UART_REGISTER(ctrlRegisterC), UCPOL0, clockPolarityMode);
 	
 	// Configure the parity setings
-	WRITEBIT(_UART_REGISTER(_CTRL_REGISTER_C), UPM00, CHECKBIT(parityMode, 0));
-	WRITEBIT(_UART_REGISTER(_CTRL_REGISTER_C), UPM01, CHECKBIT(parityMode, 1));
+	WRITEBIT(_UART_REGISTER(ctrlRegisterC), UPM00, CHECKBIT(parityMode, 0));
+	WRITEBIT(_UART_REGISTER(ctrlRegisterC), UPM01, CHECKBIT(parityMode, 1));
 	
+	// Like the first call of fdevopen, the first initialized interface becomes the standard streams
+	FILE* stream = NULL;
 	switch(uartInterface) {
+#if UART0_ENABLED
 		case UART0:
-			fclose(UART0_f);
-			UART0_f = fdevopen(_uart0_put, _uart0_get);
+			stream = UART0_f;
 			break;
-			
+#endif
+		
+#if UART1_ENABLED
 		case UART1:
-			fclose(UART1_f);
-			UART1_f = fdevopen(_uart1_put, _uart1_get);
+			stream = UART1_f;
 			break;
+#endif
 		
+#if UART2_ENABLED
 		case UART2:
-			fclose(UART2_f);
-			UART2_f = fdevopen(_uart2_put, _uart2_get);
+			stream = UART2_f;
 			break;
+#endif
 		
+#if UART3_ENABLED
 		case UART3:
-			fclose(UART3_f);
-			UART3_f = fdevopen(_uart3_put, _uart3_get);
-			break;	
+			stream = UART3_f;
+			break;
+#endif
+	}
+	if(stdin == NULL) stdin = stream;
+	if(stdout == NULL) {
+		stdout = stream;
+		stderr = stream;
 	}
 }
 
 void uart_setBaudrate(UART_Interface_t uartInterface, unsigned long baudrate) {
-	// Calculate the UBRR value for the given baud rate both for double speed and normal mode
-	float ubrrValue2X = (float)F_CPU / (8.0 * (float)baudrate) - 1;
-	float ubrrValue1X = (float)F_CPU / (16.0 * (float)baudrate) - 1;
+	uart_setBaudSetting(uartInterface, _uart_calculateBaudSetting(baudrate));
+}
+
+void uart_setBaudSetting(UART_Interface_t uartInterface, UART_BaudSetting_t baudSetting) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	uint16_t ubrrValue = baudSetting & 0x0FFF;
 	
-	if(ubrrValue1X > 2047) {
-		throwMessage(ERR_BITRATE_TOO_LOW, "uart_setBaudrate: The specified baudrate is too low.");
+	WRITEBIT(_UART_REGISTER(ctrlRegisterA), U2X0, baudSetting & UART_BAUD_SETTING_U2X);
+	// UBRRnH has to be written first, writing UBRRnL updates the baud rate prescaler
+	_UART_REGISTER(baudRateRegisterH) = ubrrValue >> 8;
+	_UART_REGISTER(baudRateRegisterL) = ubrrValue & 0xFF;
+}
+
+size_t uart_sramUsage(void) {
+	size_t usage = UART_BUFFER_SRAM_USAGE;
+	
+	// Add the bookkeeping data of every enabled interface and buffer
+#if UART0_ENABLED
+	usage += sizeof(_uart0Hardware) + sizeof(_uart0TxWritten) + sizeof(_uart0RxOverflowed);
+	#if UART0_RX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+	#if UART0_TX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+#endif
+#if UART1_ENABLED
+	usage += sizeof(_uart1Hardware) + sizeof(_uart1TxWritten) + sizeof(_uart1RxOverflowed);
+	#if UART1_RX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+	#if UART1_TX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+#endif
+#if UART2_ENABLED
+	usage += sizeof(_uart2Hardware) + sizeof(_uart2TxWritten) + sizeof(_uart2RxOverflowed);
+	#if UART2_RX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+	#if UART2_TX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+#endif
+#if UART3_ENABLED
+	usage += sizeof(_uart3Hardware) + sizeof(_uart3TxWritten) + sizeof(_uart3RxOverflowed);
+	#if UART3_RX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+	#if UART3_TX_BUFFER_SIZE > 0
+		usage += sizeof(Buffer_t);
+	#endif
+#endif
+#if UART_LINE_DETECTION
+	usage += (UART0_ENABLED + UART1_ENABLED + UART2_ENABLED + UART3_ENABLED) * sizeof(_UART_Lines_t);
+#endif
+#if UART_STATS_ENABLED
+	usage += (UART0_ENABLED + UART1_ENABLED + UART2_ENABLED + UART3_ENABLED) * sizeof(UART_Stats_t);
+#endif
+#if UART_SPI_ENABLED
+	usage += (UART0_ENABLED + UART1_ENABLED + UART2_ENABLED + UART3_ENABLED) * sizeof(_UART_Spi_t);
+#endif
+	
+	return usage;
+}
+
+void uart_getStats(UART_Interface_t uartInterface, UART_Stats_t* stats) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	
+	if(!hardware->stats) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+	
+	// The counters are modified by the receive interrupt, so copy them atomically
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*stats = *hardware->stats;
 	}
+}
+
+void uart_resetStats(UART_Interface_t uartInterface) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
 	
-	// Calculate the differences between the set baudrate
-	// and the resulting baudrate
-	float diff2X = abs((signed long)((float)F_CPU / (8.0 * (float)(round(ubrrValue2X) + 1)) - baudrate));
-	float diff1X = abs((signed long)((float)F_CPU / (16.0 * (float)(round(ubrrValue1X) + 1)) - baudrate));
+	if(!hardware->stats) return;
 	
-	// Compare the differences and set the control registers accordingly
-	bool useDoubleSpeedMode = (diff2X < diff1X) && (ubrrValue2X < 2047);
-	uint16_t ubrrValue = round(useDoubleSpeedMode ? ubrrValue2X : ubrrValue1X);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		memset(hardware->stats, 0, sizeof(*hardware->stats));
+	}
+}
+
+#if UART_LINE_DETECTION
+void uart_setDelimiter(UART_Interface_t uartInterface, uint8_t delimiter) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	_uart_assertReceiver(hardware);
+	Buffer_t* rxBuffer = hardware->rxBuffer;
 	
-	WRITEBIT(_UART_REGISTER(_CTRL_REGISTER_A), U2X0, useDoubleSpeedMode);
-	_UART_REGISTER(_BAUD_RATE_REGISTER_L) = ubrrValue & 0xFF;
-	_UART_REGISTER(_BAUD_RATE_REGISTER_H) = ubrrValue >> 8;
+	// Recount the delimiters in the receive buffer, without receiving in between
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		uint8_t count = buffer_count(rxBuffer);
+		uint8_t lines = 0;
+		size_t position = 0;
+		while((position = buffer_find(rxBuffer, delimiter, position, count - position)) != 0) {
+			lines++;
+		}
+		
+		hardware->lines->delimiter = delimiter;
+		hardware->lines->consumed = hardware->lines->received - hardware->lines->dropped - lines;
+	}
 }
+#endif
+
+#if UART_SPI_ENABLED
+void uart_spiInit(UART_Interface_t uartInterface, unsigned long bitrate, UART_SpiMode_t mode, UART_SpiDataOrder_t dataOrder) {
+	if(!UART_SPI_BITRATE_REACHABLE(bitrate)) {
+		throwMessage(ERR_BITRATE_TOO_LOW, "uart_spiInit: The specified bitrate is too low.");
+	}
+	uart_spiInitWithBaudSetting(uartInterface, UART_SPI_BAUD_SETTING_UNCHECKED(bitrate), mode, dataOrder);
+}
+
+void uart_spiInitWithBaudSetting(UART_Interface_t uartInterface, UART_BaudSetting_t baudSetting, UART_SpiMode_t mode, UART_SpiDataOrder_t dataOrder) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	uint16_t ubrrValue = baudSetting & 0x0FFF;
+	_uart_spiWait(hardware);
+	
+	// Initialization sequence of the datasheet: UBRRn has to be zero while the transmitter is enabled
+	_UART_REGISTER(baudRateRegisterH) = 0;
+	_UART_REGISTER(baudRateRegisterL) = 0;
+	SETBIT(*hardware->xckDirectionRegister, hardware->xckBit);
+	
+	_UART_REGISTER(ctrlRegisterC) = (1 << UMSEL01) | (1 << UMSEL00)
+		| (dataOrder << _UART_UDORD) | ((mode & 1) << _UART_UCPHA) | ((mode >> 1) << UCPOL0);
+	// The receiver and transmitter are enabled without interrupts, the receive interrupt is only used by background transfers
+	_UART_REGISTER(ctrlRegisterB) = (1 << RXEN0) | (1 << TXEN0);
+	CLEARBIT(_UART_REGISTER(ctrlRegisterA), U2X0);
+	if(hardware->txBuffer) buffer_clear(hardware->txBuffer);
+	hardware->spi->enabled = true;
+	
+	_UART_REGISTER(baudRateRegisterH) = ubrrValue >> 8;
+	_UART_REGISTER(baudRateRegisterL) = ubrrValue & 0xFF;
+}
+
+void uart_spiTransfer(UART_Interface_t uartInterface, const uint8_t* tx, uint8_t* rx, size_t n) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	_uart_spiPrepare(hardware);
+	_uart_spiTransferPolled(hardware, tx, rx, n);
+}
+
+uint8_t uart_spiTransferByte(UART_Interface_t uartInterface, uint8_t data) {
+	uart_spiTransfer(uartInterface, &data, &data, 1);
+	return data;
+}
+
+void uart_spiTransferAsync(UART_Interface_t uartInterface, const uint8_t* tx, uint8_t* rx, size_t n) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	_UART_Spi_t* spi = hardware->spi;
+	_uart_spiPrepare(hardware);
+	
+	if(n == 0 || !CHECKBIT(SREG, SREG_I)) {
+		// The receive interrupt can't run, transfer the block synchronously
+		_uart_spiTransferPolled(hardware, tx, rx, n);
+		_SCHEDULER_SIGNAL(SCHEDULER_EVENT_UART_TX(hardware->number));
+		return;
+	}
+	
+	spi->tx = tx;
+	spi->rx = rx;
+	spi->length = n;
+	spi->sent = 0;
+	spi->received = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// Fill the shift register and the data register, the receive interrupt queues the rest
+		_uart_spiQueue(hardware, spi);
+		if(n > 1) {
+			while(!CHECKBIT(_UART_REGISTER(ctrlRegisterA), UDRE0));
+			_uart_spiQueue(hardware, spi);
+		}
+		spi->busy = true;
+		SETBIT(_UART_REGISTER(ctrlRegisterB), RXCIE0);
+	}
+}
+
+bool uart_spiBusy(UART_Interface_t uartInterface) {
+	return _uart_getHardware(uartInterface)->spi->busy;
+}
+
+void uart_spiWait(UART_Interface_t uartInterface) {
+	_uart_spiWait(_uart_getHardware(uartInterface));
+}
+#endif
+
+bool uart_rxOverflowed(UART_Interface_t uartInterface) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	
+	bool overflowed;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		overflowed = *hardware->rxOverflowed;
+		*hardware->rxOverflowed = false;
+	}
+	return overflowed;
+}
+
+Buffer_t* uart_txReserve(UART_Interface_t uartInterface, uint8_t n) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	Buffer_t* txBuffer = hardware->txBuffer;
+	
+	if(!txBuffer) {
+		throwMessage(ERR_INVALID_INTERFACE, "uart_txReserve: The UART interface has no transmit buffer.");
+	}
+	if(n > txBuffer->mask + 1) {
+		throwMessage(ERR_BUFFER_OVERFLOW, "uart_txReserve: The block is larger than the transmit buffer.");
+	}
+	
+	while(buffer_space(txBuffer) < n) {
+		// Without interrupts, free up space by sending the queued bytes synchronously
+		if(!CHECKBIT(SREG, SREG_I) && CHECKBIT(_UART_REGISTER(ctrlRegisterA), UDRE0)) {
+			_uart_writeDataRegister(hardware, buffer_get(txBuffer));
+		}
+	}
+	return txBuffer;
+}
+
+void uart_txCommit(UART_Interface_t uartInterface, uint8_t n) {
+	const _UART_Hardware_t* hardware = _uart_getHardware(uartInterface);
+	
+	buffer_commit(hardware->txBuffer, n);
+	if(CHECKBIT(SREG, SREG_I)) {
+		SETBIT(_UART_REGISTER(ctrlRegisterB), UDRIE0);
+	} else {
+		// The UDRE interrupt can't run, send the block synchronously
+		_uart_drainPolled(hardware);
+	}
+}
+
+/**
+ * @brief Dispatches a call to the interface-specific function `uartN_<function>` of the
+ * given interface. This requires for `uartInterface` to be declared in the parent scope.
+ * 
+ * @p prefix is put in front of the call, i.e. pass `return` to return the result of the
+ * call or leave it empty for functions without a return value.
+ */
+#define _UART_DISPATCH(prefix, function, ...) \
+	switch(uartInterface) { \
+		_UART0_CASE(prefix, function, ##__VA_ARGS__) \
+		_UART1_CASE(prefix, function, ##__VA_ARGS__) \
+		_UART2_CASE(prefix, function, ##__VA_ARGS__) \
+		_UART3_CASE(prefix, function, ##__VA_ARGS__) \
+		default: throwMessage(ERR_INVALID_INTERFACE, "uart: The UART interface is not enabled."); \
+	}
+
+#if UART0_ENABLED
+#define _UART0_CASE(prefix, function, ...) case UART0: prefix uart0_##function(__VA_ARGS__); break;
+#else
+#define _UART0_CASE(prefix, function, ...)
+#endif
+#if UART1_ENABLED
+#define _UART1_CASE(prefix, function, ...) case UART1: prefix uart1_##function(__VA_ARGS__); break;
+#else
+#define _UART1_CASE(prefix, function, ...)
+#endif
+#if UART2_ENABLED
+#define _UART2_CASE(prefix, function, ...) case UART2: prefix uart2_##function(__VA_ARGS__); break;
+#else
+#define _UART2_CASE(prefix, function, ...)
+#endif
+#if UART3_ENABLED
+#define _UART3_CASE(prefix, function, ...) case UART3: prefix uart3_##function(__VA_ARGS__); break;
+#else
+#define _UART3_CASE(prefix, function, ...)
+#endif
 
 bool uart_available(UART_Interface_t uartInterface) {
-	return !buffer_empty(&_uartBuffers[uartInterface]);
+	_UART_DISPATCH(return, available);
+	return false;
 }
 
 void uart_sendByte(UART_Interface_t uartInterface, uint8_t data) {
-	// Wait for the data register to be empty
-	while(!CHECKBIT(_UART_REGISTER(_CTRL_REGISTER_A), UDRE0));
-	_UART_REGISTER(_DATA_REGISTER) = data;
+	_UART_DISPATCH(, sendByte, data);
+}
+
+void uart_write(UART_Interface_t uartInterface, const uint8_t* data, size_t length) {
+	_UART_DISPATCH(, write, data, length);
+}
+
+uint8_t uart_txBytesFree(UART_Interface_t uartInterface) {
+	_UART_DISPATCH(return, txBytesFree);
+	return 0;
+}
+
+void uart_flush(UART_Interface_t uartInterface) {
+	_UART_DISPATCH(, flush);
 }
 
 void uart_sendString(UART_Interface_t uartInterface, uint8_t* s) {
@@ -190,29 +1199,23 @@ void uart_sendString(UART_Interface_t uartInterface, uint8_t* s) {
 }
 
 uint8_t uart_readByte(UART_Interface_t uartInterface) {
-	while(!uart_available(uartInterface));
-	uint8_t data = buffer_get(&_uartBuffers[uartInterface]);
-	return data;
+	_UART_DISPATCH(return, readByte);
+	return 0;
 }
 
-// Interrupt service routines which store the received data
-// in the interface-specific receive buffers.
-ISR(USART0_RX_vect) {
-	uint8_t rxData = UDR0;
-	buffer_put(&_uartBuffers[0], rxData);
+size_t uart_read(UART_Interface_t uartInterface, uint8_t* dst, size_t length, uint16_t timeout) {
+	_UART_DISPATCH(return, read, dst, length, timeout);
+	return 0;
 }
 
-ISR(USART1_RX_vect) {
-	uint8_t rxData = UDR1;
-	buffer_put(&_uartBuffers[1], rxData);
+#if UART_LINE_DETECTION
+uint8_t uart_linesAvailable(UART_Interface_t uartInterface) {
+	_UART_DISPATCH(return, linesAvailable);
+	return 0;
 }
 
-ISR(USART2_RX_vect) {
-	uint8_t rxData = UDR2;
-	buffer_put(&_uartBuffers[2], rxData);
+size_t uart_readUntil(UART_Interface_t uartInterface, uint8_t delimiter, uint8_t* dst, size_t max) {
+	_UART_DISPATCH(return, readUntil, delimiter, dst, max);
+	return 0;
 }
-
-ISR(USART3_RX_vect) {
-	uint8_t rxData = UDR3;
-	buffer_put(&_uartBuffers[3], rxData);
-}
\ No newline at end of file
+#endif
@@ -5,6 +5,9 @@
  */
 #include <elob/elob.h>
 #include <elob/util/binary.h>
+#include <elob/util/profile.h>
+#include <elob/util/scheduler.h>
+#include <elob/drivers/input.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
@@ -19,6 +22,21 @@ void elob_init()
 	SETBIT(DDRB, 6);
 	SETBIT(DDRB, 7);
 
+#if PROFILE_ENABLED
+	// Start the profiling timer
+	profile_init();
+#endif
+
+#if SCHEDULER_ENABLED
+	// Start the tick timer of the event loop
+	scheduler_init();
+#endif
+
+#if INPUT_ENABLED
+	// Start sampling the switches and buttons
+	input_init();
+#endif
+
 	// Enable interrupts globally
 	sei();
 }
\ No newline at end of file
@@ -6,40 +6,153 @@
 
 #include <elob/util/buffer.h>
 #include <elob/util/error.h>
+#include <string.h>
+
+/**
+ * @brief Compiler memory barrier. Ensures the data access to the internal array
+ * is not reordered across the update of the head/tail index.
+ * 
+ */
+#define _BUFFER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+void buffer_init(Buffer_t* buffer, uint8_t* storage, uint8_t size) {
+	buffer->type = BUFFER_TYPE_FIFO;
+	buffer->head = 0;
+	buffer->tail = 0;
+	buffer->mask = size - 1;
+	buffer->ptr = storage;
+}
 
 void buffer_put(Buffer_t* buffer, uint8_t data) {
-	if(buffer_full(buffer)) {
+	uint8_t head = buffer->head;
+	if((uint8_t)(head - buffer->tail) > buffer->mask) {
 		throwMessage(ERR_BUFFER_OVERFLOW, "buffer_put: Buffer too long.");
 	}
 	
-	// Add the element to the end of the buffer
-	buffer->ptr[buffer->size] = data;
-	buffer->size++;
+	// Store the element first and only then publish it to the consumer
+	buffer->ptr[head & buffer->mask] = data;
+	_BUFFER_BARRIER();
+	buffer->head = head + 1;
+}
+
+bool buffer_tryPut(Buffer_t* buffer, uint8_t data) {
+	uint8_t head = buffer->head;
+	if((uint8_t)(head - buffer->tail) > buffer->mask) {
+		return false;
+	}
+	
+	buffer->ptr[head & buffer->mask] = data;
+	_BUFFER_BARRIER();
+	buffer->head = head + 1;
+	return true;
+}
+
+bool buffer_putOverwrite(Buffer_t* buffer, uint8_t data) {
+	uint8_t head = buffer->head;
+	bool full = (uint8_t)(head - buffer->tail) > buffer->mask;
+	if(full) {
+		// Discard the oldest element
+		buffer->tail++;
+	}
+	
+	buffer->ptr[head & buffer->mask] = data;
+	_BUFFER_BARRIER();
+	buffer->head = head + 1;
+	return !full;
 }
 
 bool buffer_empty(Buffer_t* buffer) {
-	return buffer->size == 0;
+	return buffer->head == buffer->tail;
 }
 
 bool buffer_full(Buffer_t* buffer) {
-	return buffer->size >= buffer->maxSize;
+	return (uint8_t)(buffer->head - buffer->tail) > buffer->mask;
+}
+
+uint8_t buffer_count(Buffer_t* buffer) {
+	return buffer->head - buffer->tail;
+}
+
+uint8_t buffer_space(Buffer_t* buffer) {
+	return (buffer->mask + 1) - (uint8_t)(buffer->head - buffer->tail);
+}
+
+void buffer_poke(Buffer_t* buffer, uint8_t offset, uint8_t data) {
+	buffer->ptr[(uint8_t)(buffer->head + offset) & buffer->mask] = data;
+}
+
+void buffer_commit(Buffer_t* buffer, uint8_t n) {
+	// Publish the elements only after they were stored
+	_BUFFER_BARRIER();
+	buffer->head += n;
 }
 
 uint8_t buffer_get(Buffer_t* buffer) {
-	if(buffer_empty(buffer)) {
+	uint8_t tail = buffer->tail;
+	if(buffer->head == tail) {
 		throwMessage(ERR_BUFFER_OVERFLOW, "buffer_get: Buffer empty.");
 	}
 	
-	// Get the element from the beginning of the buffer
-	buffer->size--;
-	uint8_t data = buffer->ptr[0];
-	
-	// Shift the remaining bytes one to the left
-	memmove(buffer->ptr, buffer->ptr + 1, buffer->size);
+	// Read the element first and only then release the slot to the producer
+	_BUFFER_BARRIER();
+	uint8_t data = buffer->ptr[tail & buffer->mask];
+	_BUFFER_BARRIER();
+	buffer->tail = tail + 1;
 	
 	return data;
 }
 
+size_t buffer_write(Buffer_t* buffer, const uint8_t* src, size_t n) {
+	uint8_t head = buffer->head;
+	uint8_t space = (buffer->mask + 1) - (uint8_t)(head - buffer->tail);
+	if(n > space) n = space;
+	
+	// Copy the part up to the end of the internal array, then the wrapped-around rest
+	uint8_t start = head & buffer->mask;
+	size_t firstChunk = (buffer->mask + 1) - start;
+	if(firstChunk > n) firstChunk = n;
+	memcpy(buffer->ptr + start, src, firstChunk);
+	memcpy(buffer->ptr, src + firstChunk, n - firstChunk);
+	
+	_BUFFER_BARRIER();
+	buffer->head = head + n;
+	return n;
+}
+
+size_t buffer_read(Buffer_t* buffer, uint8_t* dst, size_t n) {
+	uint8_t tail = buffer->tail;
+	uint8_t count = buffer->head - tail;
+	if(n > count) n = count;
+	
+	// Copy the part up to the end of the internal array, then the wrapped-around rest
+	_BUFFER_BARRIER();
+	uint8_t start = tail & buffer->mask;
+	size_t firstChunk = (buffer->mask + 1) - start;
+	if(firstChunk > n) firstChunk = n;
+	memcpy(dst, buffer->ptr + start, firstChunk);
+	memcpy(dst + firstChunk, buffer->ptr, n - firstChunk);
+	
+	_BUFFER_BARRIER();
+	buffer->tail = tail + n;
+	return n;
+}
+
+size_t buffer_find(Buffer_t* buffer, uint8_t value, uint8_t offset, size_t n) {
+	uint8_t start = (uint8_t)(buffer->tail + offset) & buffer->mask;
+	
+	// Search the part up to the end of the internal array, then the wrapped-around rest
+	_BUFFER_BARRIER();
+	size_t firstChunk = (buffer->mask + 1) - start;
+	if(firstChunk > n) firstChunk = n;
+	const uint8_t* match = memchr(buffer->ptr + start, value, firstChunk);
+	if(match != NULL) return offset + (match - (buffer->ptr + start)) + 1;
+	
+	match = memchr(buffer->ptr, value, n - firstChunk);
+	if(match != NULL) return offset + firstChunk + (match - buffer->ptr) + 1;
+	
+	return 0;
+}
+
 void buffer_clear(Buffer_t* buffer) {
-	buffer->size = 0;
-}
\ No newline at end of file
+	buffer->tail = buffer->head;
+}
@@ -4,14 +4,72 @@
  * @brief Source file for @ref error.h.
  */
 #include <elob/util/error.h>
+#include <elob/util/error_log.h>
 #include <elob/util/binary.h>
 #include <elob/util/terminal.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/wdt.h>
 #include <stdio.h>
 
 jmp_buf _error_h_globalJmpBuffer;
 
+/**
+ * @brief Names of the error codes of @ref ErrorCode_t, stored in flash.
+ * 
+ */
+static const char _error_codeNameNone[] PROGMEM = "ERR_NONE";
+static const char _error_codeNameStrTooLong[] PROGMEM = "ERR_STR_TOO_LONG";
+static const char _error_codeNameBitrateTooLow[] PROGMEM = "ERR_BITRATE_TOO_LOW";
+static const char _error_codeNameI2cTransmission[] PROGMEM = "ERR_I2C_TRANSMISSION";
+static const char _error_codeNameBufferOverflow[] PROGMEM = "ERR_BUFFER_OVERFLOW";
+static const char _error_codeNameOutOfRange[] PROGMEM = "ERR_OUT_OF_RANGE";
+static const char _error_codeNameInvalidStr[] PROGMEM = "ERR_INVALID_STR";
+static const char _error_codeNameInvalidUnit[] PROGMEM = "ERR_INVALID_UNIT";
+static const char _error_codeNamePrecisionViolated[] PROGMEM = "ERR_PRECISION_VIOLATED";
+static const char _error_codeNameInvalidInterface[] PROGMEM = "ERR_INVALID_INTERFACE";
+static const char _error_codeNameI2cTimeout[] PROGMEM = "ERR_I2C_TIMEOUT";
+
+/**
+ * @brief Table of the error code names, indexed by the error code.
+ * 
+ */
+static PGM_P const _error_codeNames[] PROGMEM = {
+	_error_codeNameNone,
+	_error_codeNameStrTooLong,
+	_error_codeNameBitrateTooLow,
+	_error_codeNameI2cTransmission,
+	_error_codeNameBufferOverflow,
+	_error_codeNameOutOfRange,
+	_error_codeNameInvalidStr,
+	_error_codeNameInvalidUnit,
+	_error_codeNamePrecisionViolated,
+	_error_codeNameInvalidInterface,
+	_error_codeNameI2cTimeout
+};
+
+// Make sure every error code has a name
+typedef char _error_codeNamesComplete[(sizeof(_error_codeNames) / sizeof(_error_codeNames[0]) == ERR_I2C_TIMEOUT + 1) ? 1 : -1];
+
+PGM_P error_codeName(unsigned int code) {
+	if(code >= sizeof(_error_codeNames) / sizeof(_error_codeNames[0])) return PSTR("ERR_UNKNOWN");
+	return (PGM_P)pgm_read_word(&_error_codeNames[code]);
+}
+
+#if ERROR_LOG_WATCHDOG_RESET
+/**
+ * @brief Disables the watchdog right after a reset, before the C runtime is initialized.
+ * 
+ * The watchdog stays enabled at its shortest timeout after a watchdog reset. Waiting for
+ * @ref error_init would reset the board again if the startup takes longer than that.
+ */
+static void _error_disableWatchdog() __attribute__((naked, used, section(".init3")));
+static void _error_disableWatchdog() {
+	MCUSR = 0;
+	wdt_disable();
+}
+#endif
+
 void error_init() {
 	// Set the default jmp_buf to the global jmp_buf
 	_error_h_currentJmpBuf = &_error_h_globalJmpBuffer;
@@ -23,7 +81,7 @@ void error_init() {
 	}
 }
 
-void _error_h_throw(unsigned int errorCode, const char* errorName, const char* errorMessage, int line, const char* file, const char* functionName) {
+void _error_h_throw(unsigned int errorCode, PGM_P errorName, PGM_P errorMessage, int line, PGM_P file, const char* functionName) {
 	// Store the error name and message in the global variables
 	_error_h_currentError.code = errorCode;
 	_error_h_currentError.name = errorName;
@@ -32,6 +90,9 @@ void _error_h_throw(unsigned int errorCode, const char* errorName, const char* e
 	_error_h_currentError.file = file;
 	_error_h_currentError.functionName = functionName;
 	
+	// Keep a record of every error, even if it is caught later
+	_error_log_record(errorCode, line, file);
+	
 	// Jump to the error handler
 	longjmp(_error_h_currentJmpBuf, errorCode);
 }
@@ -46,13 +107,34 @@ void _error_h_uncaughtErrorHandler() {
 	CLEARBIT(PORTB, 6);
 	CLEARBIT(PORTB, 7);
 	
-	error_print(_error_h_currentError);
+	// Persisting may throw and overwrite the current error, so keep a copy
+	Error_t error = _error_h_currentError;
+	
+	// Persist the error log first, printing over the UART may take a while
+	try {
+		error_log_persist();
+	} catch {
+		// The error was recorded, but can't be persisted anyway
+	}
+	
+	error_print(error);
 	
 	// Inform the user that the error was not caught
-	terminal_setStyle(TERMINAL_STYLE_DIM);
-	fprintf(stderr, "Error thrown in file '%s' in function '%s' (on line %d)\r\n", _error_h_currentError.file, _error_h_currentError.functionName, _error_h_currentError.line);
-	fprintf(stderr, "The above error was not caught.\r\n");
-	fprintf(stderr, "Reset the board to continue operation.\r\n");
+	terminal_apply(TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT, TERMINAL_STYLE_DIM);
+	if(error.functionName != NULL) {
+		fprintf_P(stderr, PSTR("Error thrown in file '%S' in function '%s' (on line %d)\r\n"), error.file, error.functionName, error.line);
+	} else {
+		fprintf_P(stderr, PSTR("Error thrown in file '%S' (on line %d)\r\n"), error.file, error.line);
+	}
+	fputs_P(PSTR("The above error was not caught.\r\n"), stderr);
+#if ERROR_LOG_WATCHDOG_RESET
+	fputs_P(PSTR("Resetting the board.\r\n"), stderr);
+	
+	// Let the watchdog reset the microcontroller
+	wdt_enable(WDTO_15MS);
+#else
+	fputs_P(PSTR("Reset the board to continue operation.\r\n"), stderr);
+#endif
 	
 	// Enter an infinite loop
 	while(1);
@@ -64,12 +146,14 @@ void error_rethrow(Error_t errorStruct) {
 
 void error_print(Error_t errorStruct) {
 	// Print the error information to stderr
-	terminal_setStyle(TERMINAL_STYLE_RESET);
-	fprintf(stderr, "\r\n");
-	terminal_setColors(TERMINAL_CLR_BLACK, TERMINAL_CLR_RED);
-	fprintf(stderr, " %s ", errorStruct.name);
-	terminal_setStyle(TERMINAL_STYLE_RESET);
-	terminal_setStyle(TERMINAL_STYLE_BOLD);
-	fprintf(stderr, " %s\r\n", errorStruct.message);
-	terminal_setStyle(TERMINAL_STYLE_RESET);
+	terminal_apply(TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT, TERMINAL_STYLE_RESET);
+	fputs_P(PSTR("\r\n"), stderr);
+	terminal_apply(TERMINAL_CLR_BLACK, TERMINAL_CLR_RED, TERMINAL_STYLE_RESET);
+	fprintf_P(stderr, PSTR(" %S "), errorStruct.name);
+	terminal_apply(TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT, TERMINAL_STYLE_BOLD);
+	if(errorStruct.message != NULL) {
+		fprintf_P(stderr, PSTR(" %S"), errorStruct.message);
+	}
+	fputs_P(PSTR("\r\n"), stderr);
+	terminal_apply(TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT, TERMINAL_STYLE_RESET);
 }
\ No newline at end of file
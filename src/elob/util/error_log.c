@@ -0,0 +1,227 @@
+/**
+ * @file error_log.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref error_log.h.
+ */
+#include <elob/util/error_log.h>
+#include <elob/util/error.h>
+#include <elob/drivers/ds1307.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include <string.h>
+
+/**
+ * @brief Marker of a valid persisted error log.
+ * 
+ */
+#define _ERROR_LOG_MAGIC 0xE7
+
+/**
+ * @brief Size of the header of the persisted error log (marker and number of records).
+ * 
+ */
+#define _ERROR_LOG_HEADER_SIZE 2
+
+#if ERROR_LOG_STORAGE == ERROR_LOG_STORAGE_DS1307
+// The header and at least one record (10 bytes) have to fit into the RAM
+#if ERROR_LOG_DS1307_OFFSET + _ERROR_LOG_HEADER_SIZE + 10 > DS1307_RAM_SIZE
+#error "ERROR_LOG_DS1307_OFFSET leaves no space for the error log in the DS1307 RAM."
+#endif
+
+/**
+ * @brief Number of records fitting into the battery-backed RAM of the DS1307.
+ * 
+ */
+#define _ERROR_LOG_STORAGE_CAPACITY ((DS1307_RAM_SIZE - ERROR_LOG_DS1307_OFFSET - _ERROR_LOG_HEADER_SIZE) / sizeof(ErrorRecord_t))
+#else
+#define _ERROR_LOG_STORAGE_CAPACITY ERROR_LOG_SIZE
+#endif
+
+/**
+ * @brief Number of records which are persisted.
+ * 
+ */
+#define _ERROR_LOG_PERSISTED_COUNT (_ERROR_LOG_STORAGE_CAPACITY < ERROR_LOG_SIZE ? _ERROR_LOG_STORAGE_CAPACITY : ERROR_LOG_SIZE)
+
+#if ERROR_LOG_SIZE > 0
+/**
+ * @brief The ring of records in SRAM.
+ * 
+ */
+static ErrorRecord_t _error_log_records[ERROR_LOG_SIZE];
+
+/**
+ * @brief Index the next record is written to.
+ * 
+ */
+static uint8_t _error_log_head = 0;
+
+/**
+ * @brief Number of records in the ring.
+ * 
+ */
+static uint8_t _error_log_count = 0;
+#endif
+
+void _error_log_record(unsigned int code, unsigned int line, PGM_P file) {
+#if ERROR_LOG_SIZE > 0
+#if DS1307_CACHED_CLOCK
+	time_t timestamp = DS1307_getCachedDatetime();
+#else
+	time_t timestamp = 0;
+#endif
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ErrorRecord_t* record = &_error_log_records[_error_log_head];
+		record->code = code;
+		record->line = line;
+		record->fileId = (uint16_t)file;
+		record->timestamp = timestamp;
+		
+		_error_log_head = (_error_log_head + 1) & (ERROR_LOG_SIZE - 1);
+		if(_error_log_count < ERROR_LOG_SIZE) _error_log_count++;
+	}
+#endif
+}
+
+uint8_t error_log_count() {
+#if ERROR_LOG_SIZE > 0
+	return _error_log_count;
+#else
+	return 0;
+#endif
+}
+
+bool error_log_get(uint8_t index, ErrorRecord_t* record) {
+#if ERROR_LOG_SIZE > 0
+	bool exists = false;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(index < _error_log_count) {
+			*record = _error_log_records[(_error_log_head - 1 - index) & (ERROR_LOG_SIZE - 1)];
+			exists = true;
+		}
+	}
+	return exists;
+#else
+	return false;
+#endif
+}
+
+void error_log_clear() {
+#if ERROR_LOG_SIZE > 0
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		_error_log_count = 0;
+	}
+#endif
+}
+
+/**
+ * @brief Writes a block to the storage of the persisted error log.
+ * 
+ * @param offset The offset within the persisted error log.
+ * @param src The data to write.
+ * @param n The number of bytes to write.
+ */
+static inline void _error_log_write(uint8_t offset, const void* src, uint8_t n) {
+#if ERROR_LOG_STORAGE == ERROR_LOG_STORAGE_EEPROM
+	eeprom_update_block(src, (void*)(ERROR_LOG_EEPROM_ADDRESS + offset), n);
+#elif ERROR_LOG_STORAGE == ERROR_LOG_STORAGE_DS1307
+	// Polling works even if the error handler disabled the interrupts
+	DS1307_writeRAMPolled(ERROR_LOG_DS1307_OFFSET + offset, src, n);
+#endif
+}
+
+/**
+ * @brief Reads a block from the storage of the persisted error log.
+ * 
+ * @param offset The offset within the persisted error log.
+ * @param dst The buffer to read to.
+ * @param n The number of bytes to read.
+ */
+static void _error_log_read(uint8_t offset, void* dst, uint8_t n) {
+#if ERROR_LOG_STORAGE == ERROR_LOG_STORAGE_EEPROM
+	eeprom_read_block(dst, (const void*)(ERROR_LOG_EEPROM_ADDRESS + offset), n);
+#elif ERROR_LOG_STORAGE == ERROR_LOG_STORAGE_DS1307
+	DS1307_readRAM(ERROR_LOG_DS1307_OFFSET + offset, dst, n);
+#else
+	memset(dst, 0, n);
+#endif
+}
+
+void error_log_persist() {
+#if ERROR_LOG_STORAGE != ERROR_LOG_STORAGE_NONE && ERROR_LOG_SIZE > 0
+	uint8_t count = 0;
+	ErrorRecord_t record;
+	while(count < _ERROR_LOG_PERSISTED_COUNT && error_log_get(count, &record)) {
+		_error_log_write(_ERROR_LOG_HEADER_SIZE + count * sizeof(ErrorRecord_t), &record, sizeof(ErrorRecord_t));
+		count++;
+	}
+	
+	// Write the header last, so an interrupted write doesn't leave a valid log with invalid records
+	uint8_t header[_ERROR_LOG_HEADER_SIZE] = { _ERROR_LOG_MAGIC, count };
+	_error_log_write(0, header, _ERROR_LOG_HEADER_SIZE);
+#endif
+}
+
+/**
+ * @brief Reads the header of the persisted error log.
+ * 
+ * @return The number of persisted records, 0 if there is no valid log.
+ */
+static uint8_t _error_log_persistedCount() {
+	uint8_t header[_ERROR_LOG_HEADER_SIZE];
+	_error_log_read(0, header, _ERROR_LOG_HEADER_SIZE);
+	if(header[0] != _ERROR_LOG_MAGIC) return 0;
+	
+	return header[1] < _ERROR_LOG_PERSISTED_COUNT ? header[1] : _ERROR_LOG_PERSISTED_COUNT;
+}
+
+uint8_t error_log_loadPersisted(ErrorRecord_t* records, uint8_t max) {
+	uint8_t count = _error_log_persistedCount();
+	if(count > max) count = max;
+	
+	for(uint8_t i = 0; i < count; i++) {
+		_error_log_read(_ERROR_LOG_HEADER_SIZE + i * sizeof(ErrorRecord_t), &records[i], sizeof(ErrorRecord_t));
+	}
+	return count;
+}
+
+void error_log_clearPersisted() {
+#if ERROR_LOG_STORAGE != ERROR_LOG_STORAGE_NONE
+	uint8_t header[_ERROR_LOG_HEADER_SIZE] = { 0, 0 };
+	_error_log_write(0, header, _ERROR_LOG_HEADER_SIZE);
+#endif
+}
+
+/**
+ * @brief Prints a single record.
+ * 
+ * @param stream The stream to print to.
+ * @param record The record to print.
+ * @param resolveFile Whether the file ID is valid in this firmware and can be printed as the file name.
+ */
+static void _error_log_printRecord(FILE* stream, const ErrorRecord_t* record, bool resolveFile) {
+	fprintf_P(stream, PSTR("[%lu] %S (%u) in "), (unsigned long)record->timestamp, error_codeName(record->code), record->code);
+	if(resolveFile) {
+		fprintf_P(stream, PSTR("'%S'"), (PGM_P)record->fileId);
+	} else {
+		fprintf_P(stream, PSTR("file 0x%04X"), record->fileId);
+	}
+	fprintf_P(stream, PSTR(" on line %u\r\n"), record->line);
+}
+
+void error_log_print(FILE* stream) {
+	ErrorRecord_t record;
+	for(uint8_t i = 0; error_log_get(i, &record); i++) {
+		_error_log_printRecord(stream, &record, true);
+	}
+}
+
+void error_log_printPersisted(FILE* stream) {
+	ErrorRecord_t record;
+	uint8_t count = _error_log_persistedCount();
+	for(uint8_t i = 0; i < count; i++) {
+		_error_log_read(_ERROR_LOG_HEADER_SIZE + i * sizeof(ErrorRecord_t), &record, sizeof(ErrorRecord_t));
+		_error_log_printRecord(stream, &record, false);
+	}
+}
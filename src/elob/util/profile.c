@@ -0,0 +1,76 @@
+/**
+ * @file profile.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref profile.h.
+ */
+#include <elob/util/profile.h>
+#include <elob/util/usb_terminal.h>
+#include <avr/pgmspace.h>
+#include <stdio.h>
+#include <string.h>
+
+#if PROFILE_ENABLED
+ProfileProbe_t _profile_probes[PROFILE_PROBES];
+
+/**
+ * @brief Names of the library probes, stored in flash.
+ * 
+ */
+static const char _profile_nameUartRxIsr[] PROGMEM = "uart RX ISR";
+static const char _profile_nameI2cTransaction[] PROGMEM = "i2c_master transaction";
+static const char _profile_nameDs1307GetDatetime[] PROGMEM = "DS1307_getDatetime";
+static const char _profile_nameSiToString[] PROGMEM = "SI_toString";
+
+/**
+ * @brief Table of the library probe names, indexed by the probe ID.
+ * 
+ */
+static PGM_P const _profile_names[PROFILE_LIBRARY_PROBES] PROGMEM = {
+	_profile_nameUartRxIsr,
+	_profile_nameI2cTransaction,
+	_profile_nameDs1307GetDatetime,
+	_profile_nameSiToString
+};
+
+void profile_init() {
+	// Normal mode, free-running at F_CPU / 8
+	_PROFILE_TCCRA = 0;
+	_PROFILE_TCCRB = _PROFILE_CLOCK_SELECT;
+	
+	profile_reset();
+}
+
+void profile_reset() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		memset(_profile_probes, 0, sizeof(_profile_probes));
+	}
+}
+
+void profile_get(uint8_t id, ProfileProbe_t* probe) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*probe = _profile_probes[id];
+	}
+}
+
+void profile_dump() {
+	fputs_P(PSTR("probe                    count   min [cyc]   avg [cyc]   max [cyc]\r\n"), usb_terminal_f);
+	
+	for(uint8_t id = 0; id < PROFILE_PROBES; id++) {
+		ProfileProbe_t probe;
+		profile_get(id, &probe);
+		if(probe.count == 0) continue;
+		
+		if(id < PROFILE_LIBRARY_PROBES) {
+			fprintf_P(usb_terminal_f, PSTR("%-24S"), (PGM_P)pgm_read_word(&_profile_names[id]));
+		} else {
+			fprintf_P(usb_terminal_f, PSTR("app %-20u"), id - PROFILE_LIBRARY_PROBES);
+		}
+		fprintf_P(usb_terminal_f, PSTR(" %5u %11lu %11lu %11lu\r\n"),
+			probe.count,
+			(unsigned long)probe.min * PROFILE_CYCLES_PER_TICK,
+			probe.total / probe.count * PROFILE_CYCLES_PER_TICK,
+			(unsigned long)probe.max * PROFILE_CYCLES_PER_TICK
+		);
+	}
+}
+#endif
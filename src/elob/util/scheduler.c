@@ -0,0 +1,279 @@
+/**
+ * @file scheduler.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref scheduler.h.
+ */
+#include <elob/util/scheduler.h>
+#include <elob/util/error.h>
+#include <elob/drivers/i2c_master.h>
+#include <elob/elob.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <string.h>
+
+#if SCHEDULER_ENABLED
+/**
+ * @brief Timer compare value for a tick of one millisecond at a prescaler of 64.
+ * 
+ */
+#define _SCHEDULER_COMPARE_VALUE (F_CPU / 64 / 1000 - 1)
+
+#if _SCHEDULER_COMPARE_VALUE > 255
+#error "F_CPU is too high for a one millisecond tick on an 8-bit timer."
+#endif
+
+#if SCHEDULER_TIMER == 0
+#define _SCHEDULER_TCCRA TCCR0A
+#define _SCHEDULER_TCCRB TCCR0B
+#define _SCHEDULER_OCRA OCR0A
+#define _SCHEDULER_TIMSK TIMSK0
+#define _SCHEDULER_CTC_MODE (1 << WGM01)
+#define _SCHEDULER_CLOCK_SELECT ((1 << CS01) | (1 << CS00))
+#define _SCHEDULER_INTERRUPT_ENABLE (1 << OCIE0A)
+#define _SCHEDULER_TIMER_VECT TIMER0_COMPA_vect
+#elif SCHEDULER_TIMER == 2
+#define _SCHEDULER_TCCRA TCCR2A
+#define _SCHEDULER_TCCRB TCCR2B
+#define _SCHEDULER_OCRA OCR2A
+#define _SCHEDULER_TIMSK TIMSK2
+#define _SCHEDULER_CTC_MODE (1 << WGM21)
+#define _SCHEDULER_CLOCK_SELECT (1 << CS22)
+#define _SCHEDULER_INTERRUPT_ENABLE (1 << OCIE2A)
+#define _SCHEDULER_TIMER_VECT TIMER2_COMPA_vect
+#else
+#error "SCHEDULER_TIMER has to be 0 or 2."
+#endif
+
+/**
+ * @brief Task flag: the task runs at its due time instead of on events.
+ * 
+ */
+#define _SCHEDULER_TASK_TIMED (1 << 0)
+/**
+ * @brief Task flag: the task is removed before it runs.
+ * 
+ */
+#define _SCHEDULER_TASK_ONESHOT (1 << 1)
+
+/**
+ * @brief Struct holding a registered task. The slot is free if @ref callback is `NULL`.
+ * 
+ */
+typedef struct {
+	/**
+	 * @brief Function executed by the task.
+	 */
+	SchedulerCallback_t callback;
+	/**
+	 * @brief Pointer passed to @ref callback.
+	 */
+	void* context;
+	/**
+	 * @brief Events the task waits for, if it isn't timed.
+	 */
+	Scheduler_Events_t events;
+	/**
+	 * @brief Period in milliseconds of a periodic task.
+	 */
+	uint16_t period;
+	/**
+	 * @brief Tick at which a timed task runs next.
+	 */
+	uint32_t due;
+	/**
+	 * @brief Flags of the task, see `_SCHEDULER_TASK_*`.
+	 */
+	uint8_t flags;
+} _Scheduler_Task_t;
+
+volatile Scheduler_Events_t _scheduler_events = 0;
+
+/**
+ * @brief Number of ticks since @ref scheduler_init.
+ * 
+ */
+static volatile uint32_t _scheduler_ticks = 0;
+
+/**
+ * @brief The task table.
+ * 
+ */
+static _Scheduler_Task_t _scheduler_tasks[SCHEDULER_MAX_TASKS];
+
+/**
+ * @brief Earliest due time of all timed tasks, only valid if @ref _scheduler_timedTasks is set.
+ * Lets @ref scheduler_idle decide whether to sleep without scanning the task table.
+ * 
+ */
+static uint32_t _scheduler_nextDue;
+
+/**
+ * @brief Whether there are timed tasks.
+ * 
+ */
+static bool _scheduler_timedTasks = false;
+
+/**
+ * @brief Interrupt service routine of the tick timer.
+ * 
+ */
+ISR(_SCHEDULER_TIMER_VECT) {
+	_scheduler_ticks++;
+	i2c_master_tick();
+}
+
+/**
+ * @brief Checks if the given tick was reached, also across the wrap-around of the tick counter.
+ * 
+ */
+static inline bool _scheduler_reached(uint32_t now, uint32_t tick) {
+	return (int32_t)(now - tick) >= 0;
+}
+
+/**
+ * @brief Takes the due time of a timed task into account for @ref _scheduler_nextDue.
+ * 
+ */
+static inline void _scheduler_updateNextDue(uint32_t due) {
+	if(!_scheduler_timedTasks || (int32_t)(due - _scheduler_nextDue) < 0) {
+		_scheduler_nextDue = due;
+		_scheduler_timedTasks = true;
+	}
+}
+
+/**
+ * @brief Registers a task in a free slot of the task table.
+ * 
+ * @exception ERR_BUFFER_OVERFLOW All slots are in use.
+ */
+static SchedulerTask_t _scheduler_add(SchedulerCallback_t callback, void* context, Scheduler_Events_t events, uint16_t period, uint16_t delay, uint8_t flags) {
+	for(SchedulerTask_t id = 0; id < SCHEDULER_MAX_TASKS; id++) {
+		_Scheduler_Task_t* task = &_scheduler_tasks[id];
+		if(task->callback != NULL) continue;
+		
+		task->context = context;
+		task->events = events;
+		task->period = period;
+		task->flags = flags;
+		if(flags & _SCHEDULER_TASK_TIMED) {
+			task->due = scheduler_millis() + delay;
+			_scheduler_updateNextDue(task->due);
+		}
+		// Setting the callback last marks the slot as used
+		task->callback = callback;
+		return id;
+	}
+	throwMessage(ERR_BUFFER_OVERFLOW, "scheduler: No free task slot.");
+	return SCHEDULER_NO_TASK;
+}
+
+void scheduler_init() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		memset(_scheduler_tasks, 0, sizeof(_scheduler_tasks));
+		_scheduler_timedTasks = false;
+		_scheduler_events = 0;
+		_scheduler_ticks = 0;
+		
+		// CTC mode at F_CPU / 64, interrupt on compare match
+		_SCHEDULER_TCCRA = _SCHEDULER_CTC_MODE;
+		_SCHEDULER_OCRA = _SCHEDULER_COMPARE_VALUE;
+		_SCHEDULER_TCCRB = _SCHEDULER_CLOCK_SELECT;
+		_SCHEDULER_TIMSK |= _SCHEDULER_INTERRUPT_ENABLE;
+	}
+	
+	set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+uint32_t scheduler_millis() {
+	uint32_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks = _scheduler_ticks;
+	}
+	return ticks;
+}
+
+SchedulerTask_t scheduler_every(uint16_t period, SchedulerCallback_t callback, void* context) {
+	assertMessage(period > 0, ERR_OUT_OF_RANGE, "scheduler_every: Period has to be at least 1 ms.");
+	return _scheduler_add(callback, context, 0, period, period, _SCHEDULER_TASK_TIMED);
+}
+
+SchedulerTask_t scheduler_after(uint16_t delay, SchedulerCallback_t callback, void* context) {
+	return _scheduler_add(callback, context, 0, 0, delay, _SCHEDULER_TASK_TIMED | _SCHEDULER_TASK_ONESHOT);
+}
+
+SchedulerTask_t scheduler_onEvent(Scheduler_Events_t events, SchedulerCallback_t callback, void* context) {
+	return _scheduler_add(callback, context, events, 0, 0, 0);
+}
+
+void scheduler_cancel(SchedulerTask_t task) {
+	// A stale due time only causes a spurious wake-up, so _scheduler_nextDue is left as it is
+	if(task < SCHEDULER_MAX_TASKS) {
+		_scheduler_tasks[task].callback = NULL;
+	}
+}
+
+bool scheduler_runPending() {
+	Scheduler_Events_t events;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// Events nobody waits for are dropped as well, so they don't keep the CPU awake
+		events = _scheduler_events;
+		_scheduler_events = 0;
+	}
+	uint32_t now = scheduler_millis();
+	bool ran = false;
+	
+	for(SchedulerTask_t id = 0; id < SCHEDULER_MAX_TASKS; id++) {
+		_Scheduler_Task_t* task = &_scheduler_tasks[id];
+		SchedulerCallback_t callback = task->callback;
+		if(callback == NULL) continue;
+		
+		if(task->flags & _SCHEDULER_TASK_TIMED) {
+			if(!_scheduler_reached(now, task->due)) continue;
+			
+			if(task->flags & _SCHEDULER_TASK_ONESHOT) {
+				task->callback = NULL;
+			} else {
+				task->due += task->period;
+				// Skip the missed periods instead of running the task repeatedly to catch up
+				if(_scheduler_reached(now, task->due)) task->due = now + task->period;
+			}
+		} else if(!(task->events & events)) {
+			continue;
+		}
+		
+		callback(task->context);
+		ran = true;
+	}
+	
+	// Tasks may have been added or removed by the callbacks
+	_scheduler_timedTasks = false;
+	for(SchedulerTask_t id = 0; id < SCHEDULER_MAX_TASKS; id++) {
+		_Scheduler_Task_t* task = &_scheduler_tasks[id];
+		if(task->callback != NULL && (task->flags & _SCHEDULER_TASK_TIMED)) {
+			_scheduler_updateNextDue(task->due);
+		}
+	}
+	return ran;
+}
+
+void scheduler_idle() {
+	cli();
+	bool ready = _scheduler_events != 0 || (_scheduler_timedTasks && _scheduler_reached(_scheduler_ticks, _scheduler_nextDue));
+	if(!ready) {
+		// The instruction after sei() is always executed, so an interrupt can't slip in before sleeping
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+	sei();
+}
+
+void scheduler_run() {
+	for(;;) {
+		scheduler_runPending();
+		scheduler_idle();
+	}
+}
+#endif
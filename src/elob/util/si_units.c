@@ -6,22 +6,47 @@
 
 #include <elob/util/si_units.h>
 #include <elob/util/error.h>
+#include <elob/util/profile.h>
+#include <avr/pgmspace.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
 
 // SI converter functions
 Quantity_t _SI_converter_none(Quantity_t, UnitConversionDirection_t);
 Quantity_t _SI_converter_db(Quantity_t, UnitConversionDirection_t);
 Quantity_t _SI_converter_gram(Quantity_t, UnitConversionDirection_t);
 
+// Unit names and abbreviations, stored in flash
+static const char _DIMENSIONLESS_name[] PROGMEM = "[Dimensionless]";
+static const char _DIMENSIONLESS_abbreviation[] PROGMEM = "";
+static const char _METER_name[] PROGMEM = "Meter";
+static const char _METER_abbreviation[] PROGMEM = "m";
+static const char _SECOND_name[] PROGMEM = "Second";
+static const char _SECOND_abbreviation[] PROGMEM = "s";
+static const char _GRAM_name[] PROGMEM = "Gram";
+static const char _GRAM_abbreviation[] PROGMEM = "g";
+static const char _KILOGRAM_name[] PROGMEM = "Kilogram";
+static const char _KILOGRAM_abbreviation[] PROGMEM = "kg";
+static const char _VOLT_name[] PROGMEM = "Volt";
+static const char _VOLT_abbreviation[] PROGMEM = "V";
+static const char _AMPERE_name[] PROGMEM = "Ampere";
+static const char _AMPERE_abbreviation[] PROGMEM = "A";
+static const char _OHM_name[] PROGMEM = "Ohm";
+static const char _OHM_abbreviation[] PROGMEM = "Ohm";
+static const char _DECIBELS_P_name[] PROGMEM = "Decibels";
+static const char _DECIBELS_P_abbreviation[] PROGMEM = "dB";
+
 // Internal unit structs
-const Unit_t _DIMENSIONLESS = { .name = "[Dimensionless]", .abbreviation = "", .converter = _SI_converter_none, .allowPrefixing = true };
-const Unit_t _METER = { .name = "Meter", .abbreviation = "m", .converter = _SI_converter_none, .allowPrefixing = true };
-const Unit_t _SECOND = { .name = "Second", .abbreviation = "s", .converter = _SI_converter_none, .allowPrefixing = true };
-const Unit_t _GRAM = { .name = "Gram", .abbreviation = "g", .converter = _SI_converter_gram, .allowPrefixing = true };
-const Unit_t _KILOGRAM = { .name = "Kilogram", .abbreviation = "kg", .converter = _SI_converter_none };
-const Unit_t _VOLT = { .name = "Volt", .abbreviation = "V", .converter = _SI_converter_none, .allowPrefixing = true };
-const Unit_t _AMPERE = { .name = "Ampere", .abbreviation = "A", .converter = _SI_converter_none, .allowPrefixing = true };
-const Unit_t _OHM = { .name = "Ohm", .abbreviation = "Ohm", .converter = _SI_converter_none, .allowPrefixing = true };
-const Unit_t _DECIBELS_P = { .name = "Decibels", .abbreviation = "dB", .converter = _SI_converter_db };
+const Unit_t _DIMENSIONLESS = { .name = _DIMENSIONLESS_name, .abbreviation = _DIMENSIONLESS_abbreviation, .converter = _SI_converter_none, .allowPrefixing = true };
+const Unit_t _METER = { .name = _METER_name, .abbreviation = _METER_abbreviation, .converter = _SI_converter_none, .allowPrefixing = true };
+const Unit_t _SECOND = { .name = _SECOND_name, .abbreviation = _SECOND_abbreviation, .converter = _SI_converter_none, .allowPrefixing = true };
+const Unit_t _GRAM = { .name = _GRAM_name, .abbreviation = _GRAM_abbreviation, .converter = _SI_converter_gram, .allowPrefixing = true };
+const Unit_t _KILOGRAM = { .name = _KILOGRAM_name, .abbreviation = _KILOGRAM_abbreviation, .converter = _SI_converter_none };
+const Unit_t _VOLT = { .name = _VOLT_name, .abbreviation = _VOLT_abbreviation, .converter = _SI_converter_none, .allowPrefixing = true };
+const Unit_t _AMPERE = { .name = _AMPERE_name, .abbreviation = _AMPERE_abbreviation, .converter = _SI_converter_none, .allowPrefixing = true };
+const Unit_t _OHM = { .name = _OHM_name, .abbreviation = _OHM_abbreviation, .converter = _SI_converter_none, .allowPrefixing = true };
+const Unit_t _DECIBELS_P = { .name = _DECIBELS_P_name, .abbreviation = _DECIBELS_P_abbreviation, .converter = _SI_converter_db };
 	
 // Unit struct pointers
 const Unit_t* const DIMENSIONLESS = &_DIMENSIONLESS;
@@ -60,6 +85,59 @@ Quantity_t _SI_converter_gram(Quantity_t input, UnitConversionDirection_t direct
 	}
 }
 
+/**
+ * @brief Powers of ten fitting into 32 bits, indexed by the exponent.
+ * 
+ */
+static const uint32_t _SI_powersOf10[] = {
+	1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/**
+ * @brief Determines the number of decimal digits of a number.
+ * 
+ * @param n The number you want to analyze.
+ * @return The number of decimal digits, at least 1.
+ */
+static uint8_t _SI_digits(uint32_t n) {
+	uint8_t digits = 1;
+	while(digits < sizeof(_SI_powersOf10) / sizeof(*_SI_powersOf10) && n >= _SI_powersOf10[digits]) {
+		digits++;
+	}
+	return digits;
+}
+
+/**
+ * @brief Number of supported SI prefixes.
+ * 
+ */
+#define _SI_PREFIX_COUNT 13
+
+/**
+ * @brief Factors of the SI prefixes from @ref EXA down to @ref ATTO, used as thresholds for the prefix selection.
+ * 
+ */
+static const double _SI_prefixFactors[_SI_PREFIX_COUNT] = {
+	1e18, 1e15, 1e12, 1e9, 1e6, 1e3, 1e0, 1e-3, 1e-6, 1e-9, 1e-12, 1e-15, 1e-18
+};
+
+/**
+ * @brief Gets the factor of a SI prefix from the table, without calling `pow`.
+ * 
+ * @param prefix The SI prefix.
+ * @return The prefix factor.
+ * 
+ * @exception ERR_OUT_OF_RANGE The exponent of @p prefix is not a multiple of 3 from @ref ATTO to @ref EXA.
+ */
+static inline double _SI_prefixFactor(SI_Prefix_t prefix) {
+	assert(prefix >= ATTO && prefix <= EXA && prefix % 3 == 0, ERR_OUT_OF_RANGE);
+	return _SI_prefixFactors[(EXA - prefix) / 3];
+}
+
+double SI_getPrefixFactor(SI_Prefix_t prefix) {
+	return _SI_prefixFactor(prefix);
+}
+
 /**
  * @brief Determines the number of digits before the decimal point.
  * 
@@ -67,13 +145,27 @@ Quantity_t _SI_converter_gram(Quantity_t input, UnitConversionDirection_t direct
  * 
  * @returns The number of digits before the decimal point.
  */
-uint8_t _digitsBeforeDecimalPoint(double n) {
-	if(fabs(n) < 1) return 0;
+static uint8_t _digitsBeforeDecimalPoint(double n) {
+	n = fabs(n);
 	
-	char valueString[32];
-	dtostrf(fabs(n), 0, 0, valueString);
-	uint8_t numberOfDigitsBeforeDecimalPoint = strlen(valueString);
-	return numberOfDigitsBeforeDecimalPoint;
+	uint8_t digits = 0;
+	for(double threshold = 1; n >= threshold && digits < 40; threshold *= 10) {
+		digits++;
+	}
+	return digits;
+}
+
+/**
+ * @brief Rescales the number of a quantity to the given prefix.
+ * 
+ * @param quantity A pointer to the quantity.
+ * @param prefix The new prefix.
+ */
+static inline void _SI_rescale(Quantity_t* quantity, SI_Prefix_t prefix) {
+	if(prefix != quantity->_prefix) {
+		quantity->_number *= _SI_prefixFactor(quantity->_prefix) / _SI_prefixFactor(prefix);
+		quantity->_prefix = prefix;
+	}
 }
 
 Quantity_t SI(double number, const Unit_t* unit, uint8_t precision) {
@@ -83,26 +175,42 @@ Quantity_t SI(double number, const Unit_t* unit, uint8_t precision) {
 }
 
 void SI_removePrefix(Quantity_t* quantity) {
-	if(!quantity->_prefix == NONE) {
-		quantity->_number *= SI_getPrefixFactor(quantity->_prefix);
-		quantity->_prefix = NONE;
-	}
+	_SI_rescale(quantity, NONE);
 }
 
-void SI_applyPrefix(Quantity_t* quantity) {
-	SI_Prefix_t prefix = floor(log10(quantity->_number) / 3) * 3;
+/**
+ * @brief Selects the prefix for a number, i.e. the biggest prefix whose factor is not bigger
+ * than the number, unless the digits before the decimal point would exceed the precision.
+ * 
+ * @param number The absolute value of the number, without prefix.
+ * @param precision The number of significant digits.
+ * @return The selected prefix.
+ */
+static SI_Prefix_t _SI_selectPrefix(double number, uint8_t precision) {
+	uint8_t i = 0;
+	if(number == 0) {
+		i = (EXA - NONE) / 3;
+	} else {
+		while(i < _SI_PREFIX_COUNT - 1 && number < _SI_prefixFactors[i]) {
+			i++;
+		}
+	}
 	
-	try {
-		SI_setPrefix(quantity, prefix);
-	} catch {
-		SI_setPrefix(quantity, prefix + 3);
+	// Use the next bigger prefix if the digits before the decimal point exceed the precision
+	if(i > 0 && precision < _digitsBeforeDecimalPoint(number / _SI_prefixFactors[i])) {
+		i--;
 	}
+	
+	return EXA - 3 * i;
+}
+
+void SI_applyPrefix(Quantity_t* quantity) {
+	double number = fabs(quantity->_number * _SI_prefixFactor(quantity->_prefix));
+	_SI_rescale(quantity, _SI_selectPrefix(number, quantity->_precision));
 }
 
 void SI_setPrefix(Quantity_t* quantity, SI_Prefix_t prefix) {
-	quantity->_number *= SI_getPrefixFactor(quantity->_prefix);	
-	quantity->_number /= SI_getPrefixFactor(prefix);
-	quantity->_prefix = prefix;
+	_SI_rescale(quantity, prefix);
 
     // If the precision is lower than the number of digits before the decimal point
     if(quantity->_precision < _digitsBeforeDecimalPoint(quantity->_number)) throw(ERR_PRECISION_VIOLATED);
@@ -116,61 +224,376 @@ Quantity_t SI_convert(Quantity_t quantity, const Unit_t* unit) {
 	return output;
 }
 
-const char* SI_getPrefixString(Quantity_t quantity) {
-	if(quantity._unit->allowPrefixing) {
-		switch(quantity._prefix) {
-			case EXA: return "E";
-			case PETA: return "P";
-			case TERA: return "T";
-			case GIGA: return "G";
-			case MEGA: return "M";
-			case KILO: return "k";
-			case NONE: return "";
-			case MILLI: return "m";
-			case MICRO: return "u";
-			case NANO: return "n";
-			case PICO: return "p";
-			case FEMTO: return "f";
-			case ATTO: return "a";
+/**
+ * @brief Gets the string for the given prefix.
+ * 
+ * @param prefix The prefix.
+ * @param allowPrefixing Whether the unit allows SI prefixes, otherwise a power of ten is returned.
+ * @return A pointer to the string-form prefix.
+ */
+static PGM_P _SI_prefixString(SI_Prefix_t prefix, bool allowPrefixing) {
+	if(allowPrefixing) {
+		switch(prefix) {
+			case EXA: return PSTR("E");
+			case PETA: return PSTR("P");
+			case TERA: return PSTR("T");
+			case GIGA: return PSTR("G");
+			case MEGA: return PSTR("M");
+			case KILO: return PSTR("k");
+			case NONE: return PSTR("");
+			case MILLI: return PSTR("m");
+			case MICRO: return PSTR("u");
+			case NANO: return PSTR("n");
+			case PICO: return PSTR("p");
+			case FEMTO: return PSTR("f");
+			case ATTO: return PSTR("a");
 		}
 	} else {
-		switch(quantity._prefix) {
-			case EXA: return "* 10^18 ";
-			case PETA: return "* 10^15 ";
-			case TERA: return "* 10^12 ";
-			case GIGA: return "* 10^9 ";
-			case MEGA: return "* 10^6 ";
-			case KILO: return "* 10^3 ";
-			case NONE: return "";
-			case MILLI: return "* 10^-3 ";
-			case MICRO: return "* 10^-6 ";
-			case NANO: return "* 10^-9 ";
-			case PICO: return "* 10^-12 ";
-			case FEMTO: return "* 10^-15 ";
-			case ATTO: return "* 10^-18 ";
+		switch(prefix) {
+			case EXA: return PSTR("* 10^18 ");
+			case PETA: return PSTR("* 10^15 ");
+			case TERA: return PSTR("* 10^12 ");
+			case GIGA: return PSTR("* 10^9 ");
+			case MEGA: return PSTR("* 10^6 ");
+			case KILO: return PSTR("* 10^3 ");
+			case NONE: return PSTR("");
+			case MILLI: return PSTR("* 10^-3 ");
+			case MICRO: return PSTR("* 10^-6 ");
+			case NANO: return PSTR("* 10^-9 ");
+			case PICO: return PSTR("* 10^-12 ");
+			case FEMTO: return PSTR("* 10^-15 ");
+			case ATTO: return PSTR("* 10^-18 ");
 		}
 	}
+	
+	return PSTR("");
 }
 
-void SI_toString(Quantity_t quantity, char* s, size_t maxLength) {
-	const char* unit = quantity._unit->abbreviation;
-	const char* prefix = SI_getPrefixString(quantity);
+PGM_P SI_getPrefixString(Quantity_t quantity) {
+	return _SI_prefixString(quantity._prefix, quantity._unit->allowPrefixing);
+}
+
+/**
+ * @brief Appends a string to the output, truncating it to the remaining length.
+ * 
+ * @param out The current output position.
+ * @param end The end of the output buffer (position of the terminating null character).
+ * @param str The string to append.
+ * @return The new output position.
+ */
+static char* _SI_append(char* out, char* end, const char* str) {
+	while(out < end && *str != '\0') {
+		*out++ = *str++;
+	}
+	return out;
+}
+
+/**
+ * @brief Appends a string stored in flash to the output, truncating it to the remaining length.
+ * 
+ * @param out The current output position.
+ * @param end The end of the output buffer (position of the terminating null character).
+ * @param str The string to append, stored in flash.
+ * @return The new output position.
+ */
+static char* _SI_append_P(char* out, char* end, PGM_P str) {
+	char c;
+	while(out < end && (c = pgm_read_byte(str++)) != '\0') {
+		*out++ = c;
+	}
+	return out;
+}
+
+/**
+ * @brief Writes a fixed-point number, i.e. the digits of @p scaled with the decimal point
+ * inserted before the last @p decimals digits.
+ * 
+ * @param out The current output position.
+ * @param end The end of the output buffer (position of the terminating null character).
+ * @param negative Whether to write a minus sign.
+ * @param scaled The number multiplied by \f$10^{decimals}\f$.
+ * @param decimals The number of digits after the decimal point.
+ * @return The new output position.
+ */
+static char* _SI_appendFixed(char* out, char* end, bool negative, uint32_t scaled, uint8_t decimals) {
+	// Generate the digits in reverse order, with at least one digit before the decimal point
+	char digits[12];
+	uint8_t length = 0;
+	do {
+		digits[length++] = '0' + scaled % 10;
+		scaled /= 10;
+	} while(scaled != 0 || length <= decimals);
 	
-	double rounded = round(quantity._number * pow(10, quantity._precision)) / pow(10, quantity._precision);
-	double test = log10(rounded);
+	if(negative && out < end) *out++ = '-';
+	while(length > 0 && out < end) {
+		if(length == decimals) {
+			*out++ = '.';
+			if(out >= end) break;
+		}
+		*out++ = digits[--length];
+	}
+	return out;
+}
+
+/**
+ * @brief Writes the separator, the prefix and the unit abbreviation and terminates the string.
+ * 
+ * @param out The current output position.
+ * @param end The end of the output buffer (position of the terminating null character).
+ * @param prefix The prefix string, stored in flash.
+ * @param unit The unit the quantity is in.
+ */
+static void _SI_appendUnit(char* out, char* end, PGM_P prefix, const Unit_t* unit) {
+	out = _SI_append(out, end, " ");
+	out = _SI_append_P(out, end, prefix);
+	out = _SI_append_P(out, end, unit->abbreviation);
+	*out = '\0';
+}
+
+void SI_toString(Quantity_t quantity, char* s, size_t maxLength) {
+	if(maxLength == 0) return;
+	PROFILE_BEGIN(PROFILE_SI_TO_STRING);
+	char* end = s + maxLength - 1;
+	char* out = s;
 	
 	uint8_t digitsBeforeDecimalPoint = _digitsBeforeDecimalPoint(quantity._number);
-	
 	int precision = quantity._precision - digitsBeforeDecimalPoint;
 	if(precision < 0) precision = 0;
 	
-	char valueString[32];
-	dtostrf(quantity._number, 0, precision, valueString);
-	snprintf(s, maxLength, "%s %s%s", valueString, prefix, unit);
+	// The scaled number has to fit into 32 bits
+	double number = fabs(quantity._number);
+	while(precision > 0 && digitsBeforeDecimalPoint + precision > 9) {
+		precision--;
+	}
+	
+	if(digitsBeforeDecimalPoint + precision <= 9) {
+		uint32_t scaled = number * _SI_powersOf10[precision] + 0.5;
+		out = _SI_appendFixed(out, end, quantity._number < 0, scaled, precision);
+	} else {
+		// Only reachable for huge numbers with a fixed prefix
+		char valueString[48];
+		dtostrf(quantity._number, 0, 0, valueString);
+		out = _SI_append(out, end, valueString);
+	}
+	
+	_SI_appendUnit(out, end, SI_getPrefixString(quantity), quantity._unit);
+	PROFILE_END(PROFILE_SI_TO_STRING);
 }
 
 void SI_print(Quantity_t quantity) {
 	char valueString[32];
 	SI_toString(quantity, valueString, sizeof(valueString) / sizeof(*valueString));
-	printf(valueString);
-}
\ No newline at end of file
+	fputs(valueString, stdout);
+}
+
+/**
+ * @brief Gets the SI unit and the decimal exponent relative to it for a unit, if the
+ * conversion to SI is a power of ten.
+ * 
+ * @param unit The unit to analyze.
+ * @param exponent Pointer to which the decimal exponent of the unit relative to the SI unit is stored.
+ * @return The SI unit, or `NULL` if the conversion is not a power of ten.
+ */
+static const Unit_t* _SI_siUnit(const Unit_t* unit, int8_t* exponent) {
+	*exponent = 0;
+	
+	if(unit == GRAM) {
+		*exponent = -3;
+		return KILOGRAM;
+	} else if(unit->converter == _SI_converter_none) {
+		return unit;
+	}
+	
+	return NULL;
+}
+
+QuantityFx_t SI_fx(int32_t mantissa, int8_t exponent, const Unit_t* unit, uint8_t precision) {
+	QuantityFx_t output = { ._mantissa = mantissa, ._exponent = exponent, ._unit = unit, ._precision = precision };
+	return output;
+}
+
+QuantityFx_t SI_fx_convert(QuantityFx_t quantity, const Unit_t* unit) {
+	int8_t sourceExponent, targetExponent;
+	const Unit_t* sourceSI = _SI_siUnit(quantity._unit, &sourceExponent);
+	const Unit_t* targetSI = _SI_siUnit(unit, &targetExponent);
+	
+	assert(sourceSI != NULL && sourceSI == targetSI, ERR_INVALID_UNIT);
+	
+	quantity._exponent += sourceExponent - targetExponent;
+	quantity._unit = unit;
+	return quantity;
+}
+
+void SI_fx_toString(QuantityFx_t quantity, char* s, size_t maxLength) {
+	bool negative = quantity._mantissa < 0;
+	uint32_t mantissa = negative ? -(uint32_t)quantity._mantissa : (uint32_t)quantity._mantissa;
+	int16_t exponent = quantity._exponent;
+	uint8_t precision = quantity._precision;
+	if(precision == 0) precision = 1;
+	if(precision > 9) precision = 9;
+	
+	// Round the mantissa to the number of significant digits
+	uint8_t digits = _SI_digits(mantissa);
+	if(digits > precision) {
+		uint32_t divisor = _SI_powersOf10[digits - precision];
+		mantissa = (mantissa + divisor / 2) / divisor;
+		exponent += digits - precision;
+		
+		// Rounding may have added a digit (e.g. 999 -> 1000)
+		digits = _SI_digits(mantissa);
+		if(digits > precision) {
+			mantissa /= 10;
+			exponent++;
+			digits--;
+		}
+	}
+	
+	// Select the prefix so 1 to 3 digits are before the decimal point
+	int16_t prefix = 0;
+	if(mantissa != 0) {
+		int16_t leadingExponent = exponent + digits - 1;
+		prefix = (leadingExponent >= 0 ? leadingExponent : leadingExponent - 2) / 3 * 3;
+		if(prefix > EXA) prefix = EXA;
+		if(prefix < ATTO) prefix = ATTO;
+	}
+	exponent -= prefix;
+	
+	// Show trailing zeros up to the precision
+	int16_t integerDigits = digits + exponent;
+	int16_t decimals = precision - (integerDigits > 0 ? integerDigits : 0);
+	if(decimals < 0) decimals = 0;
+	
+	// Build the digit string without the decimal point, with the last 'decimals' digits after it
+	char digitString[40];
+	int16_t zeros = exponent + decimals; // Zeros appended to the mantissa digits
+	int16_t length = digits + (zeros > 0 ? zeros : 0);
+	assert(length < (int16_t)sizeof(digitString), ERR_STR_TOO_LONG);
+	
+	for(int16_t i = digits - 1; i >= 0; i--) {
+		digitString[i] = '0' + mantissa % 10;
+		mantissa /= 10;
+	}
+	for(int16_t i = digits; i < length; i++) {
+		digitString[i] = '0';
+	}
+	// Drop digits exceeding the decimals (only if the exponent is very small)
+	if(zeros < 0) length += zeros;
+	if(length < 0) length = 0;
+	digitString[length] = '\0';
+	
+	// Insert the decimal point, padding with leading zeros if needed
+	char valueString[48];
+	char* out = valueString;
+	if(negative) *out++ = '-';
+	if(length <= decimals) {
+		*out++ = '0';
+		if(decimals > 0) {
+			*out++ = '.';
+			for(int16_t i = length; i < decimals; i++) *out++ = '0';
+			strcpy(out, digitString);
+			out += length;
+		}
+	} else {
+		memcpy(out, digitString, length - decimals);
+		out += length - decimals;
+		if(decimals > 0) {
+			*out++ = '.';
+			memcpy(out, digitString + length - decimals, decimals);
+			out += decimals;
+		}
+	}
+	*out = '\0';
+	
+	if(maxLength == 0) return;
+	char* end = s + maxLength - 1;
+	_SI_appendUnit(_SI_append(s, end, valueString), end, _SI_prefixString(prefix, quantity._unit->allowPrefixing), quantity._unit);
+}
+
+void SI_fx_print(QuantityFx_t quantity) {
+	char valueString[32];
+	SI_fx_toString(quantity, valueString, sizeof(valueString) / sizeof(*valueString));
+	fputs(valueString, stdout);
+}
+
+void SI_convertArray(const double* src, double* dst, size_t n, const Unit_t* from, const Unit_t* to) {
+	int8_t sourceExponent, targetExponent;
+	const Unit_t* sourceSI = _SI_siUnit(from, &sourceExponent);
+	const Unit_t* targetSI = _SI_siUnit(to, &targetExponent);
+	
+	if(sourceSI != NULL && sourceSI == targetSI) {
+		// The conversion is a power of ten, so it is a single factor for the whole block
+		int8_t exponent = sourceExponent - targetExponent;
+		double factor = 1.0;
+		if(exponent % 3 == 0 && exponent >= ATTO && exponent <= EXA) {
+			// Exact factor from the table, without accumulating rounding errors
+			factor = _SI_prefixFactor(exponent);
+		} else {
+			for(int8_t e = exponent; e > 0; e--) factor *= 10;
+			for(int8_t e = exponent; e < 0; e++) factor /= 10;
+		}
+		
+		for(size_t i = 0; i < n; i++) {
+			dst[i] = src[i] * factor;
+		}
+	} else {
+		// Non-linear conversion, use the converters of the units for each value
+		for(size_t i = 0; i < n; i++) {
+			Quantity_t output = SI_convert(SI(src[i], from, UINT8_MAX), to);
+			SI_removePrefix(&output);
+			dst[i] = output._number;
+		}
+	}
+}
+
+SI_Prefix_t SI_selectArrayPrefix(const double* values, size_t n, uint8_t precision) {
+	// The prefix is selected for the value with the largest magnitude
+	double max = 0;
+	for(size_t i = 0; i < n; i++) {
+		double value = fabs(values[i]);
+		if(value > max) max = value;
+	}
+	
+	return _SI_selectPrefix(max, precision);
+}
+
+size_t SI_formatArray(const double* values, size_t n, const Unit_t* unit, uint8_t precision, char* out, size_t len) {
+	if(len == 0) return 0;
+	char* end = out + len - 1;
+	char* position = out;
+	
+	SI_Prefix_t prefix = SI_selectArrayPrefix(values, n, precision);
+	double factor = 1 / _SI_prefixFactor(prefix);
+	
+	// All values share the number of decimals of the largest one
+	double max = 0;
+	for(size_t i = 0; i < n; i++) {
+		double value = fabs(values[i] * factor);
+		if(value > max) max = value;
+	}
+	uint8_t digitsBeforeDecimalPoint = _digitsBeforeDecimalPoint(max);
+	int decimals = precision - digitsBeforeDecimalPoint;
+	if(decimals < 0) decimals = 0;
+	while(decimals > 0 && digitsBeforeDecimalPoint + decimals > 9) {
+		decimals--;
+	}
+	double scale = factor * _SI_powersOf10[decimals];
+	
+	for(size_t i = 0; i < n && position < end; i++) {
+		if(i > 0) {
+			position = _SI_append(position, end, SI_ARRAY_DELIMITER);
+		}
+		
+		if(digitsBeforeDecimalPoint + decimals <= 9) {
+			uint32_t scaled = fabs(values[i]) * scale + 0.5;
+			position = _SI_appendFixed(position, end, values[i] < 0, scaled, decimals);
+		} else {
+			// Only reachable for huge numbers in units without prefixes
+			char valueString[48];
+			dtostrf(values[i] * factor, 0, 0, valueString);
+			position = _SI_append(position, end, valueString);
+		}
+	}
+	
+	_SI_appendUnit(position, end, _SI_prefixString(prefix, unit->allowPrefixing), unit);
+	return strlen(out);
+}
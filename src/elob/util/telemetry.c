@@ -0,0 +1,185 @@
+/**
+ * @file telemetry.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref telemetry.h.
+ */
+#include <elob/util/telemetry.h>
+#include <elob/util/error.h>
+#include <util/crc16.h>
+
+/**
+ * @brief Initial value of the CRC.
+ * 
+ */
+#define _TELEMETRY_CRC_INIT 0xFFFF
+
+/**
+ * @brief Decoder flag: the current frame is invalid and is dropped at the next zero byte.
+ * 
+ */
+#define _TELEMETRY_DECODER_INVALID (1 << 0)
+/**
+ * @brief Decoder flag: bytes of the current frame were received.
+ * 
+ */
+#define _TELEMETRY_DECODER_STARTED (1 << 1)
+/**
+ * @brief Decoder flag: no zero byte was received yet, so the current frame may be incomplete.
+ * 
+ */
+#define _TELEMETRY_DECODER_UNSYNCED (1 << 2)
+
+/**
+ * @brief Appends a byte to the COBS encoded frame.
+ * 
+ */
+static inline void _telemetry_encode(TelemetryWriter_t* writer, uint8_t data) {
+	if(data == 0) {
+		// Close the current block, the zero is implied by its code
+		buffer_poke(writer->_buffer, writer->_codeOffset, writer->_code);
+		writer->_codeOffset = writer->_length++;
+		writer->_code = 1;
+	} else {
+		buffer_poke(writer->_buffer, writer->_length++, data);
+		writer->_code++;
+	}
+}
+
+/**
+ * @brief Appends a byte covered by the CRC to the frame.
+ * 
+ */
+static inline void _telemetry_put(TelemetryWriter_t* writer, uint8_t data) {
+	writer->_crc = _crc_ccitt_update(writer->_crc, data);
+	_telemetry_encode(writer, data);
+}
+
+void telemetry_begin(TelemetryWriter_t* writer, uint8_t type) {
+	writer->_buffer = uart_txReserve(TELEMETRY_UART, TELEMETRY_MAX_FRAME_SIZE);
+	
+	// The first byte is the code of the first block, which is filled in when the block is closed
+	writer->_codeOffset = 0;
+	writer->_length = 1;
+	writer->_code = 1;
+	writer->_payloadLength = 0;
+	writer->_crc = _TELEMETRY_CRC_INIT;
+	
+	_telemetry_put(writer, type);
+}
+
+void telemetry_putByte(TelemetryWriter_t* writer, uint8_t data) {
+	assertMessage(writer->_payloadLength < TELEMETRY_MAX_PAYLOAD, ERR_BUFFER_OVERFLOW, "telemetry: Payload too long.");
+	writer->_payloadLength++;
+	_telemetry_put(writer, data);
+}
+
+void telemetry_write(TelemetryWriter_t* writer, const void* data, uint8_t n) {
+	assertMessage(n <= TELEMETRY_MAX_PAYLOAD - writer->_payloadLength, ERR_BUFFER_OVERFLOW, "telemetry: Payload too long.");
+	writer->_payloadLength += n;
+	
+	const uint8_t* bytes = data;
+	for(uint8_t i = 0; i < n; i++) {
+		_telemetry_put(writer, bytes[i]);
+	}
+}
+
+void telemetry_end(TelemetryWriter_t* writer) {
+	uint16_t crc = writer->_crc;
+	_telemetry_encode(writer, crc & 0xFF);
+	_telemetry_encode(writer, crc >> 8);
+	
+	// Close the last block and terminate the frame
+	buffer_poke(writer->_buffer, writer->_codeOffset, writer->_code);
+	buffer_poke(writer->_buffer, writer->_length++, 0);
+	
+	uart_txCommit(TELEMETRY_UART, writer->_length);
+}
+
+void telemetry_send(uint8_t type, const void* payload, uint8_t length) {
+	assertMessage(length <= TELEMETRY_MAX_PAYLOAD, ERR_BUFFER_OVERFLOW, "telemetry: Payload too long.");
+	
+	TelemetryWriter_t writer;
+	telemetry_begin(&writer, type);
+	telemetry_write(&writer, payload, length);
+	telemetry_end(&writer);
+}
+
+/**
+ * @brief Starts decoding a new frame.
+ * 
+ */
+static inline void _telemetry_decoder_reset(TelemetryDecoder_t* decoder, uint8_t flags) {
+	decoder->_index = 0;
+	decoder->_remaining = 0;
+	// No zero is implied before the first block
+	decoder->_code = 0xFF;
+	decoder->_flags = flags;
+	decoder->_crc = _TELEMETRY_CRC_INIT;
+}
+
+/**
+ * @brief Stores a decoded byte of the current frame.
+ * 
+ */
+static inline void _telemetry_decoder_store(TelemetryDecoder_t* decoder, uint8_t data) {
+	if(decoder->_index > sizeof(decoder->payload)) {
+		decoder->_flags |= _TELEMETRY_DECODER_INVALID;
+		return;
+	}
+	
+	if(decoder->_index == 0) {
+		decoder->type = data;
+	} else {
+		decoder->payload[decoder->_index - 1] = data;
+	}
+	decoder->_index++;
+	decoder->_crc = _crc_ccitt_update(decoder->_crc, data);
+}
+
+void telemetry_decoder_init(TelemetryDecoder_t* decoder) {
+	decoder->length = 0;
+	decoder->frames = 0;
+	decoder->errors = 0;
+	_telemetry_decoder_reset(decoder, _TELEMETRY_DECODER_UNSYNCED);
+}
+
+bool telemetry_decoder_feed(TelemetryDecoder_t* decoder, uint8_t data) {
+	if(data == 0) {
+		uint8_t flags = decoder->_flags;
+		uint8_t index = decoder->_index;
+		// Appending the CRC to the data results in a CRC of zero
+		bool valid = !(flags & (_TELEMETRY_DECODER_INVALID | _TELEMETRY_DECODER_UNSYNCED))
+			&& decoder->_remaining == 0 && index >= 3 && decoder->_crc == 0;
+		_telemetry_decoder_reset(decoder, 0);
+		
+		if(valid) {
+			decoder->length = index - 3;
+			decoder->frames++;
+			return true;
+		}
+		// Consecutive zero bytes are no errors, neither is the frame the decoder started in
+		if((flags & _TELEMETRY_DECODER_STARTED) && !(flags & _TELEMETRY_DECODER_UNSYNCED)) {
+			decoder->errors++;
+		}
+		return false;
+	}
+	
+	decoder->_flags |= _TELEMETRY_DECODER_STARTED;
+	if(decoder->_remaining == 0) {
+		// Code byte of the next block, which implies a zero after the previous block
+		if(decoder->_code != 0xFF) _telemetry_decoder_store(decoder, 0);
+		decoder->_code = data;
+		decoder->_remaining = data - 1;
+	} else {
+		_telemetry_decoder_store(decoder, data);
+		decoder->_remaining--;
+	}
+	return false;
+}
+
+bool telemetry_decoder_poll(TelemetryDecoder_t* decoder, UART_Interface_t uartInterface) {
+	while(uart_available(uartInterface)) {
+		if(telemetry_decoder_feed(decoder, uart_readByte(uartInterface))) return true;
+	}
+	return false;
+}
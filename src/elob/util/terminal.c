@@ -1,30 +1,152 @@
+/**
+ * @file terminal.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref terminal.h.
+ */
 #include <elob/util/usb_terminal.h>
 #include <elob/util/terminal.h>
 #include <elob/util/error.h>
 #include <elob/elob.h>
+#include <avr/pgmspace.h>
+
+/**
+ * @brief Maximum length of a SGR sequence generated by @ref terminal_apply,
+ * i.e. `ESC[0;1;31;40m` plus the null terminator.
+ * 
+ */
+#define _TERMINAL_SGR_MAX_LENGTH 16
+
+/**
+ * @brief Cached state of the terminal emulator, used to skip redundant escape sequences.
+ * 
+ */
+static struct {
+	/**
+	 * @brief Whether the state is known. If not, the next change is always sent.
+	 */
+	bool known;
+	USB_TerminalColor_t foreground;
+	USB_TerminalColor_t background;
+	/**
+	 * @brief Bit mask of the active styles, bit n corresponds to the style with the value n.
+	 */
+	uint16_t styles;
+} _terminal_state = { .known = false };
+
+/**
+ * @brief Appends a SGR parameter to the sequence, separated by a semicolon.
+ * 
+ * @param out The current output position.
+ * @param first Whether this is the first parameter of the sequence.
+ * @param prefix The first digit of the parameter ('3' for foreground, '4' for background) or 0 for none.
+ * @param value The last digit of the parameter.
+ * @return The new output position.
+ */
+static char* _terminal_appendParameter(char* out, bool first, char prefix, uint8_t value) {
+	if(!first) *out++ = ';';
+	if(prefix) *out++ = prefix;
+	*out++ = '0' + value;
+	return out;
+}
+
+void terminal_apply(USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style) {
+	uint16_t styles = style == TERMINAL_STYLE_RESET ? 0 : (1 << style);
+	
+	char sequence[_TERMINAL_SGR_MAX_LENGTH];
+	char* out = sequence;
+	*out++ = _ANSI_ESCAPE_SEQUENCE;
+	*out++ = '[';
+	
+	bool reset = !_terminal_state.known || _terminal_state.styles != styles;
+	if(reset) {
+		// Styles can only be removed by resetting everything, including the colors
+		out = _terminal_appendParameter(out, true, 0, TERMINAL_STYLE_RESET);
+		if(style != TERMINAL_STYLE_RESET) {
+			out = _terminal_appendParameter(out, false, 0, style);
+		}
+		_terminal_state.foreground = TERMINAL_CLR_DEFAULT;
+		_terminal_state.background = TERMINAL_CLR_DEFAULT;
+	}
+	if(foreground != _terminal_state.foreground) {
+		out = _terminal_appendParameter(out, out == sequence + 2, '3', foreground);
+	}
+	if(background != _terminal_state.background) {
+		out = _terminal_appendParameter(out, out == sequence + 2, '4', background);
+	}
+	
+	_terminal_state.known = true;
+	_terminal_state.foreground = foreground;
+	_terminal_state.background = background;
+	_terminal_state.styles = styles;
+	
+	// Nothing changed
+	if(out == sequence + 2) return;
+	
+	*out++ = 'm';
+	*out = '\0';
+	fputs(sequence, stdout);
+}
+
+void terminal_invalidate() {
+	_terminal_state.known = false;
+}
 
 void terminal_setForegroundColor(USB_TerminalColor_t color) {
-	printf("%c", _ANSI_ESCAPE_SEQUENCE);
-	printf("[3");
-	printf("%c", color + '0');
-	printf("m");
+	if(_terminal_state.known && _terminal_state.foreground == color) return;
+	_terminal_state.foreground = color;
+	
+	printf_P(PSTR("%c[3%cm"), _ANSI_ESCAPE_SEQUENCE, color + '0');
 }
 
 void terminal_setBackgroundColor(USB_TerminalColor_t color) {
-	printf("%c", _ANSI_ESCAPE_SEQUENCE);
-	printf("[4");
-	printf("%c", color + '0');
-	printf("m");
+	if(_terminal_state.known && _terminal_state.background == color) return;
+	_terminal_state.background = color;
+	
+	printf_P(PSTR("%c[4%cm"), _ANSI_ESCAPE_SEQUENCE, color + '0');
 }
 
 void terminal_setColors(USB_TerminalColor_t foreground, USB_TerminalColor_t background) {
-	terminal_setForegroundColor(foreground);
-	terminal_setBackgroundColor(background);
+	if(_terminal_state.known) {
+		// Keep the styles, only send the changed colors in one sequence
+		char sequence[_TERMINAL_SGR_MAX_LENGTH];
+		char* out = sequence;
+		*out++ = _ANSI_ESCAPE_SEQUENCE;
+		*out++ = '[';
+		if(foreground != _terminal_state.foreground) {
+			out = _terminal_appendParameter(out, true, '3', foreground);
+		}
+		if(background != _terminal_state.background) {
+			out = _terminal_appendParameter(out, out == sequence + 2, '4', background);
+		}
+		_terminal_state.foreground = foreground;
+		_terminal_state.background = background;
+		
+		if(out == sequence + 2) return;
+		*out++ = 'm';
+		*out = '\0';
+		fputs(sequence, stdout);
+	} else {
+		terminal_setForegroundColor(foreground);
+		terminal_setBackgroundColor(background);
+	}
 }
 
 void terminal_setStyle(USB_TerminalStyle_t style) {
-	printf("%c", _ANSI_ESCAPE_SEQUENCE);
-	printf("[");
-	printf("%c", style + '0');
-	printf("m");
+	if(style == TERMINAL_STYLE_RESET) {
+		if(_terminal_state.known && _terminal_state.styles == 0
+			&& _terminal_state.foreground == TERMINAL_CLR_DEFAULT && _terminal_state.background == TERMINAL_CLR_DEFAULT) {
+			return;
+		}
+		
+		// A reset also resets the colors
+		_terminal_state.known = true;
+		_terminal_state.foreground = TERMINAL_CLR_DEFAULT;
+		_terminal_state.background = TERMINAL_CLR_DEFAULT;
+		_terminal_state.styles = 0;
+	} else {
+		if(_terminal_state.known && (_terminal_state.styles & (1 << style))) return;
+		_terminal_state.styles |= (1 << style);
+	}
+	
+	printf_P(PSTR("%c[%cm"), _ANSI_ESCAPE_SEQUENCE, style + '0');
 }
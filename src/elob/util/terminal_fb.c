@@ -0,0 +1,217 @@
+/**
+ * @file terminal_fb.c
+ * @author Gabriel Heinzer (gabriel.heinzer@roche.com)
+ * @brief Source file for @ref terminal_fb.h.
+ */
+#include <elob/util/terminal_fb.h>
+#include <elob/util/terminal.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Number of cells of the framebuffer.
+ * 
+ */
+#define _TERMINAL_FB_CELLS ((uint16_t)TERMINAL_FB_COLUMNS * TERMINAL_FB_ROWS)
+
+/**
+ * @brief Maximum number of unchanged cells between two changed ones which are rewritten instead
+ * of moving the cursor, as a cursor positioning sequence is longer than that.
+ * 
+ */
+#define _TERMINAL_FB_MAX_GAP 4
+
+/**
+ * @brief Struct representing a single cell of the framebuffer.
+ * 
+ */
+typedef struct {
+	char character;
+	/**
+	 * @brief Foreground color in the lower nibble, background color in the upper nibble.
+	 */
+	uint8_t colors;
+	uint8_t style;
+} _TerminalFbCell_t;
+
+/**
+ * @brief The cells of the framebuffer, row by row.
+ * 
+ */
+static _TerminalFbCell_t _terminal_fb_cells[_TERMINAL_FB_CELLS];
+
+/**
+ * @brief Bit map of the changed cells, one bit per cell.
+ * 
+ */
+static uint8_t _terminal_fb_dirty[(_TERMINAL_FB_CELLS + 7) / 8];
+
+/**
+ * @brief Whether the screen has to be cleared before the next present.
+ * 
+ */
+static bool _terminal_fb_clearScreen = true;
+
+/**
+ * @brief Marks the cell with the given index as changed.
+ * 
+ */
+static inline void _terminal_fb_markDirty(uint16_t index) {
+	_terminal_fb_dirty[index / 8] |= (1 << (index % 8));
+}
+
+/**
+ * @brief Checks if the cell with the given index is changed.
+ * 
+ */
+static inline bool _terminal_fb_isDirty(uint16_t index) {
+	return _terminal_fb_dirty[index / 8] & (1 << (index % 8));
+}
+
+/**
+ * @brief Writes a cell and marks it as changed if its content differs.
+ * 
+ */
+static inline void _terminal_fb_write(uint16_t index, char c, uint8_t colors, uint8_t style) {
+	_TerminalFbCell_t* cell = &_terminal_fb_cells[index];
+	if(cell->character != c || cell->colors != colors || cell->style != style) {
+		cell->character = c;
+		cell->colors = colors;
+		cell->style = style;
+		_terminal_fb_markDirty(index);
+	}
+}
+
+/**
+ * @brief Packs the colors of a cell.
+ * 
+ */
+static inline uint8_t _terminal_fb_colors(USB_TerminalColor_t foreground, USB_TerminalColor_t background) {
+	return (foreground & 0x0F) | (background << 4);
+}
+
+void terminal_fb_init() {
+	for(uint16_t i = 0; i < _TERMINAL_FB_CELLS; i++) {
+		_terminal_fb_cells[i].character = ' ';
+		_terminal_fb_cells[i].colors = _terminal_fb_colors(TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT);
+		_terminal_fb_cells[i].style = TERMINAL_STYLE_RESET;
+	}
+	
+	// The cleared screen already shows the empty framebuffer
+	memset(_terminal_fb_dirty, 0, sizeof(_terminal_fb_dirty));
+	_terminal_fb_clearScreen = true;
+}
+
+void terminal_fb_clear() {
+	terminal_fb_fill(0, 0, TERMINAL_FB_COLUMNS, TERMINAL_FB_ROWS, ' ', TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT, TERMINAL_STYLE_RESET);
+}
+
+void terminal_fb_invalidate() {
+	memset(_terminal_fb_dirty, 0xFF, sizeof(_terminal_fb_dirty));
+	terminal_invalidate();
+}
+
+void terminal_fb_setCell(uint8_t column, uint8_t row, char c, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style) {
+	if(column >= TERMINAL_FB_COLUMNS || row >= TERMINAL_FB_ROWS) return;
+	_terminal_fb_write((uint16_t)row * TERMINAL_FB_COLUMNS + column, c, _terminal_fb_colors(foreground, background), style);
+}
+
+uint8_t terminal_fb_print(uint8_t column, uint8_t row, const char* s, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style) {
+	if(row >= TERMINAL_FB_ROWS) return 0;
+	
+	uint8_t colors = _terminal_fb_colors(foreground, background);
+	uint16_t index = (uint16_t)row * TERMINAL_FB_COLUMNS + column;
+	uint8_t written = 0;
+	for(; column < TERMINAL_FB_COLUMNS && *s != '\0'; column++, written++) {
+		_terminal_fb_write(index++, *s++, colors, style);
+	}
+	return written;
+}
+
+uint8_t terminal_fb_print_P(uint8_t column, uint8_t row, PGM_P s, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style) {
+	if(row >= TERMINAL_FB_ROWS) return 0;
+	
+	uint8_t colors = _terminal_fb_colors(foreground, background);
+	uint16_t index = (uint16_t)row * TERMINAL_FB_COLUMNS + column;
+	uint8_t written = 0;
+	char c;
+	for(; column < TERMINAL_FB_COLUMNS && (c = pgm_read_byte(s++)) != '\0'; column++, written++) {
+		_terminal_fb_write(index++, c, colors, style);
+	}
+	return written;
+}
+
+void terminal_fb_fill(uint8_t column, uint8_t row, uint8_t width, uint8_t height, char c, USB_TerminalColor_t foreground, USB_TerminalColor_t background, USB_TerminalStyle_t style) {
+	uint8_t colors = _terminal_fb_colors(foreground, background);
+	
+	for(uint8_t y = row; y < TERMINAL_FB_ROWS && y - row < height; y++) {
+		uint16_t index = (uint16_t)y * TERMINAL_FB_COLUMNS + column;
+		for(uint8_t x = column; x < TERMINAL_FB_COLUMNS && x - column < width; x++) {
+			_terminal_fb_write(index++, c, colors, style);
+		}
+	}
+}
+
+void terminal_fb_present() {
+	if(_terminal_fb_clearScreen) {
+		terminal_apply(TERMINAL_CLR_DEFAULT, TERMINAL_CLR_DEFAULT, TERMINAL_STYLE_RESET);
+		printf_P(PSTR("%c[2J"), _ANSI_ESCAPE_SEQUENCE);
+		_terminal_fb_clearScreen = false;
+	}
+	
+	// Characters of the current run with equal attributes, written at once
+	char run[TERMINAL_FB_COLUMNS + 1];
+	
+	for(uint8_t row = 0; row < TERMINAL_FB_ROWS; row++) {
+		uint16_t rowIndex = (uint16_t)row * TERMINAL_FB_COLUMNS;
+		
+		// Column the cursor is at, or UINT8_MAX if it's not in this row
+		uint8_t cursor = UINT8_MAX;
+		uint8_t runLength = 0;
+		
+		for(uint8_t column = 0; column < TERMINAL_FB_COLUMNS; column++) {
+			uint16_t index = rowIndex + column;
+			
+			if(!_terminal_fb_isDirty(index)) {
+				// Rewrite short gaps between changed cells instead of moving the cursor
+				bool bridge = false;
+				if(cursor == column) {
+					for(uint8_t x = column + 1; x < TERMINAL_FB_COLUMNS && x <= column + _TERMINAL_FB_MAX_GAP; x++) {
+						if(_terminal_fb_isDirty(rowIndex + x)) {
+							bridge = true;
+							break;
+						}
+					}
+				}
+				if(!bridge) continue;
+			}
+			
+			_TerminalFbCell_t* cell = &_terminal_fb_cells[index];
+			
+			// Flush the current run if the cursor has to move or the attributes change
+			_TerminalFbCell_t* previous = column > 0 ? cell - 1 : NULL;
+			if(runLength > 0 && (cursor != column || previous->colors != cell->colors || previous->style != cell->style)) {
+				run[runLength] = '\0';
+				fputs(run, stdout);
+				runLength = 0;
+			}
+			
+			if(runLength == 0) {
+				if(cursor != column) {
+					printf_P(PSTR("%c[%u;%uH"), _ANSI_ESCAPE_SEQUENCE, row + 1, column + 1);
+				}
+				terminal_apply(cell->colors & 0x0F, cell->colors >> 4, cell->style);
+			}
+			
+			run[runLength++] = cell->character;
+			cursor = column + 1;
+		}
+		
+		if(runLength > 0) {
+			run[runLength] = '\0';
+			fputs(run, stdout);
+		}
+	}
+	
+	memset(_terminal_fb_dirty, 0, sizeof(_terminal_fb_dirty));
+}
@@ -8,23 +8,77 @@
 #include <elob/util/usb_terminal.h>
 #include <elob/util/error.h>
 #include <elob/elob.h>
+#include <avr/pgmspace.h>
 
 #include <errno.h>
 
+#if USB_TERMINAL_LINE_BUFFERED
+/**
+ * @brief Line buffer for the output to usb_terminal_f.
+ * 
+ */
+static uint8_t _usb_terminal_lineBuffer[USB_TERMINAL_LINE_BUFFER_SIZE];
+
+/**
+ * @brief Number of bytes in the line buffer.
+ * 
+ */
+static uint8_t _usb_terminal_lineBufferLength = 0;
+#endif
+
+void usb_terminal_flush() {
+#if USB_TERMINAL_LINE_BUFFERED
+	if(_usb_terminal_lineBufferLength == 0) return;
+	
+	// Reset the length first, so a throw doesn't leave the data in the buffer
+	uint8_t length = _usb_terminal_lineBufferLength;
+	_usb_terminal_lineBufferLength = 0;
+	uart_write(USB_UART_IF, _usb_terminal_lineBuffer, length);
+#endif
+}
+
 // Internal PUT function for the FILE stream
-int _usb_terminal_put(char c, FILE* f) {
-	try {
-		usb_terminal_printChar(c);
-	} catch {
-		return 1;
+// Sending can only fail if the UART interface is disabled, which usb_terminal_init already
+// rejected, so no try block (and its setjmp) is needed for every character
+static int _usb_terminal_put(char c, FILE* f) {
+#if USB_TERMINAL_LINE_BUFFERED
+	_usb_terminal_lineBuffer[_usb_terminal_lineBufferLength++] = c;
+	if(c == '\n' || _usb_terminal_lineBufferLength >= USB_TERMINAL_LINE_BUFFER_SIZE) {
+		usb_terminal_flush();
 	}
+#else
+	usb_terminal_printChar(c);
+#endif
+	return 0;
 }
 
 // Internal GET function for the FILE stream
-int _usb_terminal_get(FILE* f) {
+static int _usb_terminal_get(FILE* f) {
 	return usb_terminal_readChar();
 }
 
+/**
+ * @brief Statically allocated FILE stream for the USB terminal.
+ * 
+ */
+static FILE _usb_terminal_stream = FDEV_SETUP_STREAM(_usb_terminal_put, _usb_terminal_get, _FDEV_SETUP_RW);
+
+FILE* usb_terminal_f = &_usb_terminal_stream;
+
+#if USB_TERMINAL_LINE_BUFFERED
+// Internal PUT function for the unbuffered stderr stream
+static int _usb_terminal_putUnbuffered(char c, FILE* f) {
+	usb_terminal_printChar(c);
+	return 0;
+}
+
+/**
+ * @brief Statically allocated unbuffered FILE stream for `stderr`, so errors are visible immediately.
+ * 
+ */
+static FILE _usb_terminal_errorStream = FDEV_SETUP_STREAM(_usb_terminal_putUnbuffered, NULL, _FDEV_SETUP_WRITE);
+#endif
+
 void usb_terminal_init(
 	unsigned long baudrate,
 	UART_ParityMode_t parityMode,
@@ -34,30 +88,53 @@ void usb_terminal_init(
 	// Initialize the UART interface
 	uart_init(USB_UART_IF, baudrate, parityMode, stopbitMode, clockPolarityMode);
 	
-	// Initialize USB-UART FILE stream
-	usb_terminal_f = fdevopen(_usb_terminal_put, _usb_terminal_get);
+	// Use the USB-UART FILE stream for the standard streams
 	stdout = usb_terminal_f;
 	stdin = usb_terminal_f;
+#if USB_TERMINAL_LINE_BUFFERED
+	stderr = &_usb_terminal_errorStream;
+#else
 	stderr = usb_terminal_f;
+#endif
 
 	// Reset the terminal style
 	terminal_setStyle(TERMINAL_STYLE_RESET);
 }
 
 void usb_terminal_printChar(char c) {
+	usb_terminal_flush();
 	uart_sendByte(USB_UART_IF, c);
 }
 
 void usb_terminal_print(char* s) {
+	usb_terminal_flush();
 	uart_sendString(USB_UART_IF, s);
 }
 
 void usb_terminal_println(char* s) {
+	usb_terminal_flush();
 	uart_sendString(USB_UART_IF, s);
-	uart_sendString(USB_UART_IF, "\r\n");
+	usb_terminal_print_P(PSTR("\r\n"));
+}
+
+void usb_terminal_print_P(PGM_P s) {
+	usb_terminal_flush();
+	
+	char c;
+	while((c = pgm_read_byte(s++)) != '\0') {
+		uart_sendByte(USB_UART_IF, c);
+	}
+}
+
+void usb_terminal_println_P(PGM_P s) {
+	usb_terminal_print_P(s);
+	usb_terminal_print_P(PSTR("\r\n"));
 }
 
 char usb_terminal_readChar() {
+	// Make sure a pending prompt is visible
+	usb_terminal_flush();
+	
 	// Read a single char from the UART interface
 	char data = uart_readByte(USB_UART_IF);
 
@@ -66,31 +143,76 @@ char usb_terminal_readChar() {
 	return data;
 }
 
-void usb_terminal_readln(char* target, size_t maxLength) {	
-	uint8_t currentChar = 0;
-	int i = 0;
-	while(currentChar != '\n' && currentChar != '\r') {
-		// Read the current char
-		currentChar = uart_readByte(USB_UART_IF);
+void usb_terminal_lineReader_init(USB_TerminalLineReader_t* reader, char* buffer, size_t maxLength) {
+	assert(maxLength > 0, ERR_OUT_OF_RANGE);
+	
+	reader->buffer = buffer;
+	reader->maxLength = maxLength;
+	reader->_lastWasCR = false;
+	usb_terminal_lineReader_reset(reader);
+}
+
+void usb_terminal_lineReader_reset(USB_TerminalLineReader_t* reader) {
+	reader->length = 0;
+	reader->complete = false;
+	reader->overflow = false;
+	reader->buffer[0] = '\0';
+	
+	// _lastWasCR is kept, so the LF of a CRLF doesn't complete an empty line
+}
+
+bool usb_terminal_lineReader_poll(USB_TerminalLineReader_t* reader) {
+	// Make sure a pending prompt is visible
+	usb_terminal_flush();
+	
+	while(!reader->complete && uart_available(USB_UART_IF)) {
+		char c = uart_readByte(USB_UART_IF);
+		bool lastWasCR = reader->_lastWasCR;
+		reader->_lastWasCR = (c == '\r');
 		
-		if(currentChar == 127) { // A DEL character (backspace) has been received
-			if(i <= 0) continue; // Don't allow backspace before the start of the line
-			i--;
-			uart_sendByte(USB_UART_IF, currentChar);
-		} else if(i >= maxLength - 1) {
-			// The number of received chars exceeded the max length, throw an error
-			throwMessage(ERR_BUFFER_OVERFLOW, "usb_terminal_readln: Maximum buffer length exceeded.");
+		if(c == '\r' || c == '\n') {
+			if(c == '\n' && lastWasCR) continue; // Second half of a CRLF
+			
+			reader->buffer[reader->length] = '\0';
+			reader->complete = true;
+			
+			// Echo a CRLF to the terminal
+			usb_terminal_print_P(PSTR("\r\n"));
+		} else if(c == 127 || c == '\b') { // Backspace
+			if(reader->length == 0) continue; // Don't allow backspace before the start of the line
+			reader->length--;
+			uart_sendByte(USB_UART_IF, c);
+		} else if(reader->length >= reader->maxLength - 1) {
+			// The buffer is full, drop the char and ring the bell
+			reader->overflow = true;
+			uart_sendByte(USB_UART_IF, '\a');
 		} else { // A normal character has been received
-			target[i] = currentChar;
-			i++;
-			uart_sendByte(USB_UART_IF, currentChar);
+			reader->buffer[reader->length++] = c;
+			uart_sendByte(USB_UART_IF, c);
 		}
 	}
-	// Replace the CR/LF character with a null terminator
-	target[i - 1] = 0;
+	
+	return reader->complete;
+}
+
+/**
+ * @brief Whether the last line read by @ref usb_terminal_readln ended with a CR. Kept across the calls,
+ * so the LF of a CRLF doesn't complete an empty line with the next call.
+ * 
+ */
+static bool _usb_terminal_readlnLastWasCR = false;
 
-	// Echo a CRLF to the terminal
-	uart_sendString(USB_UART_IF, "\r\n");
+void usb_terminal_readln(char* target, size_t maxLength) {
+	USB_TerminalLineReader_t reader;
+	usb_terminal_lineReader_init(&reader, target, maxLength);
+	reader._lastWasCR = _usb_terminal_readlnLastWasCR;
+	
+	while(!usb_terminal_lineReader_poll(&reader));
+	_usb_terminal_readlnLastWasCR = reader._lastWasCR;
+	
+	if(reader.overflow) {
+		throwMessage(ERR_BUFFER_OVERFLOW, "usb_terminal_readln: Maximum buffer length exceeded.");
+	}
 }
 
 bool usb_terminal_available() {
@@ -102,16 +224,16 @@ unsigned long usb_terminal_ulPrompt(const char* prompt, unsigned long min, unsig
 	char minStr[21];
 	char maxStr[21];
 	
-	sprintf(minStr, "%d", min);
-	sprintf(maxStr, "%d", max);
+	sprintf_P(minStr, PSTR("%lu"), min);
+	sprintf_P(maxStr, PSTR("%lu"), max);
 	
 	// Print the prompt and range indicator ('[min-max]')
 	usb_terminal_print(prompt);
-	usb_terminal_print(" [");
+	usb_terminal_print_P(PSTR(" ["));
 	usb_terminal_print(minStr);
-	usb_terminal_print("-");
+	usb_terminal_print_P(PSTR("-"));
 	usb_terminal_print(maxStr);
-	usb_terminal_print("]: ");
+	usb_terminal_print_P(PSTR("]: "));
 	
 	// Maximum length of an decimal unsigned 64-bit-integer string is 20 characters,
 	// so the buffer needs to be 21 bytes long (accounting for a null terminator)
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Decodes the telemetry frames of telemetry.h.
+
+Reads the raw byte stream from a serial port (requires pyserial) or a file and
+prints one line per frame. Frames with an invalid encoding or CRC are reported
+and skipped. Payloads can be unpacked using struct formats per message type:
+
+    telemetry_decode.py /dev/ttyUSB0 --baudrate 115200 --format 1:<Ifhh
+    telemetry_decode.py capture.bin --format 1:<Ifhh
+"""
+import argparse
+import struct
+import sys
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16 as computed by _crc_ccitt_update of avr-libc."""
+    for byte in data:
+        byte ^= crc & 0xFF
+        byte = (byte ^ (byte << 4)) & 0xFF
+        crc = ((byte << 8) | (crc >> 8)) ^ (byte >> 4) ^ (byte << 3)
+        crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Decodes a COBS block without the delimiter. Raises ValueError on an invalid encoding."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("invalid COBS encoding")
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(encoded):
+    """Returns (type, payload) of an encoded frame. Raises ValueError if it is invalid."""
+    decoded = cobs_decode(encoded)
+    if len(decoded) < 3:
+        raise ValueError("frame too short")
+    if crc16(decoded) != 0:
+        raise ValueError("CRC mismatch")
+    return decoded[0], decoded[1:-2]
+
+
+def read_chunk(stream):
+    """Reads the bytes which are available, blocking only until at least one arrived."""
+    if hasattr(stream, "in_waiting"):
+        # A serial port without timeout blocks until the full size was received
+        return stream.read(stream.in_waiting or 1)
+    if hasattr(stream, "read1"):
+        return stream.read1(256)
+    return stream.read(256)
+
+
+def frames(stream):
+    """Yields the encoded frames of a byte stream, split at the zero bytes."""
+    pending = bytearray()
+    while True:
+        chunk = read_chunk(stream)
+        if not chunk:
+            return
+        for byte in chunk:
+            if byte == 0:
+                if pending:
+                    yield bytes(pending)
+                pending.clear()
+            else:
+                pending.append(byte)
+
+
+def parse_format(value):
+    message_type, _, fmt = value.partition(":")
+    return int(message_type, 0), struct.Struct(fmt)
+
+
+def open_input(args):
+    if args.input == "-":
+        return sys.stdin.buffer
+    if args.baudrate is not None:
+        import serial
+        return serial.Serial(args.input, args.baudrate)
+    return open(args.input, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="serial port, file or - for stdin")
+    parser.add_argument("--baudrate", type=int, help="open the input as a serial port with this baud rate")
+    parser.add_argument("--format", type=parse_format, action="append", default=[],
+                        metavar="TYPE:FORMAT", help="struct format of the payload of a message type")
+    args = parser.parse_args()
+    formats = dict(args.format)
+
+    with open_input(args) as stream:
+        for encoded in frames(stream):
+            try:
+                message_type, payload = decode_frame(encoded)
+            except ValueError as error:
+                print(f"invalid frame ({error}): {encoded.hex(' ')}", flush=True)
+                continue
+
+            fmt = formats.get(message_type)
+            if fmt is not None and fmt.size == len(payload):
+                values = " ".join(str(value) for value in fmt.unpack(payload))
+            else:
+                values = payload.hex(" ")
+            print(f"type=0x{message_type:02X} length={len(payload)} {values}", flush=True)
+
+
+if __name__ == "__main__":
+    main()